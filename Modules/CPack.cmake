@@ -296,14 +296,51 @@ installers.  The most commonly-used variables are:
   all available CPU cores are used.
   By default ``CPACK_THREADS`` is set to ``1``.
 
-  Currently only ``xz`` compression *may* take advantage of multiple cores. Other
-  compression methods ignore this value and use only one thread.
+  Currently only ``xz`` and ``zstd`` compression *may* take advantage of
+  multiple cores. Other compression methods ignore this value and use only
+  one thread.
+
+  .. versionchanged:: 3.21
+    ``zstd`` compression uses multiple threads as well.
+
+  .. versionchanged:: 3.21
+    The :cpack_gen:`CPack DEB Generator` also uses this many threads to
+    compute the ``md5sums`` of the packaged files while they are compressed.
 
   .. note::
 
      Official CMake binaries available on ``cmake.org`` ship with a ``liblzma``
      that does not support parallel compression.
 
+.. variable:: CPACK_COMPONENTS_INSTALL_JOBS
+
+  .. versionadded:: 3.21
+
+  Number of components of a project that may be installed concurrently
+  during a component install.  Each component is then installed by a
+  separate ``cmake`` process.  If it is set to 0, CPack uses as many jobs
+  as there are CPU cores.  By default ``CPACK_COMPONENTS_INSTALL_JOBS`` is
+  set to ``1`` and components are installed one after another.
+
+  Components are only installed concurrently when each of them is staged in
+  a directory of its own, e.g. with ``CPACK_COMPONENTS_GROUPING`` set to
+  ``IGNORE``.  Otherwise they are installed one after another.  The output
+  of the installations is reported in component order.  The packages are
+  still generated one after another.
+
+.. variable:: CPACK_INSTALL_USE_LINKS
+
+  .. versionadded:: 3.21
+
+  If set to ``TRUE``, the project is staged into the temporary install
+  directory with reflinks to the files it installs instead of copies,
+  where the file system supports them.  If set to ``HARDLINK``, regular
+  files that cannot be cloned may also be staged as hard links to their
+  sources, with the restrictions described for the
+  :variable:`CMAKE_INSTALL_USE_LINKS` variable.  The value is passed to
+  the installation in that variable.  This saves time and disk space when
+  packaging large projects.  Defaults to ``FALSE``.
+
 Variables for Source Package Generators
 ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 
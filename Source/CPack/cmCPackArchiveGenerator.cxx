@@ -348,20 +348,31 @@ bool cmCPackArchiveGenerator::SupportsComponentInstallation() const
 
 bool cmCPackArchiveGenerator::SetArchiveOptions(cmArchiveWrite* archive)
 {
+  const char* threads = "1";
+
+  // CPACK_ARCHIVE_THREADS overrides CPACK_THREADS
+  if (this->IsSet("CPACK_ARCHIVE_THREADS")) {
+    threads = this->GetOption("CPACK_ARCHIVE_THREADS");
+  } else if (this->IsSet("CPACK_THREADS")) {
+    threads = this->GetOption("CPACK_THREADS");
+  }
+
 #if ARCHIVE_VERSION_NUMBER >= 3004000
   // Upstream fixed an issue with their integer parsing in 3.4.0 which would
   // cause spurious errors to be raised from `strtoull`.
   if (this->Compress == cmArchiveWrite::CompressXZ) {
-    const char* threads = "1";
-
-    // CPACK_ARCHIVE_THREADS overrides CPACK_THREADS
-    if (this->IsSet("CPACK_ARCHIVE_THREADS")) {
-      threads = this->GetOption("CPACK_ARCHIVE_THREADS");
-    } else if (this->IsSet("CPACK_THREADS")) {
-      threads = this->GetOption("CPACK_THREADS");
+    if (!archive->SetFilterOption("xz", "threads", threads)) {
+      return false;
     }
+  }
+#endif
 
-    if (!archive->SetFilterOption("xz", "threads", threads)) {
+#if !defined(CMAKE_USE_SYSTEM_LIBARCHIVE) || ARCHIVE_VERSION_NUMBER >= 3006000
+  // The zstd filter learned the "threads" option in 3.6.0 and our bundled
+  // copy carries it too.
+  if (this->Compress == cmArchiveWrite::CompressZstd &&
+      strcmp(threads, "1") != 0) {
+    if (!archive->SetFilterOption("zstd", "threads", threads)) {
       return false;
     }
   }
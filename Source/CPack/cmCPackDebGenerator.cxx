@@ -2,12 +2,20 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmCPackDebGenerator.h"
 
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <set>
+#include <thread>
 #include <utility>
+#include <vector>
+
+#include <cm/memory>
 
 #include "cmsys/Glob.hxx"
 
@@ -24,6 +32,150 @@
 
 namespace {
 
+/**
+ * Computes the MD5 sums of the files written to data.tar on worker
+ * threads while the archive is being compressed.  The archive writer
+ * hands over each block it reads, so every file is read from disk once.
+ * All blocks of one file go to the same worker to keep them in order.
+ */
+class DebMD5Pipeline
+{
+public:
+  explicit DebMD5Pipeline(unsigned int numWorkers);
+  ~DebMD5Pipeline();
+
+  DebMD5Pipeline(DebMD5Pipeline const&) = delete;
+  DebMD5Pipeline& operator=(DebMD5Pipeline const&) = delete;
+
+  //! Matches cmArchiveWrite::FileContentCallback.
+  void Consume(std::string const& file, const char* data, size_t size);
+
+  //! Waits for the workers and returns the hex digest of each file.
+  std::map<std::string, std::string> Finish();
+
+private:
+  struct FileState
+  {
+    std::string File;
+    cmCryptoHash Hash{ cmCryptoHash::AlgoMD5 };
+  };
+  struct Task
+  {
+    FileState* State;
+    std::vector<char> Data;
+    bool Last;
+  };
+
+  void Push(size_t worker, Task task);
+  void Work(size_t worker);
+
+  // Bound the memory held by blocks not yet hashed.
+  static size_t const MaxPendingBytes = 32 * 1024 * 1024;
+
+  std::vector<std::thread> Threads;
+  std::vector<std::deque<Task>> Queues;
+  std::vector<std::unique_ptr<FileState>> Files;
+  FileState* Current = nullptr;
+  size_t CurrentWorker = 0;
+  size_t PendingBytes = 0;
+  bool Done = false;
+  std::mutex Mutex;
+  std::condition_variable WorkAvailable;
+  std::condition_variable SpaceAvailable;
+  std::map<std::string, std::string> Digests;
+};
+
+DebMD5Pipeline::DebMD5Pipeline(unsigned int numWorkers)
+  : Queues(numWorkers ? numWorkers : 1)
+{
+  for (size_t i = 0; i < this->Queues.size(); ++i) {
+    this->Threads.emplace_back(&DebMD5Pipeline::Work, this, i);
+  }
+}
+
+DebMD5Pipeline::~DebMD5Pipeline()
+{
+  this->Finish();
+}
+
+void DebMD5Pipeline::Consume(std::string const& file, const char* data,
+                             size_t size)
+{
+  if (!this->Current) {
+    this->Files.emplace_back(cm::make_unique<FileState>());
+    this->Current = this->Files.back().get();
+    this->Current->File = file;
+    this->Current->Hash.Initialize();
+    this->CurrentWorker = (this->Files.size() - 1) % this->Queues.size();
+  }
+
+  Task task;
+  task.State = this->Current;
+  task.Last = !data;
+  if (data) {
+    task.Data.assign(data, data + size);
+  } else {
+    this->Current = nullptr;
+  }
+  this->Push(this->CurrentWorker, std::move(task));
+}
+
+void DebMD5Pipeline::Push(size_t worker, Task task)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->SpaceAvailable.wait(lock, [this] {
+    return this->PendingBytes < MaxPendingBytes;
+  });
+  this->PendingBytes += task.Data.size();
+  this->Queues[worker].push_back(std::move(task));
+  this->WorkAvailable.notify_all();
+}
+
+void DebMD5Pipeline::Work(size_t worker)
+{
+  std::deque<Task>& queue = this->Queues[worker];
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  for (;;) {
+    this->WorkAvailable.wait(
+      lock, [this, &queue] { return this->Done || !queue.empty(); });
+    if (queue.empty()) {
+      return;
+    }
+    Task task = std::move(queue.front());
+    queue.pop_front();
+    lock.unlock();
+
+    std::string digest;
+    if (!task.Data.empty()) {
+      task.State->Hash.Append(task.Data.data(), task.Data.size());
+    }
+    if (task.Last) {
+      digest = task.State->Hash.FinalizeHex();
+    }
+
+    lock.lock();
+    this->PendingBytes -= task.Data.size();
+    if (task.Last) {
+      this->Digests[task.State->File] = std::move(digest);
+    }
+    this->SpaceAvailable.notify_one();
+  }
+}
+
+std::map<std::string, std::string> DebMD5Pipeline::Finish()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Done = true;
+  }
+  this->WorkAvailable.notify_all();
+  for (std::thread& thread : this->Threads) {
+    thread.join();
+  }
+  this->Threads.clear();
+  return std::move(this->Digests);
+}
+
 class DebGenerator
 {
 public:
@@ -42,8 +194,9 @@ public:
 private:
   void generateDebianBinaryFile() const;
   void generateControlFile() const;
-  bool generateDataTar() const;
-  std::string generateMD5File() const;
+  bool generateDataTar(DebMD5Pipeline& md5Pipeline) const;
+  std::string generateMD5File(
+    std::map<std::string, std::string> const& md5Sums) const;
   bool generateControlTar(std::string const& md5Filename) const;
   bool generateDeb() const;
 
@@ -141,10 +294,15 @@ bool DebGenerator::generate() const
 {
   this->generateDebianBinaryFile();
   this->generateControlFile();
-  if (!this->generateDataTar()) {
+  // Hash the files while data.tar compresses them.
+  unsigned int numWorkers = this->NumThreads > 0
+    ? static_cast<unsigned int>(this->NumThreads)
+    : std::thread::hardware_concurrency();
+  DebMD5Pipeline md5Pipeline(numWorkers);
+  if (!this->generateDataTar(md5Pipeline)) {
     return false;
   }
-  std::string md5Filename = this->generateMD5File();
+  std::string md5Filename = this->generateMD5File(md5Pipeline.Finish());
   if (!this->generateControlTar(md5Filename)) {
     return false;
   }
@@ -180,7 +338,7 @@ void DebGenerator::generateControlFile() const
   out << "Installed-Size: " << (totalSize + 1023) / 1024 << "\n\n";
 }
 
-bool DebGenerator::generateDataTar() const
+bool DebGenerator::generateDataTar(DebMD5Pipeline& md5Pipeline) const
 {
   std::string filename_data_tar =
     this->WorkDir + "/data.tar" + this->CompressionSuffix;
@@ -200,6 +358,10 @@ bool DebGenerator::generateDataTar() const
   // always uid/gid equal to 0.
   data_tar.SetUIDAndGID(0u, 0u);
   data_tar.SetUNAMEAndGNAME("root", "root");
+  data_tar.SetFileContentCallback(
+    [&md5Pipeline](std::string const& file, const char* data, size_t size) {
+      md5Pipeline.Consume(file, data, size);
+    });
 
   // now add all directories which have to be compressed
   // collect all top level install dirs for that
@@ -265,7 +427,8 @@ bool DebGenerator::generateDataTar() const
   return true;
 }
 
-std::string DebGenerator::generateMD5File() const
+std::string DebGenerator::generateMD5File(
+  std::map<std::string, std::string> const& md5Sums) const
 {
   std::string md5filename = this->WorkDir + "/md5sums";
 
@@ -280,8 +443,11 @@ std::string DebGenerator::generateMD5File() const
       continue;
     }
 
-    std::string output =
-      cmSystemTools::ComputeFileHash(file, cmCryptoHash::AlgoMD5);
+    // Files archived in data.tar were hashed while being compressed.
+    auto md5 = md5Sums.find(file);
+    std::string output = md5 != md5Sums.end()
+      ? md5->second
+      : cmSystemTools::ComputeFileHash(file, cmCryptoHash::AlgoMD5);
     if (output.empty()) {
       cmCPackLogger(cmCPackLog::LOG_ERROR,
                     "Problem computing the md5 of " << file << std::endl);
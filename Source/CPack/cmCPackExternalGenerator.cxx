@@ -154,6 +154,23 @@ int cmCPackExternalGenerator::InstallCMakeProject(
   return 1;
 }
 
+int cmCPackExternalGenerator::InstallCMakeProjectComponents(
+  bool setDestDir, const std::string& installDirectory,
+  const std::string& baseTempInstallDirectory, const mode_t* default_dir_mode,
+  const std::vector<std::string>& components, bool componentInstall,
+  const std::string& installSubDirectory, const std::string& buildConfig,
+  std::string& absoluteDestFiles)
+{
+  if (this->StagingEnabled()) {
+    return this->cmCPackGenerator::InstallCMakeProjectComponents(
+      setDestDir, installDirectory, baseTempInstallDirectory,
+      default_dir_mode, components, componentInstall, installSubDirectory,
+      buildConfig, absoluteDestFiles);
+  }
+
+  return 1;
+}
+
 bool cmCPackExternalGenerator::StagingEnabled() const
 {
   return !cmIsOff(this->GetOption("CPACK_EXTERNAL_ENABLE_STAGING"));
@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "cm_sys_stat.h"
 
@@ -50,6 +51,13 @@ protected:
                           const std::string& installSubDirectory,
                           const std::string& buildConfig,
                           std::string& absoluteDestFiles) override;
+  int InstallCMakeProjectComponents(
+    bool setDestDir, const std::string& installDirectory,
+    const std::string& baseTempInstallDirectory,
+    const mode_t* default_dir_mode,
+    const std::vector<std::string>& components, bool componentInstall,
+    const std::string& installSubDirectory, const std::string& buildConfig,
+    std::string& absoluteDestFiles) override;
 
 private:
   bool StagingEnabled() const;
@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <cstring>
 #include <memory>
+#include <set>
+#include <thread>
 #include <utility>
 
 #include "cmsys/FStream.hxx"
@@ -20,12 +22,14 @@
 #include "cmGeneratedFileStream.h"
 #include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
+#include "cmOutputConverter.h"
 #include "cmProperty.h"
 #include "cmState.h"
 #include "cmStateSnapshot.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmVersion.h"
+#include "cmWorkerPool.h"
 #include "cmWorkingDirectory.h"
 #include "cmXMLSafe.h"
 #include "cmake.h"
@@ -668,13 +672,11 @@ int cmCPackGenerator::InstallProjectViaInstallCMakeProjects(
                                             << buildConfig << ']'
                                             << std::endl);
         // Run the installation for each component
-        for (std::string const& component : componentsVector) {
-          if (!this->InstallCMakeProject(
-                setDestDir, project.Directory, baseTempInstallDirectory,
-                default_dir_mode, component, componentInstall,
-                project.SubDirectory, buildConfig, absoluteDestFiles)) {
-            return 0;
-          }
+        if (!this->InstallCMakeProjectComponents(
+              setDestDir, project.Directory, baseTempInstallDirectory,
+              default_dir_mode, componentsVector, componentInstall,
+              project.SubDirectory, buildConfig, absoluteDestFiles)) {
+          return 0;
         }
       }
 
@@ -724,6 +726,215 @@ int cmCPackGenerator::RunPreinstallTarget(
   return 1;
 }
 
+int cmCPackGenerator::InstallCMakeProjectComponents(
+  bool setDestDir, const std::string& installDirectory,
+  const std::string& baseTempInstallDirectory, const mode_t* default_dir_mode,
+  const std::vector<std::string>& components, bool componentInstall,
+  const std::string& installSubDirectory, const std::string& buildConfig,
+  std::string& absoluteDestFiles)
+{
+  unsigned int jobs = 1;
+  if (const char* jobsStr = this->GetOption("CPACK_COMPONENTS_INSTALL_JOBS")) {
+    unsigned long value;
+    if (!cmStrToULong(jobsStr, &value)) {
+      cmCPackLogger(cmCPackLog::LOG_ERROR,
+                    "CPACK_COMPONENTS_INSTALL_JOBS is not a non-negative "
+                    "integer: "
+                      << jobsStr << std::endl);
+      return 0;
+    }
+    jobs = value ? static_cast<unsigned int>(value)
+                 : std::thread::hardware_concurrency();
+  }
+
+  // Components may only be installed concurrently when each of them is
+  // staged in a directory of its own.
+  bool parallel = jobs > 1 && componentInstall && components.size() > 1;
+  if (parallel) {
+    std::set<std::string> suffixes;
+    for (std::string const& component : components) {
+      if (!suffixes.insert(this->GetComponentInstallDirNameSuffix(component))
+             .second) {
+        cmCPackLogger(cmCPackLog::LOG_VERBOSE,
+                      "Components share an installation directory, "
+                      "installing them one at a time."
+                        << std::endl);
+        parallel = false;
+        break;
+      }
+    }
+  }
+
+  if (!parallel) {
+    for (std::string const& component : components) {
+      if (!this->InstallCMakeProject(setDestDir, installDirectory,
+                                     baseTempInstallDirectory,
+                                     default_dir_mode, component,
+                                     componentInstall, installSubDirectory,
+                                     buildConfig, absoluteDestFiles)) {
+        return 0;
+      }
+    }
+    return 1;
+  }
+
+  return this->InstallCMakeProjectComponentsInParallel(
+    jobs, setDestDir, installDirectory, baseTempInstallDirectory,
+    default_dir_mode, components, installSubDirectory, buildConfig,
+    absoluteDestFiles);
+}
+
+namespace {
+/**
+ * Runs the install script of one component in a separate cmake process.
+ */
+class cmCPackComponentInstallJob : public cmWorkerPool::JobT
+{
+public:
+  cmCPackComponentInstallJob(std::vector<std::string> command,
+                             std::string workingDirectory,
+                             cmWorkerPool::ProcessResultT* result)
+    : Command(std::move(command))
+    , WorkingDirectory(std::move(workingDirectory))
+    , Result(result)
+  {
+  }
+
+  void Process() override
+  {
+    this->RunProcess(*this->Result, this->Command, this->WorkingDirectory);
+  }
+
+private:
+  std::vector<std::string> Command;
+  std::string WorkingDirectory;
+  cmWorkerPool::ProcessResultT* Result;
+};
+
+class cmCPackComponentInstallEndJob : public cmWorkerPool::JobFenceT
+{
+public:
+  void Process() override { this->Pool()->Abort(); }
+};
+}
+
+int cmCPackGenerator::InstallCMakeProjectComponentsInParallel(
+  unsigned int jobs, bool setDestDir, const std::string& installDirectory,
+  const std::string& baseTempInstallDirectory, const mode_t* default_dir_mode,
+  const std::vector<std::string>& components,
+  const std::string& installSubDirectory, const std::string& buildConfig,
+  std::string& absoluteDestFiles)
+{
+  std::string installFile = installDirectory + "/cmake_install.cmake";
+  std::string driverDir = cmStrCat(
+    this->GetOption("CPACK_TOPLEVEL_DIRECTORY"), "/ComponentInstall");
+  cmSystemTools::MakeDirectory(driverDir);
+
+  cmCPackLogger(cmCPackLog::LOG_VERBOSE,
+                "Installing " << components.size() << " components using "
+                              << jobs << " jobs" << std::endl);
+
+  // Stage each component in its own directory and write a script that
+  // runs its installation with the variables InstallCMakeProject would set.
+  std::vector<CMakeProjectInstallSetup> setups(components.size());
+  std::vector<std::string> absoluteDestFilesFiles(components.size());
+  std::vector<cmWorkerPool::ProcessResultT> results(components.size());
+  cmWorkerPool pool;
+  pool.SetThreadCount(jobs);
+  for (size_t i = 0; i < components.size(); ++i) {
+    CMakeProjectInstallSetup& setup = setups[i];
+    if (!this->PrepareCMakeProjectInstall(
+          setDestDir, baseTempInstallDirectory, default_dir_mode,
+          components[i], true, installSubDirectory, buildConfig, setup)) {
+      return 0;
+    }
+
+    std::string base = cmStrCat(driverDir, '/', i);
+    if (!buildConfig.empty()) {
+      base += cmStrCat('-', buildConfig);
+    }
+    std::string driver = base + ".cmake";
+    absoluteDestFilesFiles[i] = base + "-absolute.txt";
+    cmSystemTools::RemoveFile(absoluteDestFilesFiles[i]);
+    {
+      cmGeneratedFileStream fout(driver);
+      fout.SetCopyIfDifferent(true);
+      fout << "# Installs component " << components[i] << "\n";
+      for (auto const& def : setup.Definitions) {
+        fout << "set(" << def.first << ' '
+             << cmOutputConverter::EscapeForCMake(def.second) << ")\n";
+      }
+      if (setup.SetDestDir) {
+        fout << "set(ENV{DESTDIR} "
+             << cmOutputConverter::EscapeForCMake(setup.TempInstallDirectory)
+             << ")\n";
+      }
+      fout << "include(" << cmOutputConverter::EscapeForCMake(installFile)
+           << ")\n"
+           << "if(DEFINED CMAKE_ABSOLUTE_DESTINATION_FILES)\n"
+           << "  set(CPACK_ABSOLUTE_DESTINATION_FILES"
+              " \"${CMAKE_ABSOLUTE_DESTINATION_FILES}\")\n"
+           << "endif()\n"
+           << "if(DEFINED CPACK_ABSOLUTE_DESTINATION_FILES)\n"
+           << "  file(WRITE "
+           << cmOutputConverter::EscapeForCMake(absoluteDestFilesFiles[i])
+           << " \"${CPACK_ABSOLUTE_DESTINATION_FILES}\")\n"
+           << "endif()\n";
+    }
+
+    std::vector<std::string> command = { cmSystemTools::GetCMakeCommand() };
+    if (this->TraceExpand) {
+      command.emplace_back("--trace-expand");
+    } else if (this->Trace) {
+      command.emplace_back("--trace");
+    }
+    command.emplace_back("-P");
+    command.emplace_back(driver);
+    pool.EmplaceJob<cmCPackComponentInstallJob>(std::move(command),
+                                                installDirectory, &results[i]);
+  }
+  pool.EmplaceJob<cmCPackComponentInstallEndJob>();
+  pool.Process();
+
+  // Report the outcome of each component in order, as a serial
+  // installation would have.
+  bool success = true;
+  for (size_t i = 0; i < components.size(); ++i) {
+    cmWorkerPool::ProcessResultT const& result = results[i];
+    cmCPackLogger(cmCPackLog::LOG_OUTPUT,
+                  "-   Install component: " << components[i] << std::endl);
+    if (!result.StdOut.empty()) {
+      cmCPackLogger(cmCPackLog::LOG_VERBOSE, result.StdOut);
+    }
+    if (result.error()) {
+      cmCPackLogger(cmCPackLog::LOG_ERROR,
+                    "Problem installing component " << components[i] << ":"
+                                                    << std::endl
+                                                    << result.ErrorMessage
+                                                    << result.StdErr
+                                                    << std::endl);
+      success = false;
+      continue;
+    }
+    if (!result.StdErr.empty()) {
+      cmCPackLogger(cmCPackLog::LOG_WARNING, result.StdErr);
+    }
+
+    std::string componentAbsoluteDestFiles;
+    bool const haveAbsoluteDestFiles =
+      cmSystemTools::FileExists(absoluteDestFilesFiles[i]);
+    if (haveAbsoluteDestFiles) {
+      cmsys::ifstream fin(absoluteDestFilesFiles[i].c_str());
+      cmSystemTools::GetLineFromStream(fin, componentAbsoluteDestFiles);
+    }
+    this->FinishCMakeProjectInstall(
+      components[i], true, setups[i],
+      haveAbsoluteDestFiles ? &componentAbsoluteDestFiles : nullptr,
+      absoluteDestFiles);
+  }
+  return success ? 1 : 0;
+}
+
 int cmCPackGenerator::InstallCMakeProject(
   bool setDestDir, const std::string& installDirectory,
   const std::string& baseTempInstallDirectory, const mode_t* default_dir_mode,
@@ -731,7 +942,6 @@ int cmCPackGenerator::InstallCMakeProject(
   const std::string& installSubDirectory, const std::string& buildConfig,
   std::string& absoluteDestFiles)
 {
-  std::string tempInstallDirectory = baseTempInstallDirectory;
   std::string installFile = installDirectory + "/cmake_install.cmake";
 
   if (componentInstall) {
@@ -751,6 +961,49 @@ int cmCPackGenerator::InstallCMakeProject(
   cm.SetTraceExpand(this->TraceExpand);
   cmGlobalGenerator gg(&cm);
   cmMakefile mf(&gg, cm.GetCurrentSnapshot());
+
+  CMakeProjectInstallSetup setup;
+  if (!this->PrepareCMakeProjectInstall(
+        setDestDir, baseTempInstallDirectory, default_dir_mode, component,
+        componentInstall, installSubDirectory, buildConfig, setup)) {
+    return 0;
+  }
+  for (auto const& def : setup.Definitions) {
+    mf.AddDefinition(def.first, def.second);
+  }
+  if (setup.SetDestDir) {
+    cmSystemTools::PutEnv("DESTDIR=" + setup.TempInstallDirectory);
+  }
+
+  // do installation
+  bool res = mf.ReadListFile(installFile);
+  // forward definition of CMAKE_ABSOLUTE_DESTINATION_FILES
+  // to CPack (may be used by generators like CPack RPM or DEB)
+  // in order to transparently handle ABSOLUTE PATH
+  if (cmProp def = mf.GetDefinition("CMAKE_ABSOLUTE_DESTINATION_FILES")) {
+    mf.AddDefinition("CPACK_ABSOLUTE_DESTINATION_FILES", *def);
+  }
+
+  this->FinishCMakeProjectInstall(
+    component, componentInstall, setup,
+    mf.GetDefinition("CPACK_ABSOLUTE_DESTINATION_FILES"), absoluteDestFiles);
+  if (cmSystemTools::GetErrorOccuredFlag() || !res) {
+    return 0;
+  }
+  return 1;
+}
+
+int cmCPackGenerator::PrepareCMakeProjectInstall(
+  bool setDestDir, const std::string& baseTempInstallDirectory,
+  const mode_t* default_dir_mode, const std::string& component,
+  bool componentInstall, const std::string& installSubDirectory,
+  const std::string& buildConfig, CMakeProjectInstallSetup& setup)
+{
+  std::string& tempInstallDirectory = setup.TempInstallDirectory;
+  tempInstallDirectory = baseTempInstallDirectory;
+  setup.SetDestDir = setDestDir;
+  auto& definitions = setup.Definitions;
+
   if (!installSubDirectory.empty() && installSubDirectory != "/" &&
       installSubDirectory != ".") {
     tempInstallDirectory += installSubDirectory;
@@ -773,8 +1026,8 @@ int cmCPackGenerator::InstallCMakeProject(
   const char* default_dir_inst_permissions =
     this->GetOption("CPACK_INSTALL_DEFAULT_DIRECTORY_PERMISSIONS");
   if (cmNonempty(default_dir_inst_permissions)) {
-    mf.AddDefinition("CMAKE_INSTALL_DEFAULT_DIRECTORY_PERMISSIONS",
-                     default_dir_inst_permissions);
+    definitions.emplace_back("CMAKE_INSTALL_DEFAULT_DIRECTORY_PERMISSIONS",
+                             default_dir_inst_permissions);
   }
 
   if (!setDestDir) {
@@ -801,7 +1054,7 @@ int cmCPackGenerator::InstallCMakeProject(
     if (this->GetOption("CPACK_INSTALL_PREFIX")) {
       dir += this->GetOption("CPACK_INSTALL_PREFIX");
     }
-    mf.AddDefinition("CMAKE_INSTALL_PREFIX", dir);
+    definitions.emplace_back("CMAKE_INSTALL_PREFIX", dir);
 
     cmCPackLogger(
       cmCPackLog::LOG_DEBUG,
@@ -830,7 +1083,6 @@ int cmCPackGenerator::InstallCMakeProject(
      *     - Because it was already used for component install
      *       in order to put things in subdirs...
      */
-    cmSystemTools::PutEnv("DESTDIR=" + tempInstallDirectory);
     cmCPackLogger(cmCPackLog::LOG_DEBUG,
                   "- Creating directory: '" << dir << "'" << std::endl);
 
@@ -841,7 +1093,7 @@ int cmCPackGenerator::InstallCMakeProject(
       return 0;
     }
   } else {
-    mf.AddDefinition("CMAKE_INSTALL_PREFIX", tempInstallDirectory);
+    definitions.emplace_back("CMAKE_INSTALL_PREFIX", tempInstallDirectory);
 
     if (!cmsys::SystemTools::MakeDirectory(tempInstallDirectory,
                                            default_dir_mode)) {
@@ -860,38 +1112,40 @@ int cmCPackGenerator::InstallCMakeProject(
   }
 
   if (!buildConfig.empty()) {
-    mf.AddDefinition("BUILD_TYPE", buildConfig);
+    definitions.emplace_back("BUILD_TYPE", buildConfig);
   }
   std::string installComponentLowerCase = cmSystemTools::LowerCase(component);
   if (installComponentLowerCase != "all") {
-    mf.AddDefinition("CMAKE_INSTALL_COMPONENT", component);
+    definitions.emplace_back("CMAKE_INSTALL_COMPONENT", component);
   }
 
   // strip on TRUE, ON, 1, one or several file names, but not on
   // FALSE, OFF, 0 and an empty string
   if (!cmIsOff(this->GetOption("CPACK_STRIP_FILES"))) {
-    mf.AddDefinition("CMAKE_INSTALL_DO_STRIP", "1");
+    definitions.emplace_back("CMAKE_INSTALL_DO_STRIP", "1");
+  }
+  // stage files as reflinks where possible, or as hard links on HARDLINK
+  const char* useLinks = this->GetOption("CPACK_INSTALL_USE_LINKS");
+  if (useLinks && (strcmp(useLinks, "HARDLINK") == 0 || cmIsOn(useLinks))) {
+    definitions.emplace_back("CMAKE_INSTALL_USE_LINKS", useLinks);
   }
   // Remember the list of files before installation
   // of the current component (if we are in component install)
-  std::string const& InstallPrefix = tempInstallDirectory;
-  std::vector<std::string> filesBefore;
-  std::string findExpr = tempInstallDirectory;
   if (componentInstall) {
     cmsys::Glob glB;
-    findExpr += "/*";
     glB.RecurseOn();
     glB.SetRecurseListDirs(true);
     glB.SetRecurseThroughSymlinks(false);
-    glB.FindFiles(findExpr);
-    filesBefore = glB.GetFiles();
-    std::sort(filesBefore.begin(), filesBefore.end());
+    glB.FindFiles(tempInstallDirectory + "/*");
+    setup.FilesBefore = glB.GetFiles();
+    std::sort(setup.FilesBefore.begin(), setup.FilesBefore.end());
   }
 
   // If CPack was asked to warn on ABSOLUTE INSTALL DESTINATION
   // then forward request to cmake_install.cmake script
   if (this->IsOn("CPACK_WARN_ON_ABSOLUTE_INSTALL_DESTINATION")) {
-    mf.AddDefinition("CMAKE_WARN_ON_ABSOLUTE_INSTALL_DESTINATION", "1");
+    definitions.emplace_back("CMAKE_WARN_ON_ABSOLUTE_INSTALL_DESTINATION",
+                             "1");
   }
   // If current CPack generator does support
   // ABSOLUTE INSTALL DESTINATION or CPack has been asked for
@@ -899,17 +1153,19 @@ int cmCPackGenerator::InstallCMakeProject(
   // as soon as it occurs (before installing file)
   if (!this->SupportsAbsoluteDestination() ||
       this->IsOn("CPACK_ERROR_ON_ABSOLUTE_INSTALL_DESTINATION")) {
-    mf.AddDefinition("CMAKE_ERROR_ON_ABSOLUTE_INSTALL_DESTINATION", "1");
-  }
-  // do installation
-  bool res = mf.ReadListFile(installFile);
-  // forward definition of CMAKE_ABSOLUTE_DESTINATION_FILES
-  // to CPack (may be used by generators like CPack RPM or DEB)
-  // in order to transparently handle ABSOLUTE PATH
-  if (cmProp def = mf.GetDefinition("CMAKE_ABSOLUTE_DESTINATION_FILES")) {
-    mf.AddDefinition("CPACK_ABSOLUTE_DESTINATION_FILES", *def);
+    definitions.emplace_back("CMAKE_ERROR_ON_ABSOLUTE_INSTALL_DESTINATION",
+                             "1");
   }
+  return 1;
+}
 
+void cmCPackGenerator::FinishCMakeProjectInstall(
+  const std::string& component, bool componentInstall,
+  CMakeProjectInstallSetup const& setup,
+  std::string const* componentAbsoluteDestFiles,
+  std::string& absoluteDestFiles)
+{
+  std::string const& InstallPrefix = setup.TempInstallDirectory;
   // Now rebuild the list of files after installation
   // of the current component (if we are in component install)
   if (componentInstall) {
@@ -917,14 +1173,14 @@ int cmCPackGenerator::InstallCMakeProject(
     glA.RecurseOn();
     glA.SetRecurseListDirs(true);
     glA.SetRecurseThroughSymlinks(false);
-    glA.FindFiles(findExpr);
+    glA.FindFiles(InstallPrefix + "/*");
     std::vector<std::string> filesAfter = glA.GetFiles();
     std::sort(filesAfter.begin(), filesAfter.end());
     std::vector<std::string>::iterator diff;
     std::vector<std::string> result(filesAfter.size());
     diff = std::set_difference(filesAfter.begin(), filesAfter.end(),
-                               filesBefore.begin(), filesBefore.end(),
-                               result.begin());
+                               setup.FilesBefore.begin(),
+                               setup.FilesBefore.end(), result.begin());
 
     std::vector<std::string>::iterator fit;
     std::string localFileName;
@@ -940,7 +1196,7 @@ int cmCPackGenerator::InstallCMakeProject(
     }
   }
 
-  if (cmProp d = mf.GetDefinition("CPACK_ABSOLUTE_DESTINATION_FILES")) {
+  if (std::string const* d = componentAbsoluteDestFiles) {
     if (!absoluteDestFiles.empty()) {
       absoluteDestFiles += ";";
     }
@@ -959,16 +1215,10 @@ int cmCPackGenerator::InstallCMakeProject(
         this->SetOption(absoluteDestFileComponent,
                         absoluteDestFilesListComponent.c_str());
       } else {
-        this->SetOption(
-          absoluteDestFileComponent,
-          cmToCStr(mf.GetDefinition("CPACK_ABSOLUTE_DESTINATION_FILES")));
+        this->SetOption(absoluteDestFileComponent, d->c_str());
       }
     }
   }
-  if (cmSystemTools::GetErrorOccuredFlag() || !res) {
-    return 0;
-  }
-  return 1;
 }
 
 bool cmCPackGenerator::ReadListFile(const char* moduleName)
@@ -7,6 +7,7 @@
 #include <map>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "cm_sys_stat.h"
@@ -198,6 +199,50 @@ protected:
     bool componentInstall, const std::string& installSubDirectory,
     const std::string& buildConfig, std::string& absoluteDestFiles);
 
+  /**
+   * Install the given components of a CMake project.  The components
+   * are installed concurrently, in separate cmake processes, when
+   * CPACK_COMPONENTS_INSTALL_JOBS allows it and each of them is staged
+   * in a directory of its own.  Otherwise InstallCMakeProject is called
+   * for each of them in turn.
+   */
+  virtual int InstallCMakeProjectComponents(
+    bool setDestDir, const std::string& installDirectory,
+    const std::string& baseTempInstallDirectory,
+    const mode_t* default_dir_mode,
+    const std::vector<std::string>& components, bool componentInstall,
+    const std::string& installSubDirectory, const std::string& buildConfig,
+    std::string& absoluteDestFiles);
+
+  //! Staging directory and install script variables of one component
+  struct CMakeProjectInstallSetup
+  {
+    std::string TempInstallDirectory;
+    bool SetDestDir = false;
+    std::vector<std::pair<std::string, std::string>> Definitions;
+    std::vector<std::string> FilesBefore;
+  };
+  int PrepareCMakeProjectInstall(bool setDestDir,
+                                 const std::string& baseTempInstallDirectory,
+                                 const mode_t* default_dir_mode,
+                                 const std::string& component,
+                                 bool componentInstall,
+                                 const std::string& installSubDirectory,
+                                 const std::string& buildConfig,
+                                 CMakeProjectInstallSetup& setup);
+  void FinishCMakeProjectInstall(
+    const std::string& component, bool componentInstall,
+    CMakeProjectInstallSetup const& setup,
+    std::string const* componentAbsoluteDestFiles,
+    std::string& absoluteDestFiles);
+  int InstallCMakeProjectComponentsInParallel(
+    unsigned int jobs, bool setDestDir, const std::string& installDirectory,
+    const std::string& baseTempInstallDirectory,
+    const mode_t* default_dir_mode,
+    const std::vector<std::string>& components,
+    const std::string& installSubDirectory, const std::string& buildConfig,
+    std::string& absoluteDestFiles);
+
   /**
    * The various level of support of
    * CPACK_SET_DESTDIR used by the generator.
@@ -86,6 +86,11 @@ static bool AllocateCTestResources(
   const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
   std::vector<cmCTestBinPackerAllocation>& allocations)
 {
+  // Avoid the recursive search if the requirements cannot possibly fit
+  if (!cmCTestResourcesMayFit(resources, allocations)) {
+    return false;
+  }
+
   // Sort the resource requirements in descending order by slots needed
   std::vector<cmCTestBinPackerAllocation*> allocationsPtr;
   allocationsPtr.reserve(allocations.size());
@@ -184,6 +189,44 @@ void BlockAllocationStrategy::IncrementalSort(
   }
   resourcesSorted[i] = tmp;
 }
+
+class BestFitAllocationStrategy
+{
+public:
+  static void InitialSort(
+    const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+    std::vector<std::string>& resourcesSorted);
+
+  static void IncrementalSort(
+    const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+    std::vector<std::string>& resourcesSorted, std::size_t lastAllocatedIndex);
+};
+
+void BestFitAllocationStrategy::InitialSort(
+  const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+  std::vector<std::string>& resourcesSorted)
+{
+  std::stable_sort(
+    resourcesSorted.begin(), resourcesSorted.end(),
+    [&resources](const std::string& id1, const std::string& id2) {
+      return resources.at(id1).Free() < resources.at(id2).Free();
+    });
+}
+
+void BestFitAllocationStrategy::IncrementalSort(
+  const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+  std::vector<std::string>& resourcesSorted, std::size_t lastAllocatedIndex)
+{
+  auto tmp = resourcesSorted[lastAllocatedIndex];
+  std::size_t i = lastAllocatedIndex;
+  while (i > 0 &&
+         resources.at(resourcesSorted[i - 1]).Free() >
+           resources.at(tmp).Free()) {
+    resourcesSorted[i] = resourcesSorted[i - 1];
+    --i;
+  }
+  resourcesSorted[i] = tmp;
+}
 }
 
 bool cmAllocateCTestResourcesRoundRobin(
@@ -201,3 +244,118 @@ bool cmAllocateCTestResourcesBlock(
   return AllocateCTestResources<BlockAllocationStrategy>(resources,
                                                          allocations);
 }
+
+bool cmAllocateCTestResourcesBestFit(
+  const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+  std::vector<cmCTestBinPackerAllocation>& allocations)
+{
+  return AllocateCTestResources<BestFitAllocationStrategy>(resources,
+                                                           allocations);
+}
+
+bool cmCTestResourcesMayFit(
+  const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+  const std::vector<cmCTestBinPackerAllocation>& allocations)
+{
+  unsigned long totalFree = 0;
+  unsigned int maxFree = 0;
+  for (auto const& res : resources) {
+    totalFree += res.second.Free();
+    maxFree = std::max(maxFree, res.second.Free());
+  }
+
+  unsigned long totalNeeded = 0;
+  unsigned int maxNeeded = 0;
+  for (auto const& allocation : allocations) {
+    auto slots = static_cast<unsigned int>(allocation.SlotsNeeded);
+    totalNeeded += slots;
+    maxNeeded = std::max(maxNeeded, slots);
+  }
+
+  return totalNeeded <= totalFree && maxNeeded <= maxFree;
+}
+
+double cmCTestResourceFragmentation(
+  const std::map<std::string, cmCTestResourceAllocator::Resource>& resources)
+{
+  unsigned long totalFree = 0;
+  unsigned int maxFree = 0;
+  for (auto const& res : resources) {
+    totalFree += res.second.Free();
+    maxFree = std::max(maxFree, res.second.Free());
+  }
+  if (totalFree == 0) {
+    return 0.0;
+  }
+  return 1.0 - static_cast<double>(maxFree) / static_cast<double>(totalFree);
+}
+
+namespace {
+std::vector<int> cmCTestSortedSlots(
+  const std::vector<cmCTestBinPackerAllocation>& allocations)
+{
+  std::vector<int> slots;
+  slots.reserve(allocations.size());
+  for (auto const& allocation : allocations) {
+    slots.push_back(allocation.SlotsNeeded);
+  }
+  std::sort(slots.rbegin(), slots.rend());
+  return slots;
+}
+
+// Whether 'needed' cannot fit wherever 'rejected' cannot: its largest
+// requirements alone need at least the slots 'rejected' needs.
+bool cmCTestSlotsDominate(const std::vector<int>& needed,
+                          const std::vector<int>& rejected)
+{
+  if (needed.size() < rejected.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < rejected.size(); ++i) {
+    if (needed[i] < rejected[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+bool cmCTestResourceRejectionIndex::IsRejected(
+  const std::string& resourceType,
+  const std::vector<cmCTestBinPackerAllocation>& allocations) const
+{
+  auto it = this->Rejected.find(resourceType);
+  if (it == this->Rejected.end()) {
+    return false;
+  }
+  std::vector<int> const slots = cmCTestSortedSlots(allocations);
+  return std::any_of(it->second.begin(), it->second.end(),
+                     [&slots](const std::vector<int>& rejected) {
+                       return cmCTestSlotsDominate(slots, rejected);
+                     });
+}
+
+void cmCTestResourceRejectionIndex::Reject(
+  const std::string& resourceType,
+  const std::vector<cmCTestBinPackerAllocation>& allocations)
+{
+  std::vector<int> slots = cmCTestSortedSlots(allocations);
+  auto& rejected = this->Rejected[resourceType];
+  // Entries dominating the new one are implied by it.
+  rejected.erase(std::remove_if(rejected.begin(), rejected.end(),
+                                [&slots](const std::vector<int>& r) {
+                                  return cmCTestSlotsDominate(r, slots);
+                                }),
+                 rejected.end());
+  rejected.push_back(std::move(slots));
+}
+
+void cmCTestResourceRejectionIndex::Clear(const std::string& resourceType)
+{
+  this->Rejected.erase(resourceType);
+}
+
+void cmCTestResourceRejectionIndex::Clear()
+{
+  this->Rejected.clear();
+}
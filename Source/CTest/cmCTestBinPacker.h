@@ -26,3 +26,48 @@ bool cmAllocateCTestResourcesRoundRobin(
 bool cmAllocateCTestResourcesBlock(
   const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
   std::vector<cmCTestBinPackerAllocation>& allocations);
+
+bool cmAllocateCTestResourcesBestFit(
+  const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+  std::vector<cmCTestBinPackerAllocation>& allocations);
+
+/**
+ * Cheap necessary condition for an allocation to succeed: the requirements
+ * must fit in the total free slots, and the largest one must fit in the
+ * resource with the most free slots.  Returns false only if no allocation
+ * is possible.
+ */
+bool cmCTestResourcesMayFit(
+  const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+  const std::vector<cmCTestBinPackerAllocation>& allocations);
+
+/**
+ * Fraction of free slots that are not on the resource with the most free
+ * slots: 0 when all free slots are on one resource, approaching 1 as they
+ * are scattered across many resources.
+ */
+double cmCTestResourceFragmentation(
+  const std::map<std::string, cmCTestResourceAllocator::Resource>& resources);
+
+/**
+ * Requirements of each resource type known not to fit in the free slots.
+ * A requirement whose slot counts, sorted in descending order, are each at
+ * least those of a rejected one cannot fit either, so it is rejected
+ * without a search.  The entries of a resource type remain valid while
+ * slots of that type are only allocated, and are cleared when slots of
+ * that type are freed.
+ */
+class cmCTestResourceRejectionIndex
+{
+public:
+  bool IsRejected(
+    const std::string& resourceType,
+    const std::vector<cmCTestBinPackerAllocation>& allocations) const;
+  void Reject(const std::string& resourceType,
+              const std::vector<cmCTestBinPackerAllocation>& allocations);
+  void Clear(const std::string& resourceType);
+  void Clear();
+
+private:
+  std::map<std::string, std::vector<std::vector<int>>> Rejected;
+};
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -31,6 +32,7 @@
 #include "cmParsePHPCoverage.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
+#include "cmWorkerPool.h"
 #include "cmWorkingDirectory.h"
 #include "cmXMLWriter.h"
 
@@ -924,6 +926,287 @@ int cmCTestCoverageHandler::HandleBlanketJSCoverage(
   }
   return static_cast<int>(cont->TotalCoverage.size());
 }
+namespace {
+// The results of running gcov on one coverage data file.  Files are
+// processed concurrently, so log messages and coverage are collected
+// here and merged into the coverage container in the original order.
+struct GCovFileResult
+{
+  std::string File;
+  std::string Command;
+  bool Ran = false;
+  std::int64_t RetVal = 0;
+  std::string Output;
+  std::string Errors;
+  int Style = 0;
+  int ErrorCount = 0;
+  std::vector<std::pair<int, std::string>> Messages;
+  std::string LogFileOutput;
+  std::vector<std::string> MissingFiles;
+  cmCTestCoverageHandlerContainer::TotalCoverageMap Coverage;
+};
+
+struct GCovSettings
+{
+  std::vector<std::string> BaseArgs;
+  std::string TempDir;
+  std::string SourceDir;
+  std::string BinaryDir;
+  bool SeparateWorkDirs = false;
+};
+
+void ParseGCovOutput(GCovFileResult& result, std::string const& workDir,
+                     GCovSettings const& settings)
+{
+  // Style 1
+  cmsys::RegularExpression st1re1(
+    "[0-9]+\\.[0-9]+% of [0-9]+ (source |)lines executed in file (.*)$");
+  cmsys::RegularExpression st1re2("^Creating (.*\\.gcov)\\.");
+
+  // Style 2
+  cmsys::RegularExpression st2re1("^File *[`'](.*)'$");
+  cmsys::RegularExpression st2re2(
+    "Lines executed: *[0-9]+\\.[0-9]+% of [0-9]+$");
+  cmsys::RegularExpression st2re3("^(.*)reating [`'](.*\\.gcov)'");
+  cmsys::RegularExpression st2re4("^(.*):unexpected EOF *$");
+  cmsys::RegularExpression st2re5("^(.*):cannot open source file*$");
+  cmsys::RegularExpression st2re6(
+    "^(.*):source file is newer than graph file `(.*)'$");
+
+  auto log = [&result](int logType, std::string msg) {
+    result.Messages.emplace_back(logType, std::move(msg));
+  };
+  auto checkStyle = [&result, &log](int style, const char* code) -> bool {
+    if (result.Style == 0) {
+      result.Style = style;
+    }
+    if (result.Style != style) {
+      log(cmCTest::ERROR_MESSAGE,
+          cmStrCat("Unknown gcov output style ", code, '\n'));
+      result.ErrorCount++;
+      return false;
+    }
+    return true;
+  };
+
+  std::string actualSourceFile;
+  std::set<std::string> missingFiles;
+  std::vector<std::string> lines;
+  cmsys::SystemTools::Split(result.Output, lines);
+
+  for (std::string const& line : lines) {
+    std::string sourceFile;
+    std::string gcovFile;
+
+    log(cmCTest::DEBUG, cmStrCat("Line: [", line, "]\n"));
+
+    if (line.empty()) {
+      // Ignore empty line; probably style 2
+    } else if (st1re1.find(line)) {
+      if (!checkStyle(1, "e1")) {
+        break;
+      }
+      actualSourceFile.clear();
+      sourceFile = st1re1.match(2);
+    } else if (st1re2.find(line)) {
+      if (!checkStyle(1, "e2")) {
+        break;
+      }
+      gcovFile = st1re2.match(1);
+    } else if (st2re1.find(line)) {
+      if (!checkStyle(2, "e3")) {
+        break;
+      }
+      actualSourceFile.clear();
+      sourceFile = st2re1.match(1);
+    } else if (st2re2.find(line)) {
+      if (!checkStyle(2, "e4")) {
+        break;
+      }
+    } else if (st2re3.find(line)) {
+      if (!checkStyle(2, "e5")) {
+        break;
+      }
+      gcovFile = st2re3.match(2);
+    } else if (st2re4.find(line)) {
+      if (!checkStyle(2, "e6")) {
+        break;
+      }
+      log(cmCTest::WARNING,
+          cmStrCat("Warning: ", st2re4.match(1), " had unexpected EOF\n"));
+    } else if (st2re5.find(line)) {
+      if (!checkStyle(2, "e7")) {
+        break;
+      }
+      log(cmCTest::WARNING,
+          cmStrCat("Warning: Cannot open file: ", st2re5.match(1), '\n'));
+    } else if (st2re6.find(line)) {
+      if (!checkStyle(2, "e8")) {
+        break;
+      }
+      log(cmCTest::WARNING,
+          cmStrCat("Warning: File: ", st2re6.match(1), " is newer than ",
+                   st2re6.match(2), '\n'));
+    } else {
+      // gcov 4.7 can have output lines saying "No executable lines" and
+      // "Removing 'filename.gcov'"... Don't log those as "errors."
+      if (line != "No executable lines" &&
+          !cmHasLiteralPrefix(line, "Removing ")) {
+        log(cmCTest::ERROR_MESSAGE,
+            cmStrCat("Unknown gcov output line: [", line, "]\n"));
+        result.ErrorCount++;
+      }
+    }
+
+    // If the last line of gcov output gave us a valid value for gcovFile,
+    // and we have an actualSourceFile, then insert a (or add to existing)
+    // SingleFileCoverageVector for actualSourceFile:
+    //
+    if (!gcovFile.empty() && !actualSourceFile.empty()) {
+      cmCTestCoverageHandlerContainer::SingleFileCoverageVector& vec =
+        result.Coverage[actualSourceFile];
+
+      log(cmCTest::HANDLER_VERBOSE_OUTPUT,
+          cmStrCat("   in gcovFile: ", gcovFile, '\n'));
+
+      std::string const gcovPath =
+        cmSystemTools::CollapseFullPath(gcovFile, workDir);
+      cmsys::ifstream ifile(gcovPath.c_str());
+      if (!ifile) {
+        log(cmCTest::ERROR_MESSAGE,
+            cmStrCat("Cannot open file: ", gcovFile, '\n'));
+      } else {
+        long cnt = -1;
+        std::string nl;
+        while (cmSystemTools::GetLineFromStream(ifile, nl)) {
+          cnt++;
+
+          // Skip empty lines
+          if (nl.empty()) {
+            continue;
+          }
+
+          // Skip unused lines
+          if (nl.size() < 12) {
+            continue;
+          }
+
+          // Handle gcov 3.0 non-coverage lines
+          // non-coverage lines seem to always start with something not
+          // a space and don't have a ':' in the 9th position
+          // TODO: Verify that this is actually a robust metric
+          if (nl[0] != ' ' && nl[9] != ':') {
+            continue;
+          }
+
+          // Read the coverage count from the beginning of the gcov output
+          // line
+          std::string prefix = nl.substr(0, 12);
+          int cov = atoi(prefix.c_str());
+
+          // Read the line number starting at the 10th character of the gcov
+          // output line
+          std::string lineNumber = nl.substr(10, 5);
+
+          int lineIdx = atoi(lineNumber.c_str()) - 1;
+          if (lineIdx >= 0) {
+            while (vec.size() <= static_cast<size_t>(lineIdx)) {
+              vec.push_back(-1);
+            }
+
+            // Initially all entries are -1 (not used). If we get coverage
+            // information, increment it to 0 first.
+            if (vec[lineIdx] < 0) {
+              if (cov > 0 || prefix.find('#') != std::string::npos) {
+                vec[lineIdx] = 0;
+              }
+            }
+
+            vec[lineIdx] += cov;
+          }
+        }
+      }
+
+      actualSourceFile.clear();
+    }
+
+    if (!sourceFile.empty() && actualSourceFile.empty()) {
+      gcovFile.clear();
+
+      // Is it in the source dir or the binary dir?
+      //
+      if (IsFileInDir(sourceFile, settings.SourceDir)) {
+        log(cmCTest::HANDLER_VERBOSE_OUTPUT,
+            cmStrCat("   produced s: ", sourceFile, '\n'));
+        result.LogFileOutput +=
+          cmStrCat("  produced in source dir: ", sourceFile, '\n');
+        actualSourceFile = cmSystemTools::CollapseFullPath(sourceFile);
+      } else if (IsFileInDir(sourceFile, settings.BinaryDir)) {
+        log(cmCTest::HANDLER_VERBOSE_OUTPUT,
+            cmStrCat("   produced b: ", sourceFile, '\n'));
+        result.LogFileOutput +=
+          cmStrCat("  produced in binary dir: ", sourceFile, '\n');
+        actualSourceFile = cmSystemTools::CollapseFullPath(sourceFile);
+      }
+
+      if (actualSourceFile.empty() && missingFiles.insert(sourceFile).second) {
+        result.MissingFiles.push_back(sourceFile);
+      }
+    }
+  }
+}
+
+class GCovJob : public cmWorkerPool::JobT
+{
+public:
+  GCovJob(GCovFileResult& result, GCovSettings const& settings)
+    : Result(result)
+    , Settings(settings)
+  {
+  }
+
+  void Process() override
+  {
+    // Each worker runs gcov in its own directory because gcov writes its
+    // .gcov files to the working directory, named after the source files.
+    std::string workDir = this->Settings.TempDir;
+    if (this->Settings.SeparateWorkDirs) {
+      workDir = cmStrCat(workDir, '/', this->WorkerIndex());
+    }
+
+    // Call gcov to get coverage data for this *.gcda file:
+    //
+    std::vector<std::string> covargs = this->Settings.BaseArgs;
+    covargs.push_back(cmSystemTools::GetFilenamePath(this->Result.File));
+    covargs.push_back(this->Result.File);
+    this->Result.Command = joinCommandLine(covargs);
+
+    cmWorkerPool::ProcessResultT process;
+    this->RunProcess(process, covargs, workDir);
+    this->Result.Ran = process.ErrorMessage.empty();
+    this->Result.RetVal = process.ExitStatus;
+    this->Result.Output = std::move(process.StdOut);
+    this->Result.Errors = std::move(process.StdErr);
+    if (!this->Result.Ran) {
+      this->Result.Errors += process.ErrorMessage;
+      return;
+    }
+
+    ParseGCovOutput(this->Result, workDir, this->Settings);
+  }
+
+private:
+  GCovFileResult& Result;
+  GCovSettings const& Settings;
+};
+
+class GCovEndJob : public cmWorkerPool::JobFenceT
+{
+public:
+  void Process() override { this->Pool()->Abort(); }
+};
+}
+
 int cmCTestCoverageHandler::HandleGCovCoverage(
   cmCTestCoverageHandlerContainer* cont)
 {
@@ -943,29 +1226,6 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
     return 0;
   }
 
-  // Style 1
-  std::string st1gcovOutputRex1 =
-    "[0-9]+\\.[0-9]+% of [0-9]+ (source |)lines executed in file (.*)$";
-  std::string st1gcovOutputRex2 = "^Creating (.*\\.gcov)\\.";
-  cmsys::RegularExpression st1re1(st1gcovOutputRex1.c_str());
-  cmsys::RegularExpression st1re2(st1gcovOutputRex2.c_str());
-
-  // Style 2
-  std::string st2gcovOutputRex1 = "^File *[`'](.*)'$";
-  std::string st2gcovOutputRex2 =
-    "Lines executed: *[0-9]+\\.[0-9]+% of [0-9]+$";
-  std::string st2gcovOutputRex3 = "^(.*)reating [`'](.*\\.gcov)'";
-  std::string st2gcovOutputRex4 = "^(.*):unexpected EOF *$";
-  std::string st2gcovOutputRex5 = "^(.*):cannot open source file*$";
-  std::string st2gcovOutputRex6 =
-    "^(.*):source file is newer than graph file `(.*)'$";
-  cmsys::RegularExpression st2re1(st2gcovOutputRex1.c_str());
-  cmsys::RegularExpression st2re2(st2gcovOutputRex2.c_str());
-  cmsys::RegularExpression st2re3(st2gcovOutputRex3.c_str());
-  cmsys::RegularExpression st2re4(st2gcovOutputRex4.c_str());
-  cmsys::RegularExpression st2re5(st2gcovOutputRex5.c_str());
-  cmsys::RegularExpression st2re6(st2gcovOutputRex6.c_str());
-
   std::vector<std::string> files;
   this->FindGCovFiles(files);
 
@@ -987,11 +1247,26 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
   }
   cmWorkingDirectory workdir(tempDir);
 
+  // Run gcov on as many files at once as tests may run in parallel.
+  unsigned int threadCount = static_cast<unsigned int>(
+    std::max(1, std::min(this->CTest->GetParallelLevel(),
+                         static_cast<int>(files.size()))));
+
+  GCovSettings settings;
+  settings.TempDir = tempDir;
+  settings.SourceDir = cont->SourceDir;
+  settings.BinaryDir = cont->BinaryDir;
+  settings.SeparateWorkDirs = threadCount > 1;
+  if (settings.SeparateWorkDirs) {
+    for (unsigned int i = 0; i < threadCount; ++i) {
+      cmSystemTools::MakeDirectory(cmStrCat(tempDir, '/', i));
+    }
+  }
+
   int gcovStyle = 0;
 
   std::set<std::string> missingFiles;
 
-  std::string actualSourceFile;
   cmCTestOptionalLog(
     this->CTest, HANDLER_OUTPUT,
     "   Processing coverage (each . represents one file):" << std::endl,
@@ -1003,53 +1278,54 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
   cmCTestCoverageHandlerLocale locale_C;
   static_cast<void>(locale_C);
 
-  std::vector<std::string> basecovargs =
-    cmSystemTools::ParseArguments(gcovExtraFlags);
-  basecovargs.insert(basecovargs.begin(), gcovCommand);
-  basecovargs.emplace_back("-o");
+  settings.BaseArgs = cmSystemTools::ParseArguments(gcovExtraFlags);
+  settings.BaseArgs.insert(settings.BaseArgs.begin(), gcovCommand);
+  settings.BaseArgs.emplace_back("-o");
 
   // files is a list of *.da and *.gcda files with coverage data in them.
   // These are binary files that you give as input to gcov so that it will
   // give us text output we can analyze to summarize coverage.
   //
-  for (std::string const& f : files) {
+  auto gcovStart = std::chrono::steady_clock::now();
+  std::vector<GCovFileResult> results(files.size());
+  {
+    cmWorkerPool pool;
+    pool.SetThreadCount(threadCount);
+    for (size_t i = 0; i < files.size(); ++i) {
+      results[i].File = files[i];
+      pool.EmplaceJob<GCovJob>(results[i], settings);
+    }
+    pool.EmplaceJob<GCovEndJob>();
+    pool.Process();
+  }
+  auto mergeStart = std::chrono::steady_clock::now();
+
+  for (GCovFileResult& result : results) {
+    std::string const& f = result.File;
     cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT, "." << std::flush,
                        this->Quiet);
 
-    // Call gcov to get coverage data for this *.gcda file:
-    //
     std::string fileDir = cmSystemTools::GetFilenamePath(f);
-    std::vector<std::string> covargs = basecovargs;
-    covargs.push_back(fileDir);
-    covargs.push_back(f);
-    const std::string command = joinCommandLine(covargs);
-
     cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                       command << std::endl, this->Quiet);
+                       result.Command << std::endl, this->Quiet);
 
-    std::string output;
-    std::string errors;
-    int retVal = 0;
     *cont->OFS << "* Run coverage for: " << fileDir << std::endl;
-    *cont->OFS << "  Command: " << command << std::endl;
-    int res = this->CTest->RunCommand(covargs, &output, &errors, &retVal,
-                                      tempDir.c_str(),
-                                      cmDuration::zero() /*this->TimeOut*/);
-
-    *cont->OFS << "  Output: " << output << std::endl;
-    *cont->OFS << "  Errors: " << errors << std::endl;
-    if (!res) {
+    *cont->OFS << "  Command: " << result.Command << std::endl;
+    *cont->OFS << "  Output: " << result.Output << std::endl;
+    *cont->OFS << "  Errors: " << result.Errors << std::endl;
+    if (!result.Ran) {
       cmCTestLog(this->CTest, ERROR_MESSAGE,
                  "Problem running coverage on file: " << f << std::endl);
       cmCTestLog(this->CTest, ERROR_MESSAGE,
-                 "Command produced error: " << errors << std::endl);
+                 "Command produced error: " << result.Errors << std::endl);
       cont->Error++;
       continue;
     }
-    if (retVal != 0) {
+    if (result.RetVal != 0) {
       cmCTestLog(this->CTest, ERROR_MESSAGE,
-                 "Coverage command returned: "
-                   << retVal << " while processing: " << f << std::endl);
+                 "Coverage command returned: " << result.RetVal
+                                               << " while processing: " << f
+                                               << std::endl);
       cmCTestLog(this->CTest, ERROR_MESSAGE,
                  "Command produced error: " << cont->Error << std::endl);
     }
@@ -1057,256 +1333,64 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
       this->CTest, HANDLER_VERBOSE_OUTPUT,
       "--------------------------------------------------------------"
         << std::endl
-        << output << std::endl
+        << result.Output << std::endl
         << "--------------------------------------------------------------"
         << std::endl,
       this->Quiet);
 
-    std::vector<std::string> lines;
-    cmsys::SystemTools::Split(output, lines);
-
-    for (std::string const& line : lines) {
-      std::string sourceFile;
-      std::string gcovFile;
-
-      cmCTestOptionalLog(this->CTest, DEBUG,
-                         "Line: [" << line << "]" << std::endl, this->Quiet);
-
-      if (line.empty()) {
-        // Ignore empty line; probably style 2
-      } else if (st1re1.find(line)) {
-        if (gcovStyle == 0) {
-          gcovStyle = 1;
-        }
-        if (gcovStyle != 1) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Unknown gcov output style e1" << std::endl);
-          cont->Error++;
-          break;
-        }
-
-        actualSourceFile.clear();
-        sourceFile = st1re1.match(2);
-      } else if (st1re2.find(line)) {
-        if (gcovStyle == 0) {
-          gcovStyle = 1;
-        }
-        if (gcovStyle != 1) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Unknown gcov output style e2" << std::endl);
-          cont->Error++;
-          break;
-        }
-
-        gcovFile = st1re2.match(1);
-      } else if (st2re1.find(line)) {
-        if (gcovStyle == 0) {
-          gcovStyle = 2;
-        }
-        if (gcovStyle != 2) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Unknown gcov output style e3" << std::endl);
-          cont->Error++;
-          break;
-        }
-
-        actualSourceFile.clear();
-        sourceFile = st2re1.match(1);
-      } else if (st2re2.find(line)) {
-        if (gcovStyle == 0) {
-          gcovStyle = 2;
-        }
-        if (gcovStyle != 2) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Unknown gcov output style e4" << std::endl);
-          cont->Error++;
-          break;
-        }
-      } else if (st2re3.find(line)) {
-        if (gcovStyle == 0) {
-          gcovStyle = 2;
-        }
-        if (gcovStyle != 2) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Unknown gcov output style e5" << std::endl);
-          cont->Error++;
-          break;
-        }
-
-        gcovFile = st2re3.match(2);
-      } else if (st2re4.find(line)) {
-        if (gcovStyle == 0) {
-          gcovStyle = 2;
-        }
-        if (gcovStyle != 2) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Unknown gcov output style e6" << std::endl);
-          cont->Error++;
-          break;
-        }
-
-        cmCTestOptionalLog(this->CTest, WARNING,
-                           "Warning: " << st2re4.match(1)
-                                       << " had unexpected EOF" << std::endl,
-                           this->Quiet);
-      } else if (st2re5.find(line)) {
-        if (gcovStyle == 0) {
-          gcovStyle = 2;
-        }
-        if (gcovStyle != 2) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Unknown gcov output style e7" << std::endl);
-          cont->Error++;
-          break;
-        }
-
-        cmCTestOptionalLog(this->CTest, WARNING,
-                           "Warning: Cannot open file: " << st2re5.match(1)
-                                                         << std::endl,
-                           this->Quiet);
-      } else if (st2re6.find(line)) {
-        if (gcovStyle == 0) {
-          gcovStyle = 2;
-        }
-        if (gcovStyle != 2) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Unknown gcov output style e8" << std::endl);
-          cont->Error++;
-          break;
-        }
-
-        cmCTestOptionalLog(this->CTest, WARNING,
-                           "Warning: File: " << st2re6.match(1)
-                                             << " is newer than "
-                                             << st2re6.match(2) << std::endl,
-                           this->Quiet);
+    for (auto const& msg : result.Messages) {
+      if (msg.first == cmCTest::ERROR_MESSAGE) {
+        cmCTestLog(this->CTest, ERROR_MESSAGE, msg.second);
       } else {
-        // gcov 4.7 can have output lines saying "No executable lines" and
-        // "Removing 'filename.gcov'"... Don't log those as "errors."
-        if (line != "No executable lines" &&
-            !cmHasLiteralPrefix(line, "Removing ")) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Unknown gcov output line: [" << line << "]"
-                                                   << std::endl);
-          cont->Error++;
-          // abort();
-        }
+        this->CTest->Log(msg.first, __FILE__, __LINE__, msg.second.c_str(),
+                         this->Quiet);
       }
+    }
+    *cont->OFS << result.LogFileOutput;
+    cont->Error += result.ErrorCount;
 
-      // If the last line of gcov output gave us a valid value for gcovFile,
-      // and we have an actualSourceFile, then insert a (or add to existing)
-      // SingleFileCoverageVector for actualSourceFile:
-      //
-      if (!gcovFile.empty() && !actualSourceFile.empty()) {
-        cmCTestCoverageHandlerContainer::SingleFileCoverageVector& vec =
-          cont->TotalCoverage[actualSourceFile];
-
+    for (std::string const& sourceFile : result.MissingFiles) {
+      if (missingFiles.insert(sourceFile).second) {
+        cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                           "Something went wrong" << std::endl, this->Quiet);
         cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                           "   in gcovFile: " << gcovFile << std::endl,
+                           "Cannot find file: [" << sourceFile << "]"
+                                                 << std::endl,
                            this->Quiet);
-
-        cmsys::ifstream ifile(gcovFile.c_str());
-        if (!ifile) {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-                     "Cannot open file: " << gcovFile << std::endl);
-        } else {
-          long cnt = -1;
-          std::string nl;
-          while (cmSystemTools::GetLineFromStream(ifile, nl)) {
-            cnt++;
-
-            // Skip empty lines
-            if (nl.empty()) {
-              continue;
-            }
-
-            // Skip unused lines
-            if (nl.size() < 12) {
-              continue;
-            }
-
-            // Handle gcov 3.0 non-coverage lines
-            // non-coverage lines seem to always start with something not
-            // a space and don't have a ':' in the 9th position
-            // TODO: Verify that this is actually a robust metric
-            if (nl[0] != ' ' && nl[9] != ':') {
-              continue;
-            }
-
-            // Read the coverage count from the beginning of the gcov output
-            // line
-            std::string prefix = nl.substr(0, 12);
-            int cov = atoi(prefix.c_str());
-
-            // Read the line number starting at the 10th character of the gcov
-            // output line
-            std::string lineNumber = nl.substr(10, 5);
-
-            int lineIdx = atoi(lineNumber.c_str()) - 1;
-            if (lineIdx >= 0) {
-              while (vec.size() <= static_cast<size_t>(lineIdx)) {
-                vec.push_back(-1);
-              }
-
-              // Initially all entries are -1 (not used). If we get coverage
-              // information, increment it to 0 first.
-              if (vec[lineIdx] < 0) {
-                if (cov > 0 || prefix.find('#') != std::string::npos) {
-                  vec[lineIdx] = 0;
-                }
-              }
-
-              vec[lineIdx] += cov;
-            }
-          }
-        }
-
-        actualSourceFile.clear();
+        cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                           " in source dir: [" << cont->SourceDir << "]"
+                                               << std::endl,
+                           this->Quiet);
+        cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                           " or binary dir: [" << cont->BinaryDir.size()
+                                               << "]" << std::endl,
+                           this->Quiet);
+        *cont->OFS << "  Something went wrong. Cannot find file: "
+                   << sourceFile << " in source dir: " << cont->SourceDir
+                   << " or binary dir: " << cont->BinaryDir << std::endl;
       }
+    }
 
-      if (!sourceFile.empty() && actualSourceFile.empty()) {
-        gcovFile.clear();
-
-        // Is it in the source dir or the binary dir?
-        //
-        if (IsFileInDir(sourceFile, cont->SourceDir)) {
-          cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                             "   produced s: " << sourceFile << std::endl,
-                             this->Quiet);
-          *cont->OFS << "  produced in source dir: " << sourceFile
-                     << std::endl;
-          actualSourceFile = cmSystemTools::CollapseFullPath(sourceFile);
-        } else if (IsFileInDir(sourceFile, cont->BinaryDir)) {
-          cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                             "   produced b: " << sourceFile << std::endl,
-                             this->Quiet);
-          *cont->OFS << "  produced in binary dir: " << sourceFile
-                     << std::endl;
-          actualSourceFile = cmSystemTools::CollapseFullPath(sourceFile);
+    // All files must have been produced by the same style of gcov output.
+    if (gcovStyle == 0) {
+      gcovStyle = result.Style;
+    }
+    if (result.Style != 0 && result.Style != gcovStyle) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Unknown gcov output style " << result.Style << std::endl);
+      cont->Error++;
+    } else {
+      // Merge the coverage of this file.  A line is used if it is used
+      // in either vector, and counts add up.
+      for (auto& cov : result.Coverage) {
+        cmCTestCoverageHandlerContainer::SingleFileCoverageVector& vec =
+          cont->TotalCoverage[cov.first];
+        if (vec.size() < cov.second.size()) {
+          vec.resize(cov.second.size(), -1);
         }
-
-        if (actualSourceFile.empty()) {
-          if (missingFiles.find(sourceFile) == missingFiles.end()) {
-            cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                               "Something went wrong" << std::endl,
-                               this->Quiet);
-            cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                               "Cannot find file: [" << sourceFile << "]"
-                                                     << std::endl,
-                               this->Quiet);
-            cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                               " in source dir: [" << cont->SourceDir << "]"
-                                                   << std::endl,
-                               this->Quiet);
-            cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                               " or binary dir: [" << cont->BinaryDir.size()
-                                                   << "]" << std::endl,
-                               this->Quiet);
-            *cont->OFS << "  Something went wrong. Cannot find file: "
-                       << sourceFile << " in source dir: " << cont->SourceDir
-                       << " or binary dir: " << cont->BinaryDir << std::endl;
-
-            missingFiles.insert(sourceFile);
+        for (size_t i = 0; i < cov.second.size(); ++i) {
+          if (cov.second[i] >= 0) {
+            vec[i] = std::max(vec[i], 0) + cov.second[i];
           }
         }
       }
@@ -1322,6 +1406,17 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
       cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT, "    ", this->Quiet);
     }
   }
+  auto mergeEnd = std::chrono::steady_clock::now();
+
+  cmCTestOptionalLog(
+    this->CTest, HANDLER_VERBOSE_OUTPUT,
+    std::endl
+      << "   GCov processed " << files.size() << " files with "
+      << threadCount << " jobs in "
+      << cmDuration(mergeStart - gcovStart).count()
+      << " s, merged in " << cmDuration(mergeEnd - mergeStart).count()
+      << " s" << std::endl,
+    this->Quiet);
 
   return file_count;
 }
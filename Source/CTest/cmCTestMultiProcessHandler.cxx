@@ -272,6 +272,13 @@ bool cmCTestMultiProcessHandler::AllocateResources(int index)
       allocatedResources[alloc.ProcessIndex][it.first].push_back(
         { alloc.Id, static_cast<unsigned int>(alloc.SlotsNeeded) });
     }
+    cmCTestLog(this->CTest, DEBUG,
+               "Resource " << it.first << " fragmentation after allocating "
+                           << this->GetName(index) << ": "
+                           << cmCTestResourceFragmentation(
+                                this->ResourceAllocator.GetResources().at(
+                                  it.first))
+                           << std::endl);
   }
 
   return true;
@@ -305,8 +312,8 @@ bool cmCTestMultiProcessHandler::TryAllocateResources(
       } else {
         return false;
       }
-    } else if (!cmAllocateCTestResourcesRoundRobin(
-                 availableResources.at(it.first), it.second)) {
+    } else if (!this->AllocateResourceType(
+                 it.first, availableResources.at(it.first), it.second)) {
       if (errors) {
         (*errors)[it.first] = ResourceAllocationError::InsufficientResources;
         result = false;
@@ -319,6 +326,23 @@ bool cmCTestMultiProcessHandler::TryAllocateResources(
   return result;
 }
 
+bool cmCTestMultiProcessHandler::AllocateResourceType(
+  const std::string& resourceType,
+  const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+  std::vector<cmCTestBinPackerAllocation>& allocations)
+{
+  // Skip the search for requirements at least as large as one that did
+  // not fit since slots of this type were last freed.
+  if (this->ResourceRejections.IsRejected(resourceType, allocations)) {
+    return false;
+  }
+  if (!cmAllocateCTestResourcesBestFit(resources, allocations)) {
+    this->ResourceRejections.Reject(resourceType, allocations);
+    return false;
+  }
+  return true;
+}
+
 void cmCTestMultiProcessHandler::DeallocateResources(int index)
 {
   if (!this->TestHandler->UseResourceSpec) {
@@ -336,6 +360,7 @@ void cmCTestMultiProcessHandler::DeallocateResources(int index)
           (void)success;
           assert(success);
         }
+        this->ResourceRejections.Clear(resourceType);
       }
     }
   }
@@ -454,6 +479,12 @@ bool cmCTestMultiProcessHandler::StartTest(int test)
     }
   }
 
+  // This test is not able to start because it is waiting
+  // on depends to run
+  if (!this->Tests[test].empty()) {
+    return false;
+  }
+
   // Allocate resources
   if (this->ResourceAllocationErrors[test].empty() &&
       !this->AllocateResources(test)) {
@@ -461,14 +492,7 @@ bool cmCTestMultiProcessHandler::StartTest(int test)
     return false;
   }
 
-  // if there are no depends left then run this test
-  if (this->Tests[test].empty()) {
-    return this->StartTestProcess(test);
-  }
-  // This test was not able to start because it is waiting
-  // on depends to run
-  this->DeallocateResources(test);
-  return false;
+  return this->StartTestProcess(test);
 }
 
 void cmCTestMultiProcessHandler::StartNextTests()
@@ -14,11 +14,11 @@
 #include <stddef.h>
 
 #include "cmCTest.h"
+#include "cmCTestBinPacker.h"
 #include "cmCTestResourceAllocator.h"
 #include "cmCTestTestHandler.h"
 #include "cmUVHandlePtr.h"
 
-struct cmCTestBinPackerAllocation;
 class cmCTestResourceSpec;
 class cmCTestRunTest;
 
@@ -95,6 +95,7 @@ public:
   void InitResourceAllocator(const cmCTestResourceSpec& spec)
   {
     this->ResourceAllocator.InitializeFromResourceSpec(spec);
+    this->ResourceRejections.Clear();
   }
 
   void CheckResourcesAvailable();
@@ -156,6 +157,10 @@ protected:
     std::map<std::string, std::vector<cmCTestBinPackerAllocation>>&
       allocations,
     std::map<std::string, ResourceAllocationError>* errors = nullptr);
+  bool AllocateResourceType(
+    const std::string& resourceType,
+    const std::map<std::string, cmCTestResourceAllocator::Resource>& resources,
+    std::vector<cmCTestBinPackerAllocation>& allocations);
   void DeallocateResources(int index);
   bool AllResourcesAvailable();
 
@@ -185,6 +190,7 @@ protected:
   std::map<int, std::map<std::string, ResourceAllocationError>>
     ResourceAllocationErrors;
   cmCTestResourceAllocator ResourceAllocator;
+  cmCTestResourceRejectionIndex ResourceRejections;
   std::vector<cmCTestTestHandler::cmCTestTestResult>* TestResults;
   size_t ParallelLevel; // max number of process that can be run at once
   unsigned long TestLoad;
@@ -6,6 +6,7 @@
 #include <chrono>
 #include <cmath>
 #include <cstddef> // IWYU pragma: keep
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -22,6 +23,9 @@
 #include <cmext/algorithm>
 #include <cmext/string_view>
 
+#include <cm3p/json/reader.h>
+#include <cm3p/json/value.h>
+
 #include "cmsys/FStream.hxx"
 #include <cmsys/Base64.h>
 #include <cmsys/Directory.hxx>
@@ -34,6 +38,7 @@
 #include "cmCTestResourceGroupsLexerHelper.h"
 #include "cmDuration.h"
 #include "cmExecutionStatus.h"
+#include "cmFileTime.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
@@ -42,6 +47,7 @@
 #include "cmStateSnapshot.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
+#include "cmVersion.h"
 #include "cmWorkingDirectory.h"
 #include "cmXMLWriter.h"
 #include "cmake.h"
@@ -558,6 +564,27 @@ bool cmCTestTestHandler::ProcessOptions()
   }
   this->SetRerunFailed(cmIsOn(this->GetOption("RerunFailed")));
 
+  this->UseTestListCache = cmIsOn(this->GetOption("TestListCache"));
+  val = this->GetOption("AffectedByFile");
+  this->AffectedByFile = val ? val : "";
+
+  this->ShardCount = 0;
+  this->ShardIndex = 0;
+  const char* shardCount = this->GetOption("ShardCount");
+  const char* shardIndex = this->GetOption("ShardIndex");
+  if (shardCount || shardIndex) {
+    if (!shardCount || !shardIndex ||
+        !cmStrToULong(shardCount, &this->ShardCount) ||
+        !cmStrToULong(shardIndex, &this->ShardIndex) ||
+        this->ShardCount < 1 || this->ShardIndex >= this->ShardCount) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Shard options invalid: both a shard count and a shard "
+                 "index less than the count must be given."
+                   << std::endl);
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -828,8 +855,7 @@ bool cmCTestTestHandler::ComputeTestList()
   }
 
   if (this->RerunFailed) {
-    this->ComputeTestListForRerunFailed();
-    return true;
+    return this->ComputeTestListForRerunFailed();
   }
 
   cmCTestTestHandler::ListOfTests::size_type tmsize = this->TestList.size();
@@ -877,7 +903,12 @@ bool cmCTestTestHandler::ComputeTestList()
     finalList.push_back(tp);
   }
 
+  if (!this->AffectedByFile.empty() && !this->SelectAffectedTests(finalList)) {
+    return false;
+  }
+
   this->UpdateForFixtures(finalList);
+  this->SelectShard(finalList);
 
   // Save the total number of tests before exclusions
   this->TotalNumberOfTests = this->TestList.size();
@@ -888,7 +919,7 @@ bool cmCTestTestHandler::ComputeTestList()
   return true;
 }
 
-void cmCTestTestHandler::ComputeTestListForRerunFailed()
+bool cmCTestTestHandler::ComputeTestListForRerunFailed()
 {
   this->ExpandTestsToRunInformationForRerunFailed();
 
@@ -906,7 +937,12 @@ void cmCTestTestHandler::ComputeTestListForRerunFailed()
     finalList.push_back(tp);
   }
 
+  if (!this->AffectedByFile.empty() && !this->SelectAffectedTests(finalList)) {
+    return false;
+  }
+
   this->UpdateForFixtures(finalList);
+  this->SelectShard(finalList);
 
   // Save the total number of tests before exclusions
   this->TotalNumberOfTests = this->TestList.size();
@@ -915,6 +951,7 @@ void cmCTestTestHandler::ComputeTestListForRerunFailed()
   this->TestList = finalList;
 
   this->UpdateMaxTestNameWidth();
+  return true;
 }
 
 void cmCTestTestHandler::UpdateForFixtures(ListOfTests& tests) const
@@ -1149,6 +1186,303 @@ void cmCTestTestHandler::UpdateForFixtures(ListOfTests& tests) const
                      this->Quiet);
 }
 
+bool cmCTestTestHandler::SelectAffectedTests(ListOfTests& tests) const
+{
+  cmsys::ifstream changedIn(this->AffectedByFile.c_str());
+  if (!changedIn) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "Could not read list of changed files "
+                 << this->AffectedByFile << std::endl);
+    return false;
+  }
+  std::vector<std::string> changedFiles;
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(changedIn, line)) {
+    line = cmTrimWhitespace(line);
+    if (!line.empty()) {
+      changedFiles.push_back(line);
+    }
+  }
+
+  // The target graph is written to the top of the build tree, which may
+  // be above the directory in which we were asked to run tests.
+  std::string graphFile;
+  std::string dir = cmSystemTools::GetCurrentWorkingDirectory();
+  for (;;) {
+    std::string candidate = dir + "/CMakeFiles/CTestTargetGraph.json";
+    if (cmSystemTools::FileExists(candidate, true)) {
+      graphFile = candidate;
+      break;
+    }
+    std::string parent = cmSystemTools::GetParentDirectory(dir);
+    if (parent.empty() || parent == dir) {
+      break;
+    }
+    dir = parent;
+  }
+  Json::Value root;
+  cmsys::ifstream graphIn(graphFile.c_str());
+  Json::CharReaderBuilder builder;
+  if (graphFile.empty() || !graphIn ||
+      !Json::parseFromStream(builder, graphIn, &root, nullptr) ||
+      !root.isObject()) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "Could not read the target graph needed by --affected-by.  "
+               "Re-run CMake with testing enabled and "
+               "CMAKE_CTEST_TARGET_GRAPH set to true to generate "
+               "CMakeFiles/CTestTargetGraph.json."
+                 << std::endl);
+    return false;
+  }
+
+  // Relative changed paths, such as those printed by version control
+  // tools, are interpreted relative to the top of the source tree.
+  std::string const sourceDir = root["sourceDir"].asString();
+  std::set<std::string> changed;
+  for (std::string const& f : changedFiles) {
+    changed.insert(cmSystemTools::CollapseFullPath(f, sourceDir));
+  }
+
+  // Find the targets built from changed sources, then everything that
+  // depends on them.
+  Json::Value const& targets = root["targets"];
+  std::map<std::string, std::vector<std::string>> dependents;
+  std::map<std::string, std::string> affectedTargets;
+  std::vector<std::string> queue;
+  std::set<std::string> knownFiles;
+  for (Json::Value const& target : targets) {
+    std::string const name = target["name"].asString();
+    for (Json::Value const& dep : target["dependencies"]) {
+      dependents[dep.asString()].push_back(name);
+    }
+    for (Json::Value const& source : target["sources"]) {
+      std::string const path = source.asString();
+      if (cm::contains(changed, path)) {
+        knownFiles.insert(path);
+        if (affectedTargets.emplace(name, path).second) {
+          queue.push_back(name);
+        }
+      }
+    }
+  }
+  while (!queue.empty()) {
+    std::string const name = queue.back();
+    queue.pop_back();
+    std::string const reason = affectedTargets[name];
+    for (std::string const& dependent : dependents[name]) {
+      if (affectedTargets.emplace(dependent, reason).second) {
+        queue.push_back(dependent);
+      }
+    }
+  }
+
+  std::map<std::string, std::string> affectedFiles;
+  for (std::string const& f : changed) {
+    affectedFiles[f] = f;
+  }
+  for (Json::Value const& target : targets) {
+    auto it = affectedTargets.find(target["name"].asString());
+    if (it == affectedTargets.end()) {
+      continue;
+    }
+    for (Json::Value const& artifact : target["artifacts"]) {
+      affectedFiles.emplace(artifact.asString(), it->second);
+    }
+  }
+
+  // Keep tests whose command or required files are affected.
+  ListOfTests affectedList;
+  for (cmCTestTestProperties& p : tests) {
+    std::vector<std::string> files(p.Args.begin() + 1, p.Args.end());
+    files.insert(files.end(), p.RequiredFiles.begin(),
+                 p.RequiredFiles.end());
+    std::string reason;
+    for (std::string const& f : files) {
+      std::string const path = cmSystemTools::CollapseFullPath(f, p.Directory);
+      auto it = affectedFiles.find(path);
+      if (it != affectedFiles.end()) {
+        knownFiles.insert(it->second);
+        reason = it->second;
+        break;
+      }
+    }
+    if (reason.empty()) {
+      cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT,
+                         "Skipping test " << p.Name
+                                          << ": not affected by any "
+                                             "changed file"
+                                          << std::endl,
+                         this->Quiet);
+      continue;
+    }
+    cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                       "Test " << p.Name << " is affected by " << reason
+                               << std::endl,
+                       this->Quiet);
+    affectedList.push_back(p);
+  }
+
+  for (std::string const& f : changed) {
+    if (!cm::contains(knownFiles, f)) {
+      cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                         "Changed file " << f
+                                         << " is not a source of any target "
+                                            "or used by any test"
+                                         << std::endl,
+                         this->Quiet);
+    }
+  }
+
+  tests = std::move(affectedList);
+  return true;
+}
+
+void cmCTestTestHandler::SelectShard(ListOfTests& tests) const
+{
+  if (this->ShardCount < 1 || tests.empty()) {
+    return;
+  }
+
+  // Use the average costs recorded by previous runs, if any.  The
+  // partition is only consistent across jobs that see the same data.
+  std::map<std::string, float> recordedCosts;
+  std::string fname = this->CTest->GetCostDataFile();
+  if (cmSystemTools::FileExists(fname, true)) {
+    cmsys::ifstream fin(fname.c_str());
+    std::string line;
+    while (std::getline(fin, line)) {
+      if (line == "---") {
+        break;
+      }
+      // Format: <name> <previous_runs> <avg_cost>
+      std::vector<std::string> parts = cmSystemTools::SplitString(line, ' ');
+      if (parts.size() < 3) {
+        break;
+      }
+      recordedCosts[parts[0]] = static_cast<float>(atof(parts[2].c_str()));
+    }
+  }
+
+  // Estimate each test's cost.  The COST property takes precedence over
+  // recorded data, and tests without either get the average known cost.
+  std::vector<double> costs(tests.size(), 0.0);
+  double knownTotal = 0;
+  size_t knownCount = 0;
+  for (size_t i = 0; i < tests.size(); ++i) {
+    cmCTestTestProperties const& p = tests[i];
+    if (p.Cost > 0) {
+      costs[i] = p.Cost;
+    } else {
+      auto it = recordedCosts.find(p.Name);
+      if (it != recordedCosts.end() && it->second > 0) {
+        costs[i] = it->second;
+      }
+    }
+    if (costs[i] > 0) {
+      knownTotal += costs[i];
+      ++knownCount;
+    }
+  }
+  double const defaultCost = knownCount ? knownTotal / knownCount : 1.0;
+  for (double& cost : costs) {
+    if (cost <= 0) {
+      cost = defaultCost;
+    }
+  }
+
+  // Group tests connected through DEPENDS.  Fixture requirements have
+  // already been turned into dependencies by UpdateForFixtures.
+  std::map<std::string, size_t> indexByName;
+  for (size_t i = 0; i < tests.size(); ++i) {
+    indexByName[tests[i].Name] = i;
+  }
+  std::vector<size_t> parent(tests.size());
+  for (size_t i = 0; i < parent.size(); ++i) {
+    parent[i] = i;
+  }
+  auto findRoot = [&parent](size_t i) -> size_t {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+  for (size_t i = 0; i < tests.size(); ++i) {
+    for (std::string const& dep : tests[i].Depends) {
+      auto it = indexByName.find(dep);
+      if (it == indexByName.end()) {
+        continue;
+      }
+      size_t a = findRoot(i);
+      size_t b = findRoot(it->second);
+      if (a != b) {
+        // Keep the earliest test as the root so the result is stable.
+        parent[std::max(a, b)] = std::min(a, b);
+      }
+    }
+  }
+
+  struct TestGroup
+  {
+    size_t Root;
+    int FirstIndex;
+    double Cost;
+  };
+  std::map<size_t, TestGroup> groupByRoot;
+  for (size_t i = 0; i < tests.size(); ++i) {
+    size_t root = findRoot(i);
+    auto it = groupByRoot.find(root);
+    if (it == groupByRoot.end()) {
+      groupByRoot[root] = TestGroup{ root, tests[i].Index, costs[i] };
+    } else {
+      it->second.FirstIndex = std::min(it->second.FirstIndex, tests[i].Index);
+      it->second.Cost += costs[i];
+    }
+  }
+  std::vector<TestGroup> groups;
+  groups.reserve(groupByRoot.size());
+  for (auto const& g : groupByRoot) {
+    groups.push_back(g.second);
+  }
+
+  // Assign the most expensive groups first, each to the least loaded
+  // shard.  Ties are broken by test number so every job computes the
+  // same partition.
+  std::sort(groups.begin(), groups.end(),
+            [](TestGroup const& l, TestGroup const& r) {
+              if (l.Cost != r.Cost) {
+                return l.Cost > r.Cost;
+              }
+              return l.FirstIndex < r.FirstIndex;
+            });
+  std::vector<double> load(this->ShardCount, 0.0);
+  std::set<size_t> selectedRoots;
+  for (TestGroup const& g : groups) {
+    auto shard = std::min_element(load.begin(), load.end()) - load.begin();
+    load[shard] += g.Cost;
+    if (static_cast<unsigned long>(shard) == this->ShardIndex) {
+      selectedRoots.insert(g.Root);
+    }
+  }
+
+  ListOfTests shardList;
+  for (size_t i = 0; i < tests.size(); ++i) {
+    if (cm::contains(selectedRoots, findRoot(i))) {
+      shardList.push_back(tests[i]);
+    }
+  }
+
+  cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                     "Shard " << this->ShardIndex << " of "
+                              << this->ShardCount << ": selected "
+                              << shardList.size() << " of " << tests.size()
+                              << " tests with estimated cost "
+                              << load[this->ShardIndex] << std::endl,
+                     this->Quiet);
+
+  tests = std::move(shardList);
+}
+
 void cmCTestTestHandler::UpdateMaxTestNameWidth()
 {
   std::string::size_type max = this->CTest->GetMaxTestNameWidth();
@@ -1720,6 +2054,13 @@ bool cmCTestTestHandler::GetListOfTests()
   }
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Constructing a list of tests" << std::endl, this->Quiet);
+  if (this->UseTestListCache && this->ReadTestListCache()) {
+    cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                       "Done constructing a list of tests from "
+                         << this->GetTestListCacheFile() << std::endl,
+                       this->Quiet);
+    return true;
+  }
   cmake cm(cmake::RoleScript, cmState::CTest);
   cm.SetHomeDirectory("");
   cm.SetHomeOutputDirectory("");
@@ -1758,7 +2099,11 @@ bool cmCTestTestHandler::GetListOfTests()
     return true;
   }
 
-  if (!mf.ReadListFile(testFilename)) {
+  this->TestFileCommands.clear();
+  this->RecordTestFileCommands = this->UseTestListCache;
+  bool const readit = mf.ReadListFile(testFilename);
+  this->RecordTestFileCommands = false;
+  if (!readit) {
     return false;
   }
   if (cmSystemTools::GetErrorOccuredFlag()) {
@@ -1769,12 +2114,260 @@ bool cmCTestTestHandler::GetListOfTests()
   if (this->ResourceSpecFile.empty() && specFile) {
     this->ResourceSpecFile = *specFile;
   }
+  if (this->UseTestListCache) {
+    this->WriteTestListCache(mf, specFile);
+  }
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Done constructing a list of tests" << std::endl,
                      this->Quiet);
   return true;
 }
 
+void cmCTestTestHandler::RecordTestFileCommand(
+  TestFileCommand::CommandKind kind, std::vector<std::string> const& args)
+{
+  if (this->RecordTestFileCommands) {
+    this->TestFileCommands.push_back(
+      { kind, cmSystemTools::GetCurrentWorkingDirectory(), args });
+  }
+}
+
+std::string cmCTestTestHandler::GetTestListCacheFile() const
+{
+  return this->CTest->GetBinaryDir() +
+    "/Testing/Temporary/CTestTestListCache.bin";
+}
+
+namespace {
+// Identifies the format of the test list cache file.
+const char* const TestListCacheMagic = "CTestTestListCache 1";
+
+void WriteCacheInteger(std::ostream& os, std::uint64_t value)
+{
+  os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WriteCacheString(std::ostream& os, std::string const& value)
+{
+  WriteCacheInteger(os, value.size());
+  os.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+bool ReadCacheInteger(std::istream& is, std::uint64_t& value)
+{
+  return static_cast<bool>(
+    is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool ReadCacheString(std::istream& is, std::string& value)
+{
+  std::uint64_t size;
+  if (!ReadCacheInteger(is, size) || size > (std::uint64_t(1) << 32)) {
+    return false;
+  }
+  value.resize(static_cast<std::string::size_type>(size));
+  return static_cast<bool>(
+    is.read(&value[0], static_cast<std::streamsize>(size)));
+}
+
+// Only test files whose meaning cannot change without the file itself
+// changing may be cached.  This admits the files CMake generates for
+// add_test() and set_tests_properties(), whose only conditions test the
+// configuration, but not arbitrary code such as included files guarded
+// by if(EXISTS).
+bool IsCacheableArgument(cmListFileArgument const& arg)
+{
+  return arg.Value.find("$ENV{") == std::string::npos &&
+    arg.Value.find("$CACHE{") == std::string::npos;
+}
+
+bool IsCacheableTestFile(std::string const& path, cmMakefile& mf)
+{
+  cmListFile listFile;
+  if (!listFile.ParseFile(path.c_str(), mf.GetMessenger(),
+                          mf.GetBacktrace())) {
+    return false;
+  }
+  for (cmListFileFunction const& func : listFile.Functions) {
+    std::string const& name = func.LowerCaseName();
+    if (name == "if" || name == "elseif") {
+      for (cmListFileArgument const& arg : func.Arguments()) {
+        if (arg.Delim == cmListFileArgument::Unquoted) {
+          if (arg.Value != "MATCHES" && arg.Value != "STREQUAL" &&
+              arg.Value != "AND" && arg.Value != "OR" &&
+              arg.Value != "NOT" && arg.Value != "(" && arg.Value != ")") {
+            return false;
+          }
+        } else if (!IsCacheableArgument(arg) ||
+                   (arg.Value.find("${") != std::string::npos &&
+                    arg.Value != "${CTEST_CONFIGURATION_TYPE}")) {
+          return false;
+        }
+      }
+    } else if (name == "add_test" || name == "set_tests_properties" ||
+               name == "set_directory_properties" || name == "subdirs" ||
+               name == "add_subdirectory") {
+      for (cmListFileArgument const& arg : func.Arguments()) {
+        if (!IsCacheableArgument(arg)) {
+          return false;
+        }
+      }
+    } else if (name != "else" && name != "endif") {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+bool cmCTestTestHandler::ReadTestListCache()
+{
+  cmsys::ifstream fin(this->GetTestListCacheFile().c_str(),
+                      std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+
+  // The cache must have been written by this version of CTest for the
+  // same directory and configuration.
+  std::string value;
+  if (!ReadCacheString(fin, value) || value != TestListCacheMagic ||
+      !ReadCacheString(fin, value) ||
+      value != cmVersion::GetCMakeVersion() ||
+      !ReadCacheString(fin, value) ||
+      value != cmSystemTools::GetCurrentWorkingDirectory() ||
+      !ReadCacheString(fin, value) ||
+      value != this->CTest->GetConfigType()) {
+    return false;
+  }
+
+  // None of the test files may have changed.
+  std::uint64_t count;
+  if (!ReadCacheInteger(fin, count)) {
+    return false;
+  }
+  for (std::uint64_t i = 0; i < count; ++i) {
+    std::uint64_t mtime;
+    std::uint64_t size;
+    cmFileTime ftm;
+    if (!ReadCacheString(fin, value) || !ReadCacheInteger(fin, mtime) ||
+        !ReadCacheInteger(fin, size) || !ftm.Load(value) ||
+        static_cast<std::uint64_t>(ftm.GetTime()) != mtime ||
+        cmSystemTools::FileLength(value) != size) {
+      return false;
+    }
+  }
+
+  std::uint64_t hasSpecFile;
+  std::string specFile;
+  if (!ReadCacheInteger(fin, hasSpecFile) ||
+      !ReadCacheString(fin, specFile)) {
+    return false;
+  }
+
+  std::vector<TestFileCommand> commands;
+  if (!ReadCacheInteger(fin, count)) {
+    return false;
+  }
+  commands.resize(static_cast<size_t>(count));
+  for (TestFileCommand& command : commands) {
+    std::uint64_t kind;
+    std::uint64_t argc;
+    if (!ReadCacheInteger(fin, kind) ||
+        kind > TestFileCommand::SetDirectoryProperties ||
+        !ReadCacheString(fin, command.Directory) ||
+        !ReadCacheInteger(fin, argc)) {
+      return false;
+    }
+    command.Kind = static_cast<TestFileCommand::CommandKind>(kind);
+    command.Args.resize(static_cast<size_t>(argc));
+    for (std::string& arg : command.Args) {
+      if (!ReadCacheString(fin, arg)) {
+        return false;
+      }
+    }
+  }
+
+  // Replay the commands as if the test files had been read.
+  std::unique_ptr<cmWorkingDirectory> workdir;
+  for (TestFileCommand const& command : commands) {
+    if (!workdir ||
+        command.Directory != cmSystemTools::GetCurrentWorkingDirectory()) {
+      workdir.reset();
+      workdir = cm::make_unique<cmWorkingDirectory>(command.Directory);
+      if (workdir->Failed()) {
+        this->TestList.clear();
+        return false;
+      }
+    }
+    switch (command.Kind) {
+      case TestFileCommand::AddTest:
+        this->AddTest(command.Args);
+        break;
+      case TestFileCommand::SetTestsProperties:
+        this->SetTestsProperties(command.Args);
+        break;
+      case TestFileCommand::SetDirectoryProperties:
+        this->SetDirectoryProperties(command.Args);
+        break;
+    }
+  }
+
+  if (this->ResourceSpecFile.empty() && hasSpecFile) {
+    this->ResourceSpecFile = specFile;
+  }
+  return true;
+}
+
+void cmCTestTestHandler::WriteTestListCache(cmMakefile& mf,
+                                            cmProp resourceSpecFile)
+{
+  std::string const fname = this->GetTestListCacheFile();
+  std::vector<std::string> const& listFiles = mf.GetListFiles();
+  for (std::string const& f : listFiles) {
+    if (!IsCacheableTestFile(f, mf)) {
+      cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                         "Not caching the list of tests because "
+                           << f << " contains unsupported commands"
+                           << std::endl,
+                         this->Quiet);
+      cmSystemTools::RemoveFile(fname);
+      return;
+    }
+  }
+
+  cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(fname));
+  cmGeneratedFileStream fout;
+  fout.Open(fname, false, true);
+  WriteCacheString(fout, TestListCacheMagic);
+  WriteCacheString(fout, cmVersion::GetCMakeVersion());
+  WriteCacheString(fout, cmSystemTools::GetCurrentWorkingDirectory());
+  WriteCacheString(fout, this->CTest->GetConfigType());
+
+  WriteCacheInteger(fout, listFiles.size());
+  for (std::string const& f : listFiles) {
+    cmFileTime ftm;
+    ftm.Load(f);
+    WriteCacheString(fout, f);
+    WriteCacheInteger(fout, static_cast<std::uint64_t>(ftm.GetTime()));
+    WriteCacheInteger(fout, cmSystemTools::FileLength(f));
+  }
+
+  WriteCacheInteger(fout, resourceSpecFile ? 1 : 0);
+  WriteCacheString(fout, resourceSpecFile ? *resourceSpecFile : "");
+
+  WriteCacheInteger(fout, this->TestFileCommands.size());
+  for (TestFileCommand const& command : this->TestFileCommands) {
+    WriteCacheInteger(fout, command.Kind);
+    WriteCacheString(fout, command.Directory);
+    WriteCacheInteger(fout, command.Args.size());
+    for (std::string const& arg : command.Args) {
+      WriteCacheString(fout, arg);
+    }
+  }
+  this->TestFileCommands.clear();
+}
+
 void cmCTestTestHandler::UseIncludeRegExp()
 {
   this->UseIncludeRegExpFlag = true;
@@ -2159,6 +2752,7 @@ void cmCTestTestHandler::CleanTestOutput(std::string& output, size_t length)
 bool cmCTestTestHandler::SetTestsProperties(
   const std::vector<std::string>& args)
 {
+  this->RecordTestFileCommand(TestFileCommand::SetTestsProperties, args);
   std::vector<std::string>::const_iterator it;
   std::vector<std::string> tests;
   bool found = false;
@@ -2318,6 +2912,7 @@ bool cmCTestTestHandler::SetTestsProperties(
 bool cmCTestTestHandler::SetDirectoryProperties(
   const std::vector<std::string>& args)
 {
+  this->RecordTestFileCommand(TestFileCommand::SetDirectoryProperties, args);
   std::vector<std::string>::const_iterator it;
   std::vector<std::string> tests;
   bool found = false;
@@ -2362,6 +2957,7 @@ bool cmCTestTestHandler::SetDirectoryProperties(
 
 bool cmCTestTestHandler::AddTest(const std::vector<std::string>& args)
 {
+  this->RecordTestFileCommand(TestFileCommand::AddTest, args);
   const std::string& testname = args[0];
   cmCTestOptionalLog(this->CTest, DEBUG, "Add test: " << args[0] << std::endl,
                      this->Quiet);
@@ -22,6 +22,7 @@
 #include "cmCTestResourceSpec.h"
 #include "cmDuration.h"
 #include "cmListFileCache.h"
+#include "cmProperty.h"
 
 class cmMakefile;
 class cmXMLWriter;
@@ -286,19 +287,49 @@ private:
    * Get the list of tests in directory and subdirectories.
    */
   bool GetListOfTests();
+
+  // A test file command recorded while reading the test files.
+  struct TestFileCommand
+  {
+    enum CommandKind
+    {
+      AddTest,
+      SetTestsProperties,
+      SetDirectoryProperties
+    };
+    CommandKind Kind;
+    std::string Directory;
+    std::vector<std::string> Args;
+  };
+  void RecordTestFileCommand(TestFileCommand::CommandKind kind,
+                             std::vector<std::string> const& args);
+
+  // replay the test file commands saved by a previous run if none of
+  // the test files they were read from have changed
+  bool ReadTestListCache();
+  void WriteTestListCache(cmMakefile& mf, cmProp resourceSpecFile);
+  std::string GetTestListCacheFile() const;
   // compute the lists of tests that will actually run
   // based on union regex and -I stuff
   bool ComputeTestList();
 
   // compute the lists of tests that will actually run
   // based on LastTestFailed.log
-  void ComputeTestListForRerunFailed();
+  bool ComputeTestListForRerunFailed();
 
   // add required setup/cleanup tests not already in the
   // list of tests to be run and update dependencies between
   // tests to account for fixture setup/cleanup
   void UpdateForFixtures(ListOfTests& tests) const;
 
+  // keep only the tests affected by the files listed in AffectedByFile,
+  // using the target graph recorded at generate time
+  bool SelectAffectedTests(ListOfTests& tests) const;
+
+  // keep only the tests assigned to the selected shard, keeping tests
+  // connected through dependencies or fixtures in the same shard
+  void SelectShard(ListOfTests& tests) const;
+
   void UpdateMaxTestNameWidth();
 
   bool GetValue(const char* tag, std::string& value, std::istream& fin);
@@ -358,4 +389,10 @@ private:
   cmCTest::Repeat RepeatMode = cmCTest::Repeat::Never;
   int RepeatCount = 1;
   bool RerunFailed;
+  std::string AffectedByFile;
+  bool UseTestListCache = false;
+  bool RecordTestFileCommands = false;
+  std::vector<TestFileCommand> TestFileCommands;
+  unsigned long ShardCount = 0;
+  unsigned long ShardIndex = 0;
 };
@@ -0,0 +1,109 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmArchiveIndex.h"
+
+#include <cstdlib>
+#include <utility>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmFileTime.h"
+#include "cmGeneratedFileStream.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+namespace {
+char const* const cmArchiveIndexMagic = "cmake-archive-index 2";
+}
+
+bool cmArchiveIndex::Describe(std::string const& archive)
+{
+  cmFileTime mtime;
+  if (!mtime.Load(archive)) {
+    return false;
+  }
+  this->ArchiveSize = cmSystemTools::FileLength(archive);
+  this->ArchiveMTime = mtime.GetTime();
+  return true;
+}
+
+bool cmArchiveIndex::Save(std::string const& file) const
+{
+  for (Entry const& e : this->Entries) {
+    if (e.Path.find('\n') != std::string::npos) {
+      cmSystemTools::Error(cmStrCat("Cannot index archive member \"", e.Path,
+                                    "\" with a newline in its name."));
+      return false;
+    }
+  }
+
+  cmGeneratedFileStream fout(file);
+  fout.SetCopyIfDifferent(true);
+  fout << cmArchiveIndexMagic << '\n'
+       << "archive " << this->ArchiveSize << ' ' << this->ArchiveMTime << ' '
+       << (this->Seekable ? 1 : 0) << '\n';
+  for (Entry const& e : this->Entries) {
+    fout << e.Type << ' ' << e.Offset << ' ' << e.Size << ' ' << e.Path
+         << '\n';
+  }
+  if (!fout.Close()) {
+    cmSystemTools::Error(cmStrCat("Cannot write archive index \"", file,
+                                  "\": ",
+                                  cmSystemTools::GetLastSystemError()));
+    return false;
+  }
+  return true;
+}
+
+bool cmArchiveIndex::Load(std::string const& file, std::string const& archive)
+{
+  this->Entries.clear();
+  cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+  std::string line;
+  if (!fin || !std::getline(fin, line) || line != cmArchiveIndexMagic ||
+      !std::getline(fin, line) || !cmHasLiteralPrefix(line, "archive ")) {
+    return false;
+  }
+
+  char* end = nullptr;
+  char const* p = line.c_str() + 8;
+  this->ArchiveSize = std::strtoull(p, &end, 10);
+  if (end == p || *end != ' ') {
+    return false;
+  }
+  p = end + 1;
+  this->ArchiveMTime = std::strtoll(p, &end, 10);
+  if (end == p || (end[0] != ' ') || (end[1] != '0' && end[1] != '1') ||
+      end[2] != '\0') {
+    return false;
+  }
+  this->Seekable = end[1] == '1';
+  // An index written for another archive with the same name, or for an
+  // archive written again since, is stale.
+  cmArchiveIndex actual;
+  if (!actual.Describe(archive) || actual.ArchiveSize != this->ArchiveSize ||
+      actual.ArchiveMTime != this->ArchiveMTime) {
+    return false;
+  }
+
+  while (std::getline(fin, line)) {
+    Entry e;
+    if (line.size() < 2 || line[1] != ' ') {
+      return false;
+    }
+    e.Type = line[0];
+    p = line.c_str() + 2;
+    e.Offset = std::strtoll(p, &end, 10);
+    if (end == p || *end != ' ') {
+      return false;
+    }
+    p = end + 1;
+    e.Size = std::strtoll(p, &end, 10);
+    if (end == p || *end != ' ') {
+      return false;
+    }
+    e.Path = line.substr(static_cast<size_t>(end + 1 - line.c_str()));
+    this->Entries.emplace_back(std::move(e));
+  }
+  return fin.eof();
+}
@@ -0,0 +1,48 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <vector>
+
+/** \class cmArchiveIndex
+ * \brief List of the members of an archive, kept in a file beside it.
+ *
+ * An index lets the members of an archive be listed without reading the
+ * archive.  For an uncompressed tar archive it also records where the
+ * header of each member starts, so a single member can be read without
+ * reading the members before it.
+ */
+class cmArchiveIndex
+{
+public:
+  struct Entry
+  {
+    // 'f' for a regular file, 'd' for a directory, 'l' for a symbolic
+    // link and 'o' for anything else.
+    char Type = 'f';
+    // Offset of the member header in the archive, or -1 if unknown.
+    long long Offset = -1;
+    long long Size = 0;
+    std::string Path;
+  };
+
+  // Size and modification time of the archive file the index describes.
+  unsigned long long ArchiveSize = 0;
+  long long ArchiveMTime = 0;
+  // Whether the Offset of each entry is a position in the archive file.
+  bool Seekable = false;
+  std::vector<Entry> Entries;
+
+  //! Record the size and modification time of the archive file.
+  bool Describe(std::string const& archive);
+
+  //! Write the index to a file.  Returns false on error.
+  bool Save(std::string const& file) const;
+
+  /** Read an index from a file.  Returns false if the file cannot be
+      read or does not describe the given archive.  */
+  bool Load(std::string const& file, std::string const& archive);
+};
@@ -41,6 +41,15 @@ static void cm_archive_entry_copy_pathname(struct archive_entry* e,
 #endif
 }
 
+static std::string cm_archive_entry_pathname(struct archive_entry* e)
+{
+#if cmsys_STL_HAS_WSTRING
+  return cmsys::Encoding::ToNarrow(archive_entry_pathname_w(e));
+#else
+  return archive_entry_pathname(e);
+#endif
+}
+
 static void cm_archive_entry_copy_sourcepath(struct archive_entry* e,
                                              const std::string& file)
 {
@@ -163,6 +172,20 @@ cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c,
                                cm_archive_error_string(this->Archive));
         return;
       }
+#if !defined(CMAKE_USE_SYSTEM_LIBARCHIVE) || ARCHIVE_VERSION_NUMBER >= 3006000
+      // The zstd "threads" option is available in our bundled libarchive
+      // and upstream since 3.6.0.
+      if (numThreads != 1) {
+        std::string sNumThreads = std::to_string(numThreads);
+        if (archive_write_set_filter_option(this->Archive, "zstd", "threads",
+                                            sNumThreads.c_str()) !=
+            ARCHIVE_OK) {
+          this->Error = cmStrCat("archive_compressor_zstd_options: ",
+                                 cm_archive_error_string(this->Archive));
+          return;
+        }
+      }
+#endif
       break;
   }
 
@@ -373,18 +396,52 @@ bool cmArchiveWrite::AddFile(const char* file, size_t skip, const char* prefix)
     archive_entry_sparse_clear(e);
   }
 
+  // The padding of the previous member of a tar archive is only written
+  // with the next header, which starts at a multiple of 512 bytes.
+  long long offset = -1;
+  if (this->EntryAdded &&
+      (this->Format == "gnutar" || this->Format == "pax" ||
+       this->Format == "paxr")) {
+    offset = static_cast<long long>(archive_filter_bytes(this->Archive, 0));
+    offset = (offset + 511) / 512 * 512;
+  }
+
   if (archive_write_header(this->Archive, e) != ARCHIVE_OK) {
     this->Error = cmStrCat("archive_write_header: ",
                            cm_archive_error_string(this->Archive));
     return false;
   }
 
+  if (this->EntryAdded) {
+    char type = 'o';
+    switch (archive_entry_filetype(e)) {
+      case AE_IFREG:
+        type = 'f';
+        break;
+      case AE_IFDIR:
+        type = 'd';
+        break;
+      case AE_IFLNK:
+        type = 'l';
+        break;
+      default:
+        break;
+    }
+    // Record the name as written, which for a directory in a tar archive
+    // ends in a slash.
+    this->EntryAdded(cm_archive_entry_pathname(e), type,
+                     static_cast<long long>(archive_entry_size(e)), offset);
+  }
+
   // do not copy content of symlink
   if (!archive_entry_symlink(e)) {
     // Content.
     if (size_t size = static_cast<size_t>(archive_entry_size(e))) {
       return this->AddData(file, size);
     }
+    if (this->FileContent && archive_entry_filetype(e) == AE_IFREG) {
+      this->FileContent(file, nullptr, 0);
+    }
   }
   return true;
 }
@@ -416,6 +473,9 @@ bool cmArchiveWrite::AddData(const char* file, size_t size)
                              cm_archive_error_string(this->Archive));
       return false;
     }
+    if (this->FileContent) {
+      this->FileContent(file, buffer, nnext);
+    }
     nleft -= nnext;
   }
   if (nleft > 0) {
@@ -423,6 +483,9 @@ bool cmArchiveWrite::AddData(const char* file, size_t size)
                            "\": ", cmSystemTools::GetLastSystemError());
     return false;
   }
+  if (this->FileContent) {
+    this->FileContent(file, nullptr, 0);
+  }
   return true;
 }
 
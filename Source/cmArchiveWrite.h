@@ -5,8 +5,10 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <cstddef>
+#include <functional>
 #include <iosfwd>
 #include <string>
+#include <utility>
 
 #if defined(CMAKE_BOOTSTRAP)
 #  error "cmArchiveWrite not allowed during bootstrap build!"
@@ -144,6 +146,33 @@ public:
   //! Set an option on a filter;
   bool SetFilterOption(const char* module, const char* key, const char* value);
 
+  /**
+   * Callback receiving the content of each regular file added to the
+   * archive, in blocks, as it is read from disk.  After the last block
+   * of a file it is called once more with a null data pointer.
+   */
+  using FileContentCallback = std::function<void(
+    std::string const& file, const char* data, size_t size)>;
+
+  //! Sets the callback receiving the content of added files
+  void SetFileContentCallback(FileContentCallback cb)
+  {
+    this->FileContent = std::move(cb);
+  }
+
+  /**
+   * Callback receiving each entry added to the archive: its name in the
+   * archive, its type, its size and the offset of its header in the
+   * uncompressed archive stream.  The offset is -1 for formats that are
+   * not a sequence of tar headers.
+   */
+  using EntryCallback =
+    std::function<void(std::string const& path, char type, long long size,
+                       long long offset)>;
+
+  //! Sets the callback receiving the added entries
+  void SetEntryCallback(EntryCallback cb) { this->EntryAdded = std::move(cb); }
+
 private:
   bool Okay() const { return this->Error.empty(); }
   bool AddPath(const char* path, size_t skip, const char* prefix,
@@ -163,6 +192,8 @@ private:
   std::string Format;
   std::string Error;
   std::string MTime;
+  FileContentCallback FileContent;
+  EntryCallback EntryAdded;
 
   //! UID of the user in the tar file
   cmArchiveWriteOptional<int> Uid;
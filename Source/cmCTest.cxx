@@ -2166,6 +2166,58 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
     this->GetTestHandler()->SetPersistentOption("RerunFailed", "true");
     this->GetMemCheckHandler()->SetPersistentOption("RerunFailed", "true");
   }
+
+  else if (this->CheckArgument(arg, "--test-list-cache"_s)) {
+    this->GetTestHandler()->SetPersistentOption("TestListCache", "true");
+    this->GetMemCheckHandler()->SetPersistentOption("TestListCache", "true");
+  }
+
+  else if (this->CheckArgument(arg, "--affected-by"_s)) {
+    if (i >= args.size() - 1) {
+      errormsg = "'--affected-by' requires an argument";
+      return false;
+    }
+    i++;
+    std::string const file = cmSystemTools::CollapseFullPath(args[i]);
+    this->GetTestHandler()->SetPersistentOption("AffectedByFile",
+                                                file.c_str());
+    this->GetMemCheckHandler()->SetPersistentOption("AffectedByFile",
+                                                    file.c_str());
+  }
+
+  else if (this->CheckArgument(arg, "--shard-count"_s)) {
+    if (i >= args.size() - 1) {
+      errormsg = "'--shard-count' requires an argument";
+      return false;
+    }
+    i++;
+    unsigned long count;
+    if (!cmStrToULong(args[i], &count) || count < 1) {
+      errormsg = cmStrCat("'--shard-count' given invalid value '", args[i],
+                          "'");
+      return false;
+    }
+    this->GetTestHandler()->SetPersistentOption("ShardCount",
+                                                args[i].c_str());
+    this->GetMemCheckHandler()->SetPersistentOption("ShardCount",
+                                                    args[i].c_str());
+  } else if (this->CheckArgument(arg, "--shard-index"_s)) {
+    if (i >= args.size() - 1) {
+      errormsg = "'--shard-index' requires an argument";
+      return false;
+    }
+    i++;
+    unsigned long index;
+    if (!cmStrToULong(args[i], &index)) {
+      errormsg = cmStrCat("'--shard-index' given invalid value '", args[i],
+                          "'");
+      return false;
+    }
+    this->GetTestHandler()->SetPersistentOption("ShardIndex",
+                                                args[i].c_str());
+    this->GetMemCheckHandler()->SetPersistentOption("ShardIndex",
+                                                    args[i].c_str());
+  }
   return true;
 }
 
@@ -8,6 +8,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <limits>
 #include <map>
 #include <set>
 #include <sstream>
@@ -39,6 +40,8 @@
 #include "cmFileTimes.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGeneratorExpression.h"
+#include "cmGlobVerificationManager.h"
+#include "cmGlobWalker.h"
 #include "cmGlobalGenerator.h"
 #include "cmHexFileConverter.h"
 #include "cmListFileCache.h"
@@ -61,6 +64,7 @@
 #  include <cm3p/curl/curl.h>
 
 #  include "cmCurl.h"
+#  include "cmFileDownloader.h"
 #  include "cmFileLockResult.h"
 #endif
 
@@ -761,8 +765,19 @@ bool HandleGlobImpl(std::vector<std::string> const& args, bool recurse,
         }
       }
 
+      // Walk the directories concurrently where possible if the project
+      // asked to verify globs with an index of the directories read.
       cmsys::Glob::GlobMessages globMessages;
-      g.FindFiles(expr, &globMessages);
+      cmGlobWalker walker(g);
+      bool const walk =
+        status.GetMakefile().IsOn("CMAKE_GLOB_VERIFY_INDEX") &&
+        cmGlobWalker::CanFindFiles(expr);
+      if (walk) {
+        walker.SetRecordStamps(configureDepends);
+        walker.FindFiles(expr, &globMessages);
+      } else {
+        g.FindFiles(expr, &globMessages);
+      }
 
       if (!globMessages.empty()) {
         bool shouldExit = false;
@@ -791,11 +806,13 @@ bool HandleGlobImpl(std::vector<std::string> const& args, bool recurse,
       }
 
       if (recurse && !explicitFollowSymlinks &&
-          g.GetFollowedSymlinkCount() != 0) {
+          (g.GetFollowedSymlinkCount() != 0 ||
+           walker.GetFollowedSymlinkCount() != 0)) {
         warnFollowedSymlinks = true;
       }
 
-      std::vector<std::string>& foundFiles = g.GetFiles();
+      std::vector<std::string>& foundFiles =
+        walk ? walker.GetFiles() : g.GetFiles();
       cm::append(files, foundFiles);
 
       if (configureDepends) {
@@ -806,7 +823,7 @@ bool HandleGlobImpl(std::vector<std::string> const& args, bool recurse,
           recurse, (recurse ? g.GetRecurseListDirs() : g.GetListDirs()),
           (recurse ? g.GetRecurseThroughSymlinks() : false),
           (g.GetRelative() ? g.GetRelative() : ""), expr, foundFiles, variable,
-          status.GetMakefile().GetBacktrace());
+          status.GetMakefile().GetBacktrace(), walk ? &walker : nullptr);
       } else {
         warnConfigureLate = true;
       }
@@ -852,6 +869,22 @@ bool HandleGlobRecurseCommand(std::vector<std::string> const& args,
   return HandleGlobImpl(args, true, status);
 }
 
+bool HandleGlobVerifyIndexCommand(std::vector<std::string> const& args,
+                                  cmExecutionStatus& status)
+{
+  // Glob verification scripts check the index written at generate time.
+  // The reserved name keeps this out of the documented subcommands.
+  if (args.size() != 3) {
+    status.SetError("_CMAKE_GLOB_VERIFY_INDEX requires an index file and an "
+                    "output variable");
+    return false;
+  }
+  bool const changed =
+    cmGlobVerificationManager::VerificationIndexChanged(args[1]);
+  status.GetMakefile().AddDefinitionBool(args[2], changed);
+  return true;
+}
+
 bool HandleMakeDirectoryCommand(std::vector<std::string> const& args,
                                 cmExecutionStatus& status)
 {
@@ -985,6 +1018,22 @@ bool HandleCopyCommand(std::vector<std::string> const& args,
   return copier.Run(args);
 }
 
+// Files installed with CMAKE_INSTALL_USE_LINKS set to HARDLINK may be hard
+// links to their source.  Give them their own copy before editing them.
+bool BreakInstalledHardLink(std::string const& file, const char* subcommand,
+                            cmExecutionStatus& status)
+{
+  if (status.GetMakefile().GetSafeDefinition("CMAKE_INSTALL_USE_LINKS") ==
+        "HARDLINK" &&
+      !cmSystemTools::BreakHardLink(file)) {
+    status.SetError(cmStrCat(subcommand, " could not copy hard link\n  ",
+                             file, "\nbefore modifying it: ",
+                             cmSystemTools::GetLastSystemError()));
+    return false;
+  }
+  return true;
+}
+
 bool HandleRPathChangeCommand(std::vector<std::string> const& args,
                               cmExecutionStatus& status)
 {
@@ -1047,6 +1096,9 @@ bool HandleRPathChangeCommand(std::vector<std::string> const& args,
   std::string emsg;
   bool changed;
 
+  if (!BreakInstalledHardLink(file, "RPATH_CHANGE", status)) {
+    return false;
+  }
   if (!cmSystemTools::ChangeRPath(file, oldRPath, newRPath,
                                   removeEnvironmentRPath, &emsg, &changed)) {
     status.SetError(cmStrCat("RPATH_CHANGE could not write new RPATH:\n  ",
@@ -1101,6 +1153,9 @@ bool HandleRPathRemoveCommand(std::vector<std::string> const& args,
   cmFileTimes const ft(file);
   std::string emsg;
   bool removed;
+  if (!BreakInstalledHardLink(file, "RPATH_REMOVE", status)) {
+    return false;
+  }
   if (!cmSystemTools::RemoveRPath(file, &emsg, &removed)) {
     status.SetError(
       cmStrCat("RPATH_REMOVE could not remove RPATH from file: \n  ", file,
@@ -1231,6 +1286,11 @@ bool HandleReadElfCommand(std::vector<std::string> const& args,
 bool HandleInstallCommand(std::vector<std::string> const& args,
                           cmExecutionStatus& status)
 {
+  // Installation scripts apply manifests written at generate time.  The
+  // keyword is reserved for this internal use.
+  if (args.size() == 3 && args[1] == "_CMAKE_BULK_MANIFEST") {
+    return cmFileInstaller::InstallBulkManifest(status, args[2]);
+  }
   cmFileInstaller installer(status);
   return installer.Run(args);
 }
@@ -1620,6 +1680,7 @@ bool HandleDownloadCommand(std::vector<std::string> const& args,
   std::string netrc_file =
     status.GetMakefile().GetSafeDefinition("CMAKE_NETRC_FILE");
   std::string expectedHash;
+  std::string hashAlgo;
   std::string hashMatchMSG;
   std::unique_ptr<cmCryptoHash> hash;
   bool showProgress = false;
@@ -1697,6 +1758,7 @@ bool HandleDownloadCommand(std::vector<std::string> const& args,
         return false;
       }
       hash = cm::make_unique<cmCryptoHash>(cmCryptoHash::AlgoMD5);
+      hashAlgo = "MD5";
       hashMatchMSG = "MD5 sum";
       expectedHash = cmSystemTools::LowerCase(*i);
     } else if (*i == "SHOW_PROGRESS") {
@@ -1723,6 +1785,7 @@ bool HandleDownloadCommand(std::vector<std::string> const& args,
         status.SetError(err);
         return false;
       }
+      hashAlgo = algo;
       hashMatchMSG = algo + " hash";
     } else if (*i == "USERPWD") {
       ++i;
@@ -1770,6 +1833,22 @@ bool HandleDownloadCommand(std::vector<std::string> const& args,
       return true;
     }
   }
+  // A download cache may already have a file with the expected hash.
+  std::string const cacheDir =
+    status.GetMakefile().GetSafeDefinition("CMAKE_DOWNLOAD_CACHE_DIR");
+  if (!file.empty() && hash && !cacheDir.empty() &&
+      cmFileDownloader::FetchFromCache(cacheDir, hashAlgo, expectedHash,
+                                       file)) {
+    if (!statusVar.empty()) {
+      status.GetMakefile().AddDefinition(
+        statusVar,
+        cmStrCat(0,
+                 ";\"returning early; file found in download cache with "
+                 "expected ",
+                 hashMatchMSG, '"'));
+    }
+    return true;
+  }
   // Make sure parent directory exists so we can write to the file
   // as we receive downloaded bits from curl...
   //
@@ -1967,6 +2046,10 @@ bool HandleDownloadCommand(std::vector<std::string> const& args,
                                ::curl_easy_strerror(res), "\"]\n"));
       return false;
     }
+
+    if (res == CURLE_OK && !cacheDir.empty()) {
+      cmFileDownloader::StoreInCache(cacheDir, hashAlgo, expectedHash, file);
+    }
   }
 
   if (!logVar.empty()) {
@@ -1981,6 +2064,152 @@ bool HandleDownloadCommand(std::vector<std::string> const& args,
 #endif
 }
 
+bool HandleDownloadManyCommand(std::vector<std::string> const& args,
+                               cmExecutionStatus& status)
+{
+#if !defined(CMAKE_BOOTSTRAP)
+  cmMakefile& mf = status.GetMakefile();
+  cmFileDownloader downloader(&mf);
+  downloader.TlsVerify = mf.IsOn("CMAKE_TLS_VERIFY");
+  downloader.CAInfo = mf.GetSafeDefinition("CMAKE_TLS_CAINFO");
+  downloader.NetrcLevel = mf.GetSafeDefinition("CMAKE_NETRC");
+  downloader.NetrcFile = mf.GetSafeDefinition("CMAKE_NETRC_FILE");
+  downloader.CacheDir = mf.GetSafeDefinition("CMAKE_DOWNLOAD_CACHE_DIR");
+  std::string logVar;
+  std::set<std::string> files;
+
+  for (auto i = args.begin() + 1; i != args.end(); ++i) {
+    std::string const& key = *i;
+    bool const itemKey = key == "FILE" || key == "EXPECTED_HASH" ||
+      key == "EXPECTED_MD5" || key == "STATUS";
+    if (key == "SHOW_PROGRESS") {
+      downloader.ShowProgress = true;
+      continue;
+    }
+    if (key != "URL" && key != "TIMEOUT" && key != "INACTIVITY_TIMEOUT" &&
+        key != "LOG" && key != "TLS_VERIFY" && key != "TLS_CAINFO" &&
+        key != "NETRC" && key != "NETRC_FILE" && key != "USERPWD" &&
+        key != "HTTPHEADER" && key != "PARALLEL" && key != "CACHE_DIR" &&
+        !itemKey) {
+      status.SetError(cmStrCat("DOWNLOAD_MANY given unknown argument:\n  ",
+                               key));
+      return false;
+    }
+    if (++i == args.end()) {
+      status.SetError(cmStrCat("DOWNLOAD_MANY missing value for ", key, '.'));
+      return false;
+    }
+    std::string const& value = *i;
+    if (itemKey && downloader.Items.empty()) {
+      status.SetError(
+        cmStrCat("DOWNLOAD_MANY given ", key, " before any URL."));
+      return false;
+    }
+
+    if (key == "URL") {
+      downloader.Items.emplace_back();
+      downloader.Items.back().Url = value;
+#  if defined(_WIN32)
+      downloader.Items.back().Url = fix_file_url_windows(value);
+#  endif
+    } else if (key == "FILE") {
+      downloader.Items.back().File = value;
+    } else if (key == "EXPECTED_HASH" || key == "EXPECTED_MD5") {
+      std::string algo = "MD5";
+      std::string expected = value;
+      if (key == "EXPECTED_HASH") {
+        std::string::size_type pos = value.find('=');
+        if (pos == std::string::npos) {
+          status.SetError(cmStrCat(
+            "DOWNLOAD_MANY EXPECTED_HASH expects ALGO=value but got: ",
+            value));
+          return false;
+        }
+        algo = value.substr(0, pos);
+        expected = value.substr(pos + 1);
+        if (!cmCryptoHash::New(algo)) {
+          status.SetError(cmStrCat(
+            "DOWNLOAD_MANY EXPECTED_HASH given unknown ALGO: ", algo));
+          return false;
+        }
+      }
+      downloader.Items.back().Algo = algo;
+      downloader.Items.back().ExpectedHash =
+        cmSystemTools::LowerCase(expected);
+    } else if (key == "STATUS") {
+      downloader.Items.back().StatusVar = value;
+    } else if (key == "TIMEOUT") {
+      downloader.Timeout = atol(value.c_str());
+    } else if (key == "INACTIVITY_TIMEOUT") {
+      downloader.InactivityTimeout = atol(value.c_str());
+    } else if (key == "LOG") {
+      logVar = value;
+      downloader.Log = true;
+    } else if (key == "TLS_VERIFY") {
+      downloader.TlsVerify = cmIsOn(value);
+    } else if (key == "TLS_CAINFO") {
+      downloader.CAInfo = value;
+    } else if (key == "NETRC") {
+      downloader.NetrcLevel = value;
+    } else if (key == "NETRC_FILE") {
+      downloader.NetrcFile = value;
+    } else if (key == "USERPWD") {
+      downloader.UserPwd = value;
+    } else if (key == "HTTPHEADER") {
+      downloader.Headers.push_back(value);
+    } else if (key == "PARALLEL") {
+      unsigned long parallel = 0;
+      if (!cmStrToULong(value, &parallel) || parallel == 0) {
+        status.SetError(cmStrCat(
+          "DOWNLOAD_MANY PARALLEL expects a positive number but got: ",
+          value));
+        return false;
+      }
+      downloader.Parallel = static_cast<unsigned int>(parallel);
+    } else if (key == "CACHE_DIR") {
+      downloader.CacheDir = value;
+    }
+  }
+
+  if (downloader.Items.empty()) {
+    status.SetError("DOWNLOAD_MANY must be given at least one URL.");
+    return false;
+  }
+  for (cmFileDownloader::Item const& item : downloader.Items) {
+    if (item.File.empty()) {
+      status.SetError(
+        cmStrCat("DOWNLOAD_MANY given URL without FILE:\n  ", item.Url));
+      return false;
+    }
+    if (!files.insert(item.File).second) {
+      status.SetError(
+        cmStrCat("DOWNLOAD_MANY given FILE more than once:\n  ", item.File));
+      return false;
+    }
+  }
+
+  std::string error;
+  bool const ok = downloader.Run(error);
+
+  for (cmFileDownloader::Item const& item : downloader.Items) {
+    if (!item.StatusVar.empty()) {
+      mf.AddDefinition(item.StatusVar, item.Status);
+    }
+  }
+  if (!logVar.empty()) {
+    mf.AddDefinition(logVar, downloader.GetLog());
+  }
+  if (!ok) {
+    status.SetError(error);
+  }
+  return ok;
+#else
+  static_cast<void>(args);
+  status.SetError("DOWNLOAD_MANY not supported by bootstrap cmake.");
+  return false;
+#endif
+}
+
 bool HandleUploadCommand(std::vector<std::string> const& args,
                          cmExecutionStatus& status)
 {
@@ -3168,7 +3397,9 @@ bool HandleArchiveCreateCommand(std::vector<std::string> const& args,
     std::string Format;
     std::string Compression;
     std::string CompressionLevel;
+    std::string Threads;
     std::string MTime;
+    std::string Index;
     bool Verbose = false;
     std::vector<std::string> Paths;
   };
@@ -3179,7 +3410,9 @@ bool HandleArchiveCreateCommand(std::vector<std::string> const& args,
       .Bind("FORMAT"_s, &Arguments::Format)
       .Bind("COMPRESSION"_s, &Arguments::Compression)
       .Bind("COMPRESSION_LEVEL"_s, &Arguments::CompressionLevel)
+      .Bind("THREADS"_s, &Arguments::Threads)
       .Bind("MTIME"_s, &Arguments::MTime)
+      .Bind("INDEX"_s, &Arguments::Index)
       .Bind("VERBOSE"_s, &Arguments::Verbose)
       .Bind("PATHS"_s, &Arguments::Paths);
 
@@ -3196,7 +3429,8 @@ bool HandleArchiveCreateCommand(std::vector<std::string> const& args,
   }
 
   const std::vector<std::string> LIST_ARGS = {
-    "OUTPUT", "FORMAT", "COMPRESSION", "COMPRESSION_LEVEL", "MTIME", "PATHS"
+    "OUTPUT", "FORMAT", "COMPRESSION", "COMPRESSION_LEVEL",
+    "THREADS", "MTIME", "INDEX", "PATHS"
   };
   auto kwbegin = keywordsMissingValues.cbegin();
   auto kwend = cmRemoveMatching(keywordsMissingValues, LIST_ARGS);
@@ -3273,6 +3507,20 @@ bool HandleArchiveCreateCommand(std::vector<std::string> const& args,
     }
   }
 
+  int threads = 1;
+  if (!parsedArgs.Threads.empty()) {
+    unsigned long value;
+    if (!cmStrToULong(parsedArgs.Threads, &value) ||
+        value > static_cast<unsigned long>(
+                  std::numeric_limits<int>::max())) {
+      status.SetError(cmStrCat("THREADS value ", parsedArgs.Threads,
+                               " is not a non-negative integer"));
+      cmSystemTools::SetFatalErrorOccured();
+      return false;
+    }
+    threads = static_cast<int>(value);
+  }
+
   if (parsedArgs.Paths.empty()) {
     status.SetError("ARCHIVE_CREATE requires a non-empty list of PATHS");
     cmSystemTools::SetFatalErrorOccured();
@@ -3281,7 +3529,8 @@ bool HandleArchiveCreateCommand(std::vector<std::string> const& args,
 
   if (!cmSystemTools::CreateTar(parsedArgs.Output, parsedArgs.Paths, compress,
                                 parsedArgs.Verbose, parsedArgs.MTime,
-                                parsedArgs.Format, compressionLevel)) {
+                                parsedArgs.Format, compressionLevel,
+                                threads, parsedArgs.Index)) {
     status.SetError(cmStrCat("failed to compress: ", parsedArgs.Output));
     cmSystemTools::SetFatalErrorOccured();
     return false;
@@ -3299,6 +3548,7 @@ bool HandleArchiveExtractCommand(std::vector<std::string> const& args,
     bool Verbose = false;
     bool ListOnly = false;
     std::string Destination;
+    std::string Index;
     std::vector<std::string> Patterns;
   };
 
@@ -3307,6 +3557,7 @@ bool HandleArchiveExtractCommand(std::vector<std::string> const& args,
                                .Bind("VERBOSE"_s, &Arguments::Verbose)
                                .Bind("LIST_ONLY"_s, &Arguments::ListOnly)
                                .Bind("DESTINATION"_s, &Arguments::Destination)
+                               .Bind("INDEX"_s, &Arguments::Index)
                                .Bind("PATTERNS"_s, &Arguments::Patterns);
 
   std::vector<std::string> unrecognizedArguments;
@@ -3322,7 +3573,7 @@ bool HandleArchiveExtractCommand(std::vector<std::string> const& args,
   }
 
   const std::vector<std::string> LIST_ARGS = { "INPUT", "DESTINATION",
-                                               "PATTERNS" };
+                                               "INDEX", "PATTERNS" };
   auto kwbegin = keywordsMissingValues.cbegin();
   auto kwend = cmRemoveMatching(keywordsMissingValues, LIST_ARGS);
   if (kwend != kwbegin) {
@@ -3333,10 +3584,11 @@ bool HandleArchiveExtractCommand(std::vector<std::string> const& args,
   }
 
   std::string inFile = parsedArgs.Input;
+  std::string indexFile = parsedArgs.Index;
 
   if (parsedArgs.ListOnly) {
     if (!cmSystemTools::ListTar(inFile, parsedArgs.Patterns,
-                                parsedArgs.Verbose)) {
+                                parsedArgs.Verbose, indexFile)) {
       status.SetError(cmStrCat("failed to list: ", inFile));
       cmSystemTools::SetFatalErrorOccured();
       return false;
@@ -3360,6 +3612,10 @@ bool HandleArchiveExtractCommand(std::vector<std::string> const& args,
         inFile =
           cmStrCat(cmSystemTools::GetCurrentWorkingDirectory(), "/", inFile);
       }
+      if (!indexFile.empty() && !cmSystemTools::FileIsFullPath(indexFile)) {
+        indexFile = cmStrCat(cmSystemTools::GetCurrentWorkingDirectory(),
+                             "/", indexFile);
+      }
     }
 
     cmWorkingDirectory workdir(destDir);
@@ -3371,7 +3627,7 @@ bool HandleArchiveExtractCommand(std::vector<std::string> const& args,
     }
 
     if (!cmSystemTools::ExtractTar(inFile, parsedArgs.Patterns,
-                                   parsedArgs.Verbose)) {
+                                   parsedArgs.Verbose, indexFile)) {
       status.SetError(cmStrCat("failed to extract: ", inFile));
       cmSystemTools::SetFatalErrorOccured();
       return false;
@@ -3552,6 +3808,7 @@ bool cmFileCommand(std::vector<std::string> const& args,
     { "WRITE"_s, HandleWriteCommand },
     { "APPEND"_s, HandleAppendCommand },
     { "DOWNLOAD"_s, HandleDownloadCommand },
+    { "DOWNLOAD_MANY"_s, HandleDownloadManyCommand },
     { "UPLOAD"_s, HandleUploadCommand },
     { "READ"_s, HandleReadCommand },
     { "MD5"_s, HandleHashCommand },
@@ -3567,6 +3824,7 @@ bool cmFileCommand(std::vector<std::string> const& args,
     { "STRINGS"_s, HandleStringsCommand },
     { "GLOB"_s, HandleGlobCommand },
     { "GLOB_RECURSE"_s, HandleGlobRecurseCommand },
+    { "_CMAKE_GLOB_VERIFY_INDEX"_s, HandleGlobVerifyIndexCommand },
     { "MAKE_DIRECTORY"_s, HandleMakeDirectoryCommand },
     { "RENAME"_s, HandleRename },
     { "REMOVE"_s, HandleRemove },
@@ -3,6 +3,8 @@
 
 #include "cmFileCopier.h"
 
+#include <cm3p/uv.h>
+
 #include "cmsys/Directory.hxx"
 #include "cmsys/Glob.hxx"
 
@@ -18,8 +20,16 @@
 #  include "cmsys/FStream.hxx"
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
+
+#if !defined(CMAKE_BOOTSTRAP)
+#  include <thread>
+#endif
 
 using namespace cmFSPermissions;
 
@@ -28,9 +38,12 @@ cmFileCopier::cmFileCopier(cmExecutionStatus& status, const char* name)
   , Makefile(&status.GetMakefile())
   , Name(name)
   , Always(false)
+  , UseLinks(false)
   , MatchlessFiles(true)
   , FilePermissions(0)
   , DirPermissions(0)
+  , Queue(nullptr)
+  , ClosingDirectories(0)
   , CurrentMatchRule(nullptr)
   , UseGivenPermissionsFile(false)
   , UseGivenPermissionsDir(false)
@@ -68,12 +81,14 @@ cmFileCopier::MatchProperties cmFileCopier::CollectMatchProperties(
   return result;
 }
 
-bool cmFileCopier::SetPermissions(const std::string& toFile,
-                                  mode_t permissions)
+static bool cmFileCopierSetPermissions(const char* name,
+                                       const std::string& toFile,
+                                       mode_t permissions, bool crossCompiling,
+                                       std::string& error)
 {
   if (permissions) {
 #ifdef WIN32
-    if (Makefile->IsOn("CMAKE_CROSSCOMPILING")) {
+    if (crossCompiling) {
       // Store the mode in an NTFS alternate stream.
       std::string mode_t_adt_filename = toFile + ":cmake_mode_t";
 
@@ -89,19 +104,37 @@ bool cmFileCopier::SetPermissions(const std::string& toFile,
       }
       file_time_orig.Store(toFile);
     }
+#else
+    static_cast<void>(crossCompiling);
 #endif
 
     if (!cmSystemTools::SetPermissions(toFile, permissions)) {
       std::ostringstream e;
-      e << this->Name << " cannot set permissions on \"" << toFile
+      e << name << " cannot set permissions on \"" << toFile
         << "\": " << cmSystemTools::GetLastSystemError() << ".";
-      this->Status.SetError(e.str());
+      error = e.str();
       return false;
     }
   }
   return true;
 }
 
+bool cmFileCopier::SetPermissions(const std::string& toFile,
+                                  mode_t permissions)
+{
+  bool crossCompiling = false;
+#ifdef WIN32
+  crossCompiling = this->Makefile->IsOn("CMAKE_CROSSCOMPILING");
+#endif
+  std::string error;
+  if (!cmFileCopierSetPermissions(this->Name, toFile, permissions,
+                                  crossCompiling, error)) {
+    this->Status.SetError(error);
+    return false;
+  }
+  return true;
+}
+
 // Translate an argument to a permissions bit.
 bool cmFileCopier::CheckPermissions(std::string const& arg,
                                     mode_t& permissions)
@@ -389,6 +422,20 @@ bool cmFileCopier::Run(std::vector<std::string> const& args)
     return false;
   }
 
+  // Write regular files concurrently unless the caller collects them.
+  if (this->Queue) {
+    return this->InstallFiles();
+  }
+  WriteQueue queue;
+  this->Queue = &queue;
+  bool const installed = this->InstallFiles();
+  this->Queue = nullptr;
+  bool const finished = queue.Finish();
+  return finished && installed;
+}
+
+bool cmFileCopier::InstallFiles()
+{
   for (std::string const& f : this->Files) {
     std::string file;
     if (!f.empty() && !cmSystemTools::FileIsFullPath(f)) {
@@ -461,28 +508,61 @@ bool cmFileCopier::Install(const std::string& fromFile,
     return true;
   }
 
-  if (cmSystemTools::SameFile(fromFile, toFile)) {
-    return true;
-  }
-
   std::string newFromFile = fromFile;
   std::string newToFile = toFile;
 
-  if (this->FollowSymlinkChain &&
-      !this->InstallSymlinkChain(newFromFile, newToFile)) {
-    return false;
+  if (this->FollowSymlinkChain) {
+    if (cmSystemTools::SameFile(fromFile, toFile)) {
+      return true;
+    }
+    if (!this->InstallSymlinkChain(newFromFile, newToFile)) {
+      return false;
+    }
   }
 
-  if (cmSystemTools::FileIsSymlink(newFromFile)) {
-    return this->InstallSymlink(newFromFile, newToFile);
+  // Query the source once.  Whether a regular file is installed onto
+  // itself is checked along with its destination when it is written.
+  FileStatus fromStatus;
+  if (!GetFileStatus(newFromFile, false, fromStatus)) {
+    return this->ReportMissing(newFromFile);
   }
-  if (cmSystemTools::FileIsDirectory(newFromFile)) {
+  if (fromStatus.IsSymlink || fromStatus.IsDirectory) {
+    if (!this->FollowSymlinkChain &&
+        cmSystemTools::SameFile(fromFile, toFile)) {
+      return true;
+    }
+    if (this->Queue && this->Queue->Pending.count(newToFile)) {
+      this->Queue->RunWrites();
+    }
+    if (fromStatus.IsSymlink) {
+      return this->InstallSymlink(newFromFile, newToFile);
+    }
     return this->InstallDirectory(newFromFile, newToFile, match_properties);
   }
-  if (cmSystemTools::FileExists(newFromFile)) {
-    return this->InstallFile(newFromFile, newToFile, match_properties);
-  }
-  return this->ReportMissing(newFromFile);
+  return this->InstallFile(newFromFile, newToFile, fromStatus,
+                           match_properties);
+}
+
+bool cmFileCopier::GetFileStatus(std::string const& path,
+                                 bool followSymlinks, FileStatus& status)
+{
+  uv_fs_t req;
+  int const err = followSymlinks
+    ? uv_fs_stat(nullptr, &req, path.c_str(), nullptr)
+    : uv_fs_lstat(nullptr, &req, path.c_str(), nullptr);
+  if (err == 0) {
+    uv_stat_t const& st = req.statbuf;
+    status.IsSymlink = (st.st_mode & S_IFMT) == S_IFLNK;
+    status.IsDirectory = (st.st_mode & S_IFMT) == S_IFDIR;
+    status.Mode = static_cast<mode_t>(st.st_mode & 07777);
+    status.Device = st.st_dev;
+    status.Inode = st.st_ino;
+    status.Size = st.st_size;
+    status.MTime = static_cast<long long>(st.st_mtim.tv_sec) * 1000000000 +
+      st.st_mtim.tv_nsec;
+  }
+  uv_fs_req_cleanup(&req);
+  return err == 0;
 }
 
 bool cmFileCopier::InstallSymlinkChain(std::string& fromFile,
@@ -508,7 +588,7 @@ bool cmFileCopier::InstallSymlinkChain(std::string& fromFile,
       }
     }
 
-    this->ReportCopy(toFile, TypeLink, copy);
+    this->Report(toFile, TypeLink, copy);
 
     if (copy) {
       cmSystemTools::RemoveFile(toFile);
@@ -557,7 +637,7 @@ bool cmFileCopier::InstallSymlink(const std::string& fromFile,
   }
 
   // Inform the user about this file installation.
-  this->ReportCopy(toFile, TypeLink, copy);
+  this->Report(toFile, TypeLink, copy);
 
   if (copy) {
     // Remove the destination file so we can always create the symlink.
@@ -582,31 +662,134 @@ bool cmFileCopier::InstallSymlink(const std::string& fromFile,
 
 bool cmFileCopier::InstallFile(const std::string& fromFile,
                                const std::string& toFile,
+                               FileStatus const& fromStatus,
                                MatchProperties match_properties)
 {
-  // Determine whether we will copy the file.
-  bool copy = true;
-  if (!this->Always) {
-    // If both files exist with the same time do not copy.
-    if (!this->FileTimes.DifferS(fromFile, toFile)) {
-      copy = false;
-    }
+  FileWrite write;
+  write.FromFile = fromFile;
+  write.ToFile = toFile;
+  write.From = fromStatus;
+  write.Name = this->Name;
+  write.Always = this->Always;
+  write.UseLinks = this->UseLinks;
+  write.MayHardLink = this->MayHardLink();
+#ifdef WIN32
+  write.CrossCompiling = this->Makefile->IsOn("CMAKE_CROSSCOMPILING");
+#endif
+
+  // Determine the permissions of the destination file.
+  write.Permissions =
+    (match_properties.Permissions ? match_properties.Permissions
+                                  : this->FilePermissions);
+  if (!write.Permissions) {
+    // No permissions were explicitly provided but the user requested
+    // that the source file permissions be used.
+#ifdef _WIN32
+    cmSystemTools::GetPermissions(fromFile, write.Permissions);
+#else
+    write.Permissions = fromStatus.Mode;
+#endif
+  }
+
+  // Write the file along with others later, but only while the
+  // destination directory is still writable.
+  if (this->Queue && this->ClosingDirectories == 0) {
+    this->Report(toFile, TypeFile, true);
+    this->Queue->Reports.back().Write = this->Queue->Writes.size();
+    this->Queue->Pending.insert(toFile);
+    this->Queue->Writes.emplace_back(std::move(write));
+    return true;
+  }
+  if (this->Queue && this->Queue->Pending.count(toFile)) {
+    this->Queue->RunWrites();
+  }
+
+  // Determine whether we will copy the file.  A file that is already
+  // the destination, such as a hard link installed before, is up to date.
+  CheckFileWrite(write);
+  if (write.Skip) {
+    this->Report(toFile, TypeFile, false);
+    return true;
   }
 
   // Inform the user about this file installation.
-  this->ReportCopy(toFile, TypeFile, copy);
+  this->Report(toFile, TypeFile, write.Copy);
+
+  if (!RunFileWrite(write)) {
+    this->Status.SetError(write.Error);
+    return false;
+  }
+  return true;
+}
+
+void cmFileCopier::CheckFileWrite(FileWrite& write)
+{
+  FileStatus to;
+  if (!GetFileStatus(write.ToFile, false, to)) {
+    write.Copy = true;
+    return;
+  }
+
+  // Compare with the file a symbolic link points to, but never write
+  // through the link.
+  if (to.IsSymlink) {
+    write.ReplaceLink = true;
+    if (!GetFileStatus(write.ToFile, true, to)) {
+      write.Copy = true;
+      return;
+    }
+  }
 
-  // Copy the file.
-  if (copy && !cmSystemTools::CopyAFile(fromFile, toFile, true)) {
+  // Do nothing if the destination is the source itself.
+  if (to.Device == write.From.Device && to.Inode == write.From.Inode &&
+      to.Size == write.From.Size) {
+    write.Copy = false;
+    write.Skip = true;
+    return;
+  }
+
+  // If both files exist with the same time do not copy.
+  long long const nsPerS = 1000000000;
+  long long const diff = write.From.MTime - to.MTime;
+  write.Copy = write.Always || diff <= -nsPerS || diff >= nsPerS;
+  write.ToMode = to.Mode;
+}
+
+bool cmFileCopier::RunFileWrite(FileWrite& write)
+{
+  if (write.Skip) {
+    return true;
+  }
+
+  std::string const& fromFile = write.FromFile;
+  std::string const& toFile = write.ToFile;
+
+  // Link or copy the file.
+  bool linked = false;
+  bool hardLinked = false;
+  if (write.Copy && write.UseLinks) {
+    linked = LinkFile(write, hardLinked);
+  }
+  if (write.Copy && !linked && write.ReplaceLink) {
+    cmSystemTools::RemoveFile(toFile);
+  }
+  if (write.Copy && !linked &&
+      !cmSystemTools::CopyRegularFile(fromFile, toFile)) {
     std::ostringstream e;
-    e << this->Name << " cannot copy file \"" << fromFile << "\" to \""
+    e << write.Name << " cannot copy file \"" << fromFile << "\" to \""
       << toFile << "\": " << cmSystemTools::GetLastSystemError() << ".";
-    this->Status.SetError(e.str());
+    write.Error = e.str();
     return false;
   }
 
+  // A hard link already shares the times and permissions of its source,
+  // which must not be modified.
+  if (hardLinked) {
+    return true;
+  }
+
   // Set the file modification time of the destination file.
-  if (copy && !this->Always) {
+  if (write.Copy && !write.Always) {
     // Add write permission so we can set the file time.
     // Permissions are set unconditionally below anyway.
     mode_t perm = 0;
@@ -615,23 +798,135 @@ bool cmFileCopier::InstallFile(const std::string& fromFile,
     }
     if (!cmFileTimes::Copy(fromFile, toFile)) {
       std::ostringstream e;
-      e << this->Name << " cannot set modification time on \"" << toFile
+      e << write.Name << " cannot set modification time on \"" << toFile
         << "\": " << cmSystemTools::GetLastSystemError() << ".";
-      this->Status.SetError(e.str());
+      write.Error = e.str();
       return false;
     }
   }
 
+#ifndef _WIN32
+  // Leave an up-to-date file alone if it has the permissions already.
+  if (!write.Copy && write.ToMode == (write.Permissions & 07777)) {
+    return true;
+  }
+#endif
+
   // Set permissions of the destination file.
-  mode_t permissions =
-    (match_properties.Permissions ? match_properties.Permissions
-                                  : this->FilePermissions);
-  if (!permissions) {
-    // No permissions were explicitly provided but the user requested
-    // that the source file permissions be used.
-    cmSystemTools::GetPermissions(fromFile, permissions);
+  return cmFileCopierSetPermissions(write.Name, toFile, write.Permissions,
+                                    write.CrossCompiling, write.Error);
+}
+
+bool cmFileCopier::LinkFile(FileWrite const& write, bool& hardLinked)
+{
+  std::string const& fromFile = write.FromFile;
+  std::string const& toFile = write.ToFile;
+
+  // Never write through a link left over from a previous installation.
+  cmSystemTools::RemoveFile(toFile);
+
+  // A copy-on-write clone is a private copy that shares storage with
+  // its source until either of them is modified.
+  if (cmSystemTools::CloneFile(fromFile, toFile)) {
+    return true;
+  }
+
+  // A hard link is the source file itself.  Use one only if nothing
+  // will be changed about the installed file.
+  mode_t fromPermissions = 0;
+  if (!write.MayHardLink ||
+      !cmSystemTools::GetPermissions(fromFile, fromPermissions) ||
+      (fromPermissions & 07777) != (write.Permissions & 07777)) {
+    return false;
+  }
+  std::string err;
+  hardLinked = cmSystemTools::CreateLink(fromFile, toFile, &err);
+  return hardLinked;
+}
+
+void cmFileCopier::Report(const std::string& toFile, Type type, bool copy)
+{
+  if (!this->Queue) {
+    this->ReportCopy(toFile, type, copy);
+    return;
+  }
+  WriteQueue::Report report;
+  report.Copier = this;
+  report.ToFile = toFile;
+  report.FileType = type;
+  report.Copy = copy;
+  this->Queue->Reports.emplace_back(std::move(report));
+}
+
+void cmFileCopier::WriteQueue::RunWrites()
+{
+  // Files written to the same destination more than once are written by
+  // the same thread in the order they were visited.
+  std::vector<std::vector<size_t>> groups;
+  {
+    std::unordered_map<std::string, size_t> groupOf;
+    for (size_t i = this->Written; i < this->Writes.size(); ++i) {
+      auto ins = groupOf.emplace(this->Writes[i].ToFile, groups.size());
+      if (ins.second) {
+        groups.emplace_back();
+      }
+      groups[ins.first->second].push_back(i);
+    }
+  }
+  this->Written = this->Writes.size();
+  this->Pending.clear();
+
+  std::atomic<size_t> next(0);
+  auto worker = [this, &groups, &next]() {
+    for (size_t g = next++; g < groups.size(); g = next++) {
+      for (size_t i : groups[g]) {
+        FileWrite& write = this->Writes[i];
+        cmFileCopier::CheckFileWrite(write);
+        cmFileCopier::RunFileWrite(write);
+      }
+    }
+  };
+
+#if !defined(CMAKE_BOOTSTRAP)
+  // A few files are not worth starting threads for, and writes are bound
+  // by the disk long before they are by the number of processors.
+  size_t const filesPerThread = 16;
+  size_t const maxThreads = 8;
+  size_t numThreads =
+    std::min<size_t>(std::thread::hardware_concurrency(), maxThreads);
+  numThreads = std::min(numThreads, groups.size() / filesPerThread);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < numThreads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& t : threads) {
+    t.join();
+  }
+#else
+  // The bootstrap build does not link a thread library.
+  worker();
+#endif
+}
+
+bool cmFileCopier::WriteQueue::Finish()
+{
+  this->RunWrites();
+
+  // Report everything in order as if it had been installed serially.
+  for (Report const& report : this->Reports) {
+    if (report.Write == std::string::npos) {
+      report.Copier->ReportCopy(report.ToFile, report.FileType, report.Copy);
+      continue;
+    }
+    FileWrite const& write = this->Writes[report.Write];
+    report.Copier->ReportCopy(report.ToFile, TypeFile, write.Copy);
+    if (!write.Error.empty()) {
+      report.Copier->Status.SetError(write.Error);
+      return false;
+    }
   }
-  return this->SetPermissions(toFile, permissions);
+  return true;
 }
 
 bool cmFileCopier::InstallDirectory(const std::string& source,
@@ -639,8 +934,8 @@ bool cmFileCopier::InstallDirectory(const std::string& source,
                                     MatchProperties match_properties)
 {
   // Inform the user about this directory installation.
-  this->ReportCopy(destination, TypeDir,
-                   !cmSystemTools::FileIsDirectory(destination));
+  this->Report(destination, TypeDir,
+               !cmSystemTools::FileIsDirectory(destination));
 
   // check if default dir creation permissions were set
   mode_t default_dir_mode_v = 0;
@@ -690,6 +985,16 @@ bool cmFileCopier::InstallDirectory(const std::string& source,
     return false;
   }
 
+  // Files cannot be written into the directory once it has its final
+  // permissions, so write them right away.  Earlier files might have been
+  // queued for the same destinations.
+  if (permissions_after) {
+    if (this->Queue && this->ClosingDirectories == 0) {
+      this->Queue->RunWrites();
+    }
+    ++this->ClosingDirectories;
+  }
+
   // Load the directory contents to traverse it recursively.
   cmsys::Directory dir;
   if (!source.empty()) {
@@ -706,6 +1011,9 @@ bool cmFileCopier::InstallDirectory(const std::string& source,
       }
     }
   }
+  if (permissions_after) {
+    --this->ClosingDirectories;
+  }
 
   // Set the requested permissions of the destination directory.
   return this->SetPermissions(destination, permissions_after);
@@ -4,15 +4,15 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <cstdint>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "cmsys/RegularExpression.hxx"
 
 #include "cm_sys_stat.h"
 
-#include "cmFileTimeCache.h"
-
 class cmExecutionStatus;
 class cmMakefile;
 
@@ -29,7 +29,8 @@ protected:
   cmMakefile* Makefile;
   const char* Name;
   bool Always;
-  cmFileTimeCache FileTimes;
+  // Whether to clone or hard link files instead of copying them.
+  bool UseLinks;
 
   // Whether to install a file not matching any expression.
   bool MatchlessFiles;
@@ -65,14 +66,32 @@ protected:
   // Translate an argument to a permissions bit.
   bool CheckPermissions(std::string const& arg, mode_t& permissions);
 
+  // What a single status query reports about a file.
+  struct FileStatus
+  {
+    bool IsSymlink = false;
+    bool IsDirectory = false;
+    mode_t Mode = 0;
+    uint64_t Device = 0;
+    uint64_t Inode = 0;
+    uint64_t Size = 0;
+    // Modification time in nanoseconds.
+    long long MTime = 0;
+  };
+  static bool GetFileStatus(std::string const& path, bool followSymlinks,
+                            FileStatus& status);
+
   bool InstallSymlinkChain(std::string& fromFile, std::string& toFile);
   bool InstallSymlink(const std::string& fromFile, const std::string& toFile);
   bool InstallFile(const std::string& fromFile, const std::string& toFile,
+                   FileStatus const& fromStatus,
                    MatchProperties match_properties);
   bool InstallDirectory(const std::string& source,
                         const std::string& destination,
                         MatchProperties match_properties);
   virtual bool Install(const std::string& fromFile, const std::string& toFile);
+  // Whether an installed file may share its inode with the source file.
+  virtual bool MayHardLink() const { return true; }
   virtual std::string const& ToName(std::string const& fromName);
 
   enum Type
@@ -84,6 +103,66 @@ protected:
   virtual void ReportCopy(const std::string&, Type, bool) {}
   virtual bool ReportMissing(const std::string& fromFile);
 
+  // Writing of one regular file to its destination.  This does not use
+  // the cmMakefile, so it may be done on any thread.
+  struct FileWrite
+  {
+    std::string FromFile;
+    std::string ToFile;
+    FileStatus From;
+    mode_t Permissions = 0;
+    const char* Name = nullptr;
+    bool Always = false;
+    bool UseLinks = false;
+    bool MayHardLink = false;
+    bool CrossCompiling = false;
+
+    // Whether the destination is the source itself and nothing is done.
+    bool Skip = false;
+    // Whether the destination is out of date and has to be written.
+    bool Copy = true;
+    // Whether the destination is a symbolic link to be replaced.
+    bool ReplaceLink = false;
+    // Permissions the destination already has.
+    mode_t ToMode = 0;
+    // Why writing the file failed.
+    std::string Error;
+  };
+  static void CheckFileWrite(FileWrite& write);
+  static bool RunFileWrite(FileWrite& write);
+  static bool LinkFile(FileWrite const& write, bool& hardLinked);
+
+  // Regular files written concurrently once all inputs have been visited.
+  // Everything is reported afterwards in the order it was visited.
+  struct WriteQueue
+  {
+    std::vector<FileWrite> Writes;
+    struct Report
+    {
+      cmFileCopier* Copier = nullptr;
+      std::string ToFile;
+      Type FileType = TypeFile;
+      bool Copy = false;
+      size_t Write = std::string::npos;
+    };
+    std::vector<Report> Reports;
+
+    // Destinations of the writes that have not been run yet.
+    std::unordered_set<std::string> Pending;
+    size_t Written = 0;
+
+    void RunWrites();
+    bool Finish();
+  };
+  WriteQueue* Queue;
+
+  // Number of directories being installed whose final permissions do not
+  // allow files to be written into them later.
+  unsigned int ClosingDirectories;
+
+  void Report(const std::string& toFile, Type type, bool copy);
+  bool InstallFiles();
+
   MatchRule* CurrentMatchRule;
   bool UseGivenPermissionsFile;
   bool UseGivenPermissionsDir;
@@ -0,0 +1,534 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmFileDownloader.h"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include <cm/memory>
+
+#include <cm3p/curl/curl.h>
+#include <cm3p/uv.h>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmCurl.h"
+#include "cmMakefile.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+struct cmFileDownloader::Transfer
+{
+  Transfer(Item& item)
+    : Target(item)
+  {
+  }
+
+  ~Transfer()
+  {
+    if (this->Multi) {
+      ::curl_multi_remove_handle(this->Multi, this->Easy);
+    }
+    if (this->Easy) {
+      ::curl_easy_cleanup(this->Easy);
+    }
+  }
+
+  Transfer(Transfer const&) = delete;
+  Transfer& operator=(Transfer const&) = delete;
+
+  Item& Target;
+  std::unique_ptr<cmCryptoHash> Hash;
+  std::string PartFile;
+  cmsys::ofstream Out;
+  ::CURL* Easy = nullptr;
+  ::CURLM* Multi = nullptr;
+  // Size of a partial file whose transfer is resumed.
+  curl_off_t Offset = 0;
+  bool Received = false;
+  bool Restarted = false;
+  std::vector<char> Debug;
+};
+
+namespace {
+
+size_t cmFileDownloaderWrite(void* ptr, size_t size, size_t nmemb,
+                             void* data)
+{
+  auto* t = static_cast<cmFileDownloader::Transfer*>(data);
+  size_t const n = size * nmemb;
+  if (t->Offset > 0 && !t->Received) {
+    // A server that does not support ranges sends the whole file.
+    long code = 0;
+    ::curl_easy_getinfo(t->Easy, CURLINFO_RESPONSE_CODE, &code);
+    if (code == 200) {
+      t->Out.close();
+      t->Out.open(t->PartFile.c_str(), std::ios::binary | std::ios::trunc);
+      t->Hash->Initialize();
+      t->Offset = 0;
+    }
+  }
+  t->Received = true;
+  t->Out.write(static_cast<char const*>(ptr),
+               static_cast<std::streamsize>(n));
+  if (!t->Out) {
+    return 0;
+  }
+  if (t->Hash) {
+    t->Hash->Append(ptr, n);
+  }
+  return n;
+}
+
+size_t cmFileDownloaderDebug(CURL*, curl_infotype type, char* chPtr,
+                             size_t size, void* data)
+{
+  auto* t = static_cast<cmFileDownloader::Transfer*>(data);
+  switch (type) {
+    case CURLINFO_TEXT:
+    case CURLINFO_HEADER_IN:
+    case CURLINFO_HEADER_OUT:
+      t->Debug.insert(t->Debug.end(), chPtr, chPtr + size);
+      break;
+    case CURLINFO_DATA_IN:
+    case CURLINFO_DATA_OUT:
+    case CURLINFO_SSL_DATA_IN:
+    case CURLINFO_SSL_DATA_OUT: {
+      std::string const msg = cmStrCat('[', size, " bytes data]\n");
+      t->Debug.insert(t->Debug.end(), msg.begin(), msg.end());
+    } break;
+    default:
+      break;
+  }
+  return 0;
+}
+
+// Feed the content of an existing file to a hash.
+bool cmFileDownloaderHashPartial(cmCryptoHash& hash, std::string const& file)
+{
+  cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  char buffer[16384];
+  while (fin) {
+    fin.read(buffer, sizeof(buffer));
+    if (std::streamsize const n = fin.gcount()) {
+      hash.Append(buffer, static_cast<size_t>(n));
+    }
+  }
+  return fin.eof();
+}
+
+class cmFileDownloaderMulti
+{
+public:
+  cmFileDownloaderMulti()
+  {
+    ::curl_global_init(CURL_GLOBAL_DEFAULT);
+    this->Multi = ::curl_multi_init();
+  }
+
+  ~cmFileDownloaderMulti()
+  {
+    ::curl_slist_free_all(this->Headers);
+    if (this->Multi) {
+      ::curl_multi_cleanup(this->Multi);
+    }
+    ::curl_global_cleanup();
+  }
+
+  cmFileDownloaderMulti(cmFileDownloaderMulti const&) = delete;
+  cmFileDownloaderMulti& operator=(cmFileDownloaderMulti const&) = delete;
+
+  ::CURLM* Multi = nullptr;
+  struct curl_slist* Headers = nullptr;
+};
+}
+
+#define check_curl_result(result, errstr)                                     \
+  do {                                                                        \
+    if (result != CURLE_OK) {                                                 \
+      error = cmStrCat(errstr, ::curl_easy_strerror(result));                 \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+cmFileDownloader::cmFileDownloader(cmMakefile* mf)
+  : Makefile(mf)
+{
+}
+
+std::string cmFileDownloader::GetCachePath(std::string const& cacheDir,
+                                           std::string const& algo,
+                                           std::string const& hash)
+{
+  return cmStrCat(cacheDir, '/', cmSystemTools::UpperCase(algo), '/',
+                  hash.substr(0, 2), '/', hash);
+}
+
+bool cmFileDownloader::FetchFromCache(std::string const& cacheDir,
+                                      std::string const& algo,
+                                      std::string const& hash,
+                                      std::string const& file)
+{
+  std::string const cached = GetCachePath(cacheDir, algo, hash);
+  if (!cmSystemTools::FileExists(cached, true)) {
+    return false;
+  }
+  std::unique_ptr<cmCryptoHash> hasher = cmCryptoHash::New(algo);
+  if (!hasher) {
+    return false;
+  }
+  if (hasher->HashFile(cached) != hash) {
+    // Do not let a damaged entry shadow a good download.
+    cmSystemTools::RemoveFile(cached);
+    return false;
+  }
+  std::string const dir = cmSystemTools::GetFilenamePath(file);
+  if (!dir.empty() && !cmSystemTools::MakeDirectory(dir)) {
+    return false;
+  }
+  return cmSystemTools::CopyRegularFile(cached, file);
+}
+
+void cmFileDownloader::StoreInCache(std::string const& cacheDir,
+                                    std::string const& algo,
+                                    std::string const& hash,
+                                    std::string const& file)
+{
+  std::string const cached = GetCachePath(cacheDir, algo, hash);
+  if (cmSystemTools::FileExists(cached, true) ||
+      !cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(cached))) {
+    return;
+  }
+  // Copy under a private name first so that concurrent processes never
+  // see a partial entry.
+  std::string const temp = cmStrCat(cached, ".tmp", uv_os_getpid());
+  if (!cmSystemTools::CopyRegularFile(file, temp) ||
+      !cmSystemTools::RenameFile(temp, cached)) {
+    cmSystemTools::RemoveFile(temp);
+  }
+}
+
+bool cmFileDownloader::Run(std::string& error)
+{
+  std::vector<std::unique_ptr<Transfer>> transfers;
+  for (Item& item : this->Items) {
+    std::unique_ptr<cmCryptoHash> hash;
+    if (!item.Algo.empty()) {
+      hash = cmCryptoHash::New(item.Algo);
+      if (!hash) {
+        error = cmStrCat("DOWNLOAD_MANY EXPECTED_HASH given unknown ALGO: ",
+                         item.Algo);
+        return false;
+      }
+      // A file that is already present needs no transfer.
+      if (cmSystemTools::FileExists(item.File, true) &&
+          hash->HashFile(item.File) == item.ExpectedHash) {
+        item.Status =
+          cmStrCat("0;\"returning early; file already exists with expected ",
+                   item.Algo, " hash\"");
+        continue;
+      }
+      if (!this->CacheDir.empty() &&
+          FetchFromCache(this->CacheDir, item.Algo, item.ExpectedHash,
+                         item.File)) {
+        item.Status =
+          cmStrCat("0;\"returning early; file found in download cache with "
+                   "expected ",
+                   item.Algo, " hash\"");
+        continue;
+      }
+    }
+    transfers.emplace_back(cm::make_unique<Transfer>(item));
+    transfers.back()->Hash = std::move(hash);
+    transfers.back()->PartFile = cmStrCat(item.File, ".part");
+  }
+  if (transfers.empty()) {
+    return true;
+  }
+
+  cmFileDownloaderMulti multi;
+  if (!multi.Multi) {
+    error = "DOWNLOAD_MANY error initializing curl.";
+    return false;
+  }
+  for (std::string const& h : this->Headers) {
+    multi.Headers = ::curl_slist_append(multi.Headers, h.c_str());
+  }
+
+  std::string const netrcLevel = cmSystemTools::UpperCase(this->NetrcLevel);
+  auto start = [&](Transfer& t) -> bool {
+    std::string const dir = cmSystemTools::GetFilenamePath(t.Target.File);
+    if (!dir.empty() && !cmSystemTools::FileExists(dir) &&
+        !cmSystemTools::MakeDirectory(dir)) {
+      error = cmStrCat("DOWNLOAD_MANY error: cannot create directory '", dir,
+                       "' - Specify file by full path name and verify that "
+                       "you have directory creation and file write "
+                       "privileges.");
+      return false;
+    }
+
+    // Only a transfer whose result is checked against a hash may be
+    // continued from an earlier partial file.
+    t.Offset = 0;
+    t.Received = false;
+    t.Debug.clear();
+    if (t.Hash) {
+      t.Hash->Initialize();
+      if (cmSystemTools::FileExists(t.PartFile, true)) {
+        t.Offset =
+          static_cast<curl_off_t>(cmSystemTools::FileLength(t.PartFile));
+        if (t.Offset > 0 &&
+            !cmFileDownloaderHashPartial(*t.Hash, t.PartFile)) {
+          t.Hash->Initialize();
+          t.Offset = 0;
+        }
+      }
+    }
+    t.Out.open(t.PartFile.c_str(),
+               t.Offset > 0 ? std::ios::binary | std::ios::app
+                            : std::ios::binary | std::ios::trunc);
+    if (!t.Out) {
+      error = cmStrCat("DOWNLOAD_MANY cannot open file for write: ",
+                       t.PartFile);
+      return false;
+    }
+
+    if (t.Easy) {
+      ::curl_easy_cleanup(t.Easy);
+    }
+    t.Easy = ::curl_easy_init();
+    if (!t.Easy) {
+      error = "DOWNLOAD_MANY error initializing curl.";
+      return false;
+    }
+    ::CURL* curl = t.Easy;
+    ::CURLcode res =
+      ::curl_easy_setopt(curl, CURLOPT_URL, t.Target.Url.c_str());
+    check_curl_result(res, "DOWNLOAD_MANY cannot set url: ");
+
+    res = ::curl_easy_setopt(curl, CURLOPT_PRIVATE, &t);
+    check_curl_result(res, "DOWNLOAD_MANY cannot set private data: ");
+
+    res = ::curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1);
+    check_curl_result(res, "DOWNLOAD_MANY cannot set http failure option: ");
+
+    res = ::curl_easy_setopt(curl, CURLOPT_USERAGENT, "curl/" LIBCURL_VERSION);
+    check_curl_result(res, "DOWNLOAD_MANY cannot set user agent option: ");
+
+    res = ::curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
+                             cmFileDownloaderWrite);
+    check_curl_result(res, "DOWNLOAD_MANY cannot set write function: ");
+
+    res = ::curl_easy_setopt(curl, CURLOPT_WRITEDATA, &t);
+    check_curl_result(res, "DOWNLOAD_MANY cannot set write data: ");
+
+    if (this->Log) {
+      res = ::curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION,
+                               cmFileDownloaderDebug);
+      check_curl_result(res, "DOWNLOAD_MANY cannot set debug function: ");
+
+      res = ::curl_easy_setopt(curl, CURLOPT_DEBUGDATA, &t);
+      check_curl_result(res, "DOWNLOAD_MANY cannot set debug data: ");
+
+      res = ::curl_easy_setopt(curl, CURLOPT_VERBOSE, 1);
+      check_curl_result(res, "DOWNLOAD_MANY cannot set verbose: ");
+    }
+
+    res = ::curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER,
+                             this->TlsVerify ? 1L : 0L);
+    check_curl_result(res, "DOWNLOAD_MANY cannot set TLS/SSL Verify: ");
+
+    std::string const& cainfo_err = cmCurlSetCAInfo(
+      curl, this->CAInfo.empty() ? nullptr : this->CAInfo.c_str());
+    if (!cainfo_err.empty()) {
+      error = cainfo_err;
+      return false;
+    }
+
+    std::string const& netrc_option_err =
+      cmCurlSetNETRCOption(curl, netrcLevel, this->NetrcFile);
+    if (!netrc_option_err.empty()) {
+      error = netrc_option_err;
+      return false;
+    }
+
+    res = ::curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    check_curl_result(res,
+                      "DOWNLOAD_MANY cannot set follow-redirect option: ");
+
+    if (this->Timeout > 0) {
+      res = ::curl_easy_setopt(curl, CURLOPT_TIMEOUT, this->Timeout);
+      check_curl_result(res, "DOWNLOAD_MANY cannot set timeout: ");
+    }
+
+    if (this->InactivityTimeout > 0) {
+      // Give up if there is no progress for a long time.
+      ::curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1);
+      ::curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME,
+                         this->InactivityTimeout);
+    }
+
+    if (!this->UserPwd.empty()) {
+      res = ::curl_easy_setopt(curl, CURLOPT_USERPWD, this->UserPwd.c_str());
+      check_curl_result(res, "DOWNLOAD_MANY cannot set user password: ");
+    }
+
+    ::curl_easy_setopt(curl, CURLOPT_HTTPHEADER, multi.Headers);
+
+    if (t.Offset > 0) {
+      res = ::curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, t.Offset);
+      check_curl_result(res, "DOWNLOAD_MANY cannot set resume offset: ");
+    }
+
+    if (::curl_multi_add_handle(multi.Multi, curl) != CURLM_OK) {
+      error = "DOWNLOAD_MANY cannot add transfer.";
+      return false;
+    }
+    t.Multi = multi.Multi;
+    return true;
+  };
+
+  std::deque<Transfer*> queue;
+  for (auto const& t : transfers) {
+    queue.push_back(t.get());
+  }
+  unsigned int const parallel = this->Parallel > 0 ? this->Parallel : 1;
+  size_t const total = transfers.size();
+  size_t done = 0;
+  unsigned int active = 0;
+  bool ok = true;
+  bool verified = true;
+  while (ok && (active > 0 || !queue.empty())) {
+    while (ok && active < parallel && !queue.empty()) {
+      Transfer* t = queue.front();
+      queue.pop_front();
+      ok = start(*t);
+      ++active;
+    }
+    if (!ok) {
+      break;
+    }
+
+    int running = 0;
+    ::curl_multi_perform(multi.Multi, &running);
+
+    int left = 0;
+    while (CURLMsg* msg = ::curl_multi_info_read(multi.Multi, &left)) {
+      if (msg->msg != CURLMSG_DONE) {
+        continue;
+      }
+      Transfer* t = nullptr;
+      ::curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &t);
+      ::CURLcode const result = msg->data.result;
+      ::curl_multi_remove_handle(multi.Multi, t->Easy);
+      t->Multi = nullptr;
+      t->Out.close();
+      --active;
+
+      // A partial file the server cannot continue is downloaded again.
+      long code = 0;
+      ::curl_easy_getinfo(t->Easy, CURLINFO_RESPONSE_CODE, &code);
+      if (result == CURLE_HTTP_RETURNED_ERROR && t->Offset > 0 &&
+          code == 416 && !t->Restarted) {
+        t->Restarted = true;
+        cmSystemTools::RemoveFile(t->PartFile);
+        queue.push_back(t);
+        continue;
+      }
+
+      bool restart = false;
+      if (!this->Finish(*t, result, restart, error)) {
+        verified = false;
+      }
+      if (restart) {
+        queue.push_back(t);
+        continue;
+      }
+      if (this->ShowProgress) {
+        this->Makefile->DisplayStatus(
+          cmStrCat("[download ", ++done, " of ", total, " complete]"), -1);
+      }
+    }
+
+    if (running > 0) {
+      ::curl_multi_wait(multi.Multi, nullptr, 0, 1000, nullptr);
+    }
+  }
+
+  // Transfers still running after an error keep their partial files.
+  transfers.clear();
+  return ok && verified;
+}
+
+bool cmFileDownloader::Finish(Transfer& t, int result, bool& restart,
+                              std::string& error)
+{
+  Item& item = t.Target;
+  ::CURLcode const res = static_cast<::CURLcode>(result);
+  item.Result = result;
+  item.Status = cmStrCat(result, ";\"", ::curl_easy_strerror(res), '"');
+
+  if (this->Log) {
+    this->LogText.append(t.Debug.begin(), t.Debug.end());
+  }
+
+  if (res != CURLE_OK) {
+    // Keep what was received of a file with a known hash so that a
+    // later attempt can continue where this one stopped.
+    if (!t.Hash || !t.Received) {
+      cmSystemTools::RemoveFile(t.PartFile);
+    }
+    return true;
+  }
+
+  if (t.Hash) {
+    std::string const actualHash = t.Hash->FinalizeHex();
+    if (actualHash != item.ExpectedHash) {
+      cmSystemTools::RemoveFile(t.PartFile);
+      // The partial file a transfer continued from may not belong to
+      // this file, so download the whole file once more.
+      if (t.Offset > 0 && !t.Restarted) {
+        t.Restarted = true;
+        restart = true;
+        return true;
+      }
+      item.Result = 1;
+      item.Status = cmStrCat("1;HASH mismatch: expected: ", item.ExpectedHash,
+                             " actual: ", actualHash);
+      if (error.empty()) {
+        error = cmStrCat("DOWNLOAD_MANY HASH mismatch\n"
+                         "  for file: [",
+                         item.File,
+                         "]\n"
+                         "    expected hash: [",
+                         item.ExpectedHash,
+                         "]\n"
+                         "      actual hash: [",
+                         actualHash,
+                         "]\n"
+                         "           status: [",
+                         result, ";\"", ::curl_easy_strerror(res), "\"]\n");
+      }
+      return false;
+    }
+  }
+
+  if (!cmSystemTools::RenameFile(t.PartFile, item.File)) {
+    if (error.empty()) {
+      error = cmStrCat("DOWNLOAD_MANY cannot rename\n  ", t.PartFile,
+                       "\nto\n  ", item.File);
+    }
+    return false;
+  }
+
+  if (t.Hash && !this->CacheDir.empty()) {
+    StoreInCache(this->CacheDir, item.Algo, item.ExpectedHash, item.File);
+  }
+  return true;
+}
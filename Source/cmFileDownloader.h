@@ -0,0 +1,92 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <vector>
+
+class cmMakefile;
+
+/** \class cmFileDownloader
+ * \brief Download a batch of files concurrently.
+ *
+ * All transfers run on one curl multi handle.  The content of each file
+ * is hashed as it arrives.  Files with an expected hash are received
+ * into a "<file>.part" file that a later run resumes if the transfer was
+ * interrupted, and may be taken from and added to a download cache in
+ * which files are named by their hash.
+ */
+class cmFileDownloader
+{
+public:
+  struct Item
+  {
+    std::string Url;
+    std::string File;
+    // Hash algorithm name as accepted by cmCryptoHash::New, or empty.
+    std::string Algo;
+    // Expected hash in lower-case hex digits.
+    std::string ExpectedHash;
+    std::string StatusVar;
+
+    // The curl result code and message of the transfer.
+    int Result = 0;
+    std::string Status;
+  };
+
+  cmFileDownloader(cmMakefile* mf);
+
+  // Settings shared by all transfers.
+  long Timeout = 0;
+  long InactivityTimeout = 0;
+  bool TlsVerify = false;
+  std::string CAInfo;
+  std::string NetrcLevel;
+  std::string NetrcFile;
+  std::string UserPwd;
+  std::vector<std::string> Headers;
+  bool ShowProgress = false;
+  bool Log = false;
+  unsigned int Parallel = 4;
+  std::string CacheDir;
+
+  std::vector<Item> Items;
+
+  /** Run all transfers.  Each item's result is stored in the item.
+      Returns false and sets 'error' if curl could not be set up, a file
+      could not be written, or a downloaded file did not have the
+      expected hash.  */
+  bool Run(std::string& error);
+
+  //! The log of all transfers if Log was set.
+  std::string const& GetLog() const { return this->LogText; }
+
+  //! Path of the file with the given hash in a download cache.
+  static std::string GetCachePath(std::string const& cacheDir,
+                                  std::string const& algo,
+                                  std::string const& hash);
+
+  /** Copy a file with the given hash from a download cache.  A cached
+      file that does not have the hash is removed.  */
+  static bool FetchFromCache(std::string const& cacheDir,
+                             std::string const& algo,
+                             std::string const& hash,
+                             std::string const& file);
+
+  //! Add a file known to have the given hash to a download cache.
+  static void StoreInCache(std::string const& cacheDir,
+                           std::string const& algo, std::string const& hash,
+                           std::string const& file);
+
+  //! State of one running transfer.
+  struct Transfer;
+
+private:
+  bool Finish(Transfer& t, int result, bool& restart,
+              std::string& error);
+
+  cmMakefile* Makefile;
+  std::string LogText;
+};
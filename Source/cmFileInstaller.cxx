@@ -3,26 +3,52 @@
 
 #include "cmFileInstaller.h"
 
+#include <algorithm>
+#include <memory>
+#include <set>
 #include <sstream>
 
+#include <cm/memory>
+#include <cmext/algorithm>
+
+#include "cmsys/FStream.hxx"
+
 #include "cm_sys_stat.h"
 
 #include "cmExecutionStatus.h"
 #include "cmFSPermissions.h"
 #include "cmMakefile.h"
+#include "cmProperty.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
 using namespace cmFSPermissions;
 
-cmFileInstaller::cmFileInstaller(cmExecutionStatus& status)
+struct cmFileInstaller::BulkInstall
+{
+  // Regular files of all rules written concurrently at the end.
+  WriteQueue Queue;
+
+  // Destination directories known to exist.
+  std::set<std::string> Directories;
+
+  // The install manifest updated by all rules.
+  std::string Manifest;
+
+  // Installers of the rules, which report their files at the end.
+  std::vector<std::unique_ptr<cmFileInstaller>> Installers;
+};
+
+cmFileInstaller::cmFileInstaller(cmExecutionStatus& status, BulkInstall* bulk)
   : cmFileCopier(status, "INSTALL")
+  , Bulk(bulk)
   , InstallType(cmInstallType_FILES)
   , Optional(false)
   , MessageAlways(false)
   , MessageLazy(false)
   , MessageNever(false)
   , DestDirLength(0)
+  , UseHardLinks(false)
 {
   // Installation does not use source permissions by default.
   this->UseSourcePermissions = false;
@@ -31,23 +57,36 @@ cmFileInstaller::cmFileInstaller(cmExecutionStatus& status)
   if (cmSystemTools::GetEnv("CMAKE_INSTALL_ALWAYS", install_always)) {
     this->Always = cmIsOn(install_always);
   }
-  // Get the current manifest.
-  this->Manifest =
-    this->Makefile->GetSafeDefinition("CMAKE_INSTALL_MANIFEST_FILES");
+  // Check whether to link files instead of copying them.  Hard links
+  // must be requested explicitly.
+  std::string const& useLinks =
+    this->Makefile->GetSafeDefinition("CMAKE_INSTALL_USE_LINKS");
+  this->UseHardLinks = useLinks == "HARDLINK";
+  this->UseLinks = this->UseHardLinks || cmIsOn(useLinks);
+  // Get the current manifest.  A bulk install updates it at the end.
+  if (this->Bulk) {
+    this->Queue = &this->Bulk->Queue;
+  } else {
+    this->Manifest =
+      this->Makefile->GetSafeDefinition("CMAKE_INSTALL_MANIFEST_FILES");
+  }
 }
 cmFileInstaller::~cmFileInstaller()
 {
   // Save the updated install manifest.
-  this->Makefile->AddDefinition("CMAKE_INSTALL_MANIFEST_FILES",
-                                this->Manifest);
+  if (!this->Bulk) {
+    this->Makefile->AddDefinition("CMAKE_INSTALL_MANIFEST_FILES",
+                                  this->Manifest);
+  }
 }
 
 void cmFileInstaller::ManifestAppend(std::string const& file)
 {
-  if (!this->Manifest.empty()) {
-    this->Manifest += ";";
+  std::string& manifest = this->Bulk ? this->Bulk->Manifest : this->Manifest;
+  if (!manifest.empty()) {
+    manifest += ";";
   }
-  this->Manifest += file.substr(this->DestDirLength);
+  manifest += file.substr(this->DestDirLength);
 }
 
 std::string const& cmFileInstaller::ToName(std::string const& fromName)
@@ -82,6 +121,28 @@ bool cmFileInstaller::Install(const std::string& fromFile,
   return this->cmFileCopier::Install(fromFile, toFile);
 }
 
+bool cmFileInstaller::MayHardLink() const
+{
+  if (!this->UseHardLinks) {
+    return false;
+  }
+  // Binaries may be modified after installation, e.g. by RPATH editing
+  // or stripping, so they must not share their inode with the file they
+  // are installed from.
+  switch (this->InstallType) {
+    case cmInstallType_EXECUTABLE:
+    case cmInstallType_STATIC_LIBRARY:
+    case cmInstallType_SHARED_LIBRARY:
+    case cmInstallType_MODULE_LIBRARY:
+    case cmInstallType_PROGRAMS:
+      return false;
+    case cmInstallType_FILES:
+    case cmInstallType_DIRECTORY:
+      break;
+  }
+  return true;
+}
+
 void cmFileInstaller::DefaultFilePermissions()
 {
   this->cmFileCopier::DefaultFilePermissions();
@@ -331,6 +392,11 @@ bool cmFileInstaller::HandleInstallDestination()
     return false;
   }
 
+  // Rules of a bulk install often share their destination.
+  if (this->Bulk && this->Bulk->Directories.count(destination)) {
+    return true;
+  }
+
   if (this->InstallType != cmInstallType_DIRECTORY) {
     if (!cmSystemTools::FileExists(destination)) {
       if (!cmSystemTools::MakeDirectory(destination, default_dir_mode)) {
@@ -346,6 +412,161 @@ bool cmFileInstaller::HandleInstallDestination()
       this->Status.SetError(errstring);
       return false;
     }
+    if (this->Bulk) {
+      this->Bulk->Directories.insert(destination);
+    }
+  }
+  return true;
+}
+
+namespace {
+struct cmFileInstallerBulkRule
+{
+  std::string Component;
+  bool ExcludeFromAll = false;
+  std::vector<std::string> Configurations;
+  std::string Destination;
+  std::vector<std::string> Options;
+  std::vector<std::string> Files;
+};
+
+bool cmFileInstallerReadBulkManifest(
+  std::string const& manifestFile, std::vector<cmFileInstallerBulkRule>& rules,
+  std::string& error)
+{
+  cmsys::ifstream fin(manifestFile.c_str());
+  if (!fin) {
+    error = cmStrCat("INSTALL cannot read bulk manifest \"", manifestFile,
+                     "\": ", cmSystemTools::GetLastSystemError(), '.');
+    return false;
+  }
+
+  cmFileInstallerBulkRule* rule = nullptr;
+  std::string line;
+  unsigned long lineNumber = 0;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    ++lineNumber;
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::string::size_type const space = line.find(' ');
+    std::string const key = line.substr(0, space);
+    std::string const value =
+      space == std::string::npos ? std::string() : line.substr(space + 1);
+    bool valid = true;
+    if (key == "rule") {
+      valid = !rule;
+      rules.emplace_back();
+      rule = &rules.back();
+    } else if (!rule) {
+      valid = false;
+    } else if (key == "end") {
+      valid = !rule->Destination.empty() && !rule->Files.empty();
+      rule = nullptr;
+    } else if (key == "component") {
+      rule->Component = value;
+    } else if (key == "exclude_from_all") {
+      rule->ExcludeFromAll = true;
+    } else if (key == "configuration") {
+      rule->Configurations.push_back(value);
+    } else if (key == "destination") {
+      rule->Destination = value;
+    } else if (key == "type") {
+      rule->Options.emplace_back("TYPE");
+      rule->Options.push_back(value);
+    } else if (key == "optional") {
+      rule->Options.emplace_back("OPTIONAL");
+    } else if (key == "message") {
+      rule->Options.push_back(cmStrCat("MESSAGE_", value));
+    } else if (key == "permissions") {
+      rule->Options.emplace_back("PERMISSIONS");
+      cm::append(rule->Options, cmTokenize(value, " "));
+    } else if (key == "rename") {
+      rule->Options.emplace_back("RENAME");
+      rule->Options.push_back(value);
+    } else if (key == "file") {
+      rule->Files.push_back(value);
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      error = cmStrCat("INSTALL given invalid bulk manifest \"", manifestFile,
+                       "\" at line ", lineNumber, ":\n  ", line);
+      return false;
+    }
+  }
+  if (rule) {
+    error = cmStrCat("INSTALL given truncated bulk manifest \"",
+                     manifestFile, "\".");
+    return false;
   }
   return true;
 }
+
+bool cmFileInstallerBulkRuleApplies(cmFileInstallerBulkRule const& rule,
+                                    std::string const& component,
+                                    std::string const& config)
+{
+  // Match the checks in the code of installation scripts.
+  if (rule.Component != component &&
+      (rule.ExcludeFromAll || !cmIsOff(component))) {
+    return false;
+  }
+  if (rule.Configurations.empty()) {
+    return true;
+  }
+  std::string const configUpper = cmSystemTools::UpperCase(config);
+  return std::any_of(rule.Configurations.begin(), rule.Configurations.end(),
+                     [&configUpper](std::string const& c) {
+                       return cmSystemTools::UpperCase(c) == configUpper;
+                     });
+}
+}
+
+bool cmFileInstaller::InstallBulkManifest(cmExecutionStatus& status,
+                                          std::string const& manifestFile)
+{
+  std::vector<cmFileInstallerBulkRule> rules;
+  std::string error;
+  if (!cmFileInstallerReadBulkManifest(manifestFile, rules, error)) {
+    status.SetError(error);
+    return false;
+  }
+
+  cmMakefile& mf = status.GetMakefile();
+  std::string const prefix = mf.GetSafeDefinition("CMAKE_INSTALL_PREFIX");
+  std::string const component =
+    mf.GetSafeDefinition("CMAKE_INSTALL_COMPONENT");
+  std::string const config = mf.GetSafeDefinition("CMAKE_INSTALL_CONFIG_NAME");
+
+  // Install the rules in order, but only collect the regular files.
+  BulkInstall bulk;
+  bulk.Manifest = mf.GetSafeDefinition("CMAKE_INSTALL_MANIFEST_FILES");
+  bool result = true;
+  for (cmFileInstallerBulkRule const& rule : rules) {
+    if (!cmFileInstallerBulkRuleApplies(rule, component, config)) {
+      continue;
+    }
+    std::vector<std::string> args;
+    args.reserve(rule.Options.size() + rule.Files.size() + 4);
+    args.emplace_back("INSTALL");
+    args.emplace_back("DESTINATION");
+    args.push_back(cmStrCat(prefix, '/', rule.Destination));
+    cm::append(args, rule.Options);
+    args.emplace_back("FILES");
+    cm::append(args, rule.Files);
+    bulk.Installers.emplace_back(
+      cm::make_unique<cmFileInstaller>(status, &bulk));
+    if (!bulk.Installers.back()->Run(args)) {
+      result = false;
+      break;
+    }
+  }
+
+  // Write the files and report everything as if installed serially.
+  if (!bulk.Queue.Finish()) {
+    result = false;
+  }
+  mf.AddDefinition("CMAKE_INSTALL_MANIFEST_FILES", bulk.Manifest);
+  return result;
+}
@@ -14,16 +14,27 @@ class cmExecutionStatus;
 
 struct cmFileInstaller : public cmFileCopier
 {
-  cmFileInstaller(cmExecutionStatus& status);
+  struct BulkInstall;
+
+  cmFileInstaller(cmExecutionStatus& status, BulkInstall* bulk = nullptr);
   ~cmFileInstaller() override;
 
+  /** Install the rules listed in a bulk install manifest written at
+      generate time.  Regular files are written concurrently.  */
+  static bool InstallBulkManifest(cmExecutionStatus& status,
+                                  std::string const& manifestFile);
+
 protected:
+  // State shared by the installers of the rules of a bulk manifest.
+  BulkInstall* Bulk;
+
   cmInstallType InstallType;
   bool Optional;
   bool MessageAlways;
   bool MessageLazy;
   bool MessageNever;
   int DestDirLength;
+  bool UseHardLinks;
   std::string Rename;
 
   std::string Manifest;
@@ -35,6 +46,7 @@ protected:
   bool ReportMissing(const std::string& fromFile) override;
   bool Install(const std::string& fromFile,
                const std::string& toFile) override;
+  bool MayHardLink() const override;
 
   bool Parse(std::vector<std::string> const& args) override;
   enum
@@ -2,8 +2,19 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmGeneratedFileStream.h"
 
+#include <cerrno>
 #include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <streambuf>
+#include <unordered_map>
+#include <utility>
 
+#include <cm/memory>
+
+#include "cmCryptoHash.h"
+#include "cmFileTime.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
@@ -13,6 +24,117 @@
 #  include "cm_codecvt.hxx"
 #endif
 
+namespace {
+struct ManifestEntry
+{
+  unsigned long Size = 0;
+  cmFileTime::TimeType Time = 0;
+  std::string Hash;
+};
+
+// The manifest of files generated with copy-if-different.  Entries are
+// looked up from the previous run and recorded for the next one.
+struct Manifest
+{
+  std::mutex Mutex;
+  std::string File;
+  bool Active = false;
+  std::unordered_map<std::string, ManifestEntry> Previous;
+  std::map<std::string, ManifestEntry> Current;
+};
+
+Manifest& GetManifest()
+{
+  static Manifest manifest;
+  return manifest;
+}
+
+bool IsManifestActive()
+{
+  Manifest& manifest = GetManifest();
+  std::lock_guard<std::mutex> lock(manifest.Mutex);
+  return manifest.Active;
+}
+
+bool ParseTime(std::string const& str, cmFileTime::TimeType* value)
+{
+  errno = 0;
+  char* endp;
+  *value = strtoll(str.c_str(), &endp, 10);
+  return (*endp == '\0') && (endp != str.c_str()) && (errno == 0);
+}
+
+bool LoadEntry(std::string const& file, ManifestEntry& entry)
+{
+  cmFileTime fileTime;
+  if (!fileTime.Load(file)) {
+    return false;
+  }
+  entry.Time = fileTime.GetTime();
+  entry.Size = cmSystemTools::FileLength(file);
+  return true;
+}
+}
+
+// Forwards the content written to the stream to the file buffer and
+// hashes it on the way.
+class cmGeneratedFileStream::HashBuf : public std::streambuf
+{
+public:
+  HashBuf(std::streambuf* sink)
+    : Sink(sink)
+    , Hash(cmCryptoHash::AlgoMD5)
+  {
+    this->Hash.Initialize();
+    this->setp(this->Buffer, this->Buffer + sizeof(this->Buffer));
+  }
+
+  std::streambuf* GetSink() const { return this->Sink; }
+
+  std::string Finalize() { return this->Hash.FinalizeHex(); }
+
+protected:
+  int_type overflow(int_type c) override
+  {
+    if (!this->Forward()) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *this->pptr() = traits_type::to_char_type(c);
+      this->pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() override
+  {
+    if (!this->Forward()) {
+      return -1;
+    }
+    return this->Sink->pubsync();
+  }
+
+  void imbue(std::locale const& loc) override { this->Sink->pubimbue(loc); }
+
+private:
+  bool Forward()
+  {
+    std::streamsize const n = this->pptr() - this->pbase();
+    if (n > 0) {
+      this->Hash.Append(this->pbase(), static_cast<size_t>(n));
+      if (this->Sink->sputn(this->pbase(), n) != n) {
+        return false;
+      }
+      this->pbump(static_cast<int>(-n));
+    }
+    return true;
+  }
+
+  std::streambuf* Sink;
+  cmCryptoHash Hash;
+  char Buffer[4096];
+};
+
 cmGeneratedFileStream::cmGeneratedFileStream(Encoding encoding)
   : OriginalLocale(this->getloc())
 {
@@ -51,6 +173,7 @@ cmGeneratedFileStream::~cmGeneratedFileStream()
   // stream will be destroyed which will close the temporary file.
   // Finally the base destructor will be called to replace the
   // destination file.
+  this->FinishContentHash();
   this->Okay = !this->fail();
 }
 
@@ -73,12 +196,16 @@ cmGeneratedFileStream& cmGeneratedFileStream::Open(std::string const& name,
     cmSystemTools::Error("Cannot open file for write: " + this->TempName);
     cmSystemTools::ReportLastSystemError("");
   }
+  if (this->CopyIfDifferent) {
+    this->StartContentHash();
+  }
   return *this;
 }
 
 bool cmGeneratedFileStream::Close()
 {
   // Save whether the temporary output file is valid before closing.
+  this->FinishContentHash();
   this->Okay = !this->fail();
 
   // Close the temporary output file.
@@ -91,6 +218,40 @@ bool cmGeneratedFileStream::Close()
 void cmGeneratedFileStream::SetCopyIfDifferent(bool copy_if_different)
 {
   this->CopyIfDifferent = copy_if_different;
+  if (copy_if_different) {
+    this->StartContentHash();
+  } else {
+    this->FinishContentHash();
+    this->ContentHash.clear();
+  }
+}
+
+void cmGeneratedFileStream::StartContentHash()
+{
+  // Hash only if the hash can be used and covers the whole content.
+  if (this->ContentHashBuf || this->Compress || !*this ||
+      !this->Stream::is_open() || !IsManifestActive() ||
+      this->Stream::rdbuf()->pubseekoff(0, std::ios::cur, std::ios::out) !=
+        std::streampos(0)) {
+    return;
+  }
+  this->ContentHash.clear();
+  this->ContentHashBuf = cm::make_unique<HashBuf>(this->Stream::rdbuf());
+  this->std::ostream::rdbuf(this->ContentHashBuf.get());
+}
+
+void cmGeneratedFileStream::FinishContentHash()
+{
+  if (!this->ContentHashBuf) {
+    return;
+  }
+  this->flush();
+  // Restoring the file buffer resets the stream state, so keep it.
+  std::ios::iostate const state = this->rdstate();
+  this->std::ostream::rdbuf(this->ContentHashBuf->GetSink());
+  this->clear(state);
+  this->ContentHash = this->ContentHashBuf->Finalize();
+  this->ContentHashBuf.reset();
 }
 
 void cmGeneratedFileStream::SetCompression(bool compression)
@@ -154,8 +315,7 @@ bool cmGeneratedFileStreamBase::Close()
   // Only consider replacing the destination file if no error
   // occurred.
   if (!this->Name.empty() && this->Okay &&
-      (!this->CopyIfDifferent ||
-       cmSystemTools::FilesDiffer(this->TempName, resname))) {
+      (!this->CopyIfDifferent || this->ContentDiffers(resname))) {
     // The destination is to be replaced.  Rename the temporary to the
     // destination atomically.
     if (this->Compress) {
@@ -176,9 +336,46 @@ bool cmGeneratedFileStreamBase::Close()
   // Always delete the temporary file. We never want it to stay around.
   cmSystemTools::RemoveFile(this->TempName);
 
+  // Record the content of the destination for the next run.
+  if (!this->ContentHash.empty() && this->Okay) {
+    ManifestEntry entry;
+    if (LoadEntry(resname, entry)) {
+      entry.Hash = std::move(this->ContentHash);
+      Manifest& manifest = GetManifest();
+      std::lock_guard<std::mutex> lock(manifest.Mutex);
+      if (manifest.Active) {
+        manifest.Current[resname] = std::move(entry);
+      }
+    }
+  }
+  this->ContentHash.clear();
+
   return replaced;
 }
 
+bool cmGeneratedFileStreamBase::ContentDiffers(std::string const& resname)
+{
+  if (!this->ContentHash.empty()) {
+    ManifestEntry previous;
+    {
+      Manifest& manifest = GetManifest();
+      std::lock_guard<std::mutex> lock(manifest.Mutex);
+      auto it = manifest.Previous.find(resname);
+      if (it != manifest.Previous.end()) {
+        previous = it->second;
+      }
+    }
+    // If the destination is still the file recorded by the previous
+    // run, its hash tells whether it differs without reading it.
+    ManifestEntry current;
+    if (!previous.Hash.empty() && LoadEntry(resname, current) &&
+        current.Size == previous.Size && current.Time == previous.Time) {
+      return previous.Hash != this->ContentHash;
+    }
+  }
+  return cmSystemTools::FilesDiffer(this->TempName, resname);
+}
+
 #ifndef CMAKE_BOOTSTRAP
 int cmGeneratedFileStreamBase::CompressFile(std::string const& oldname,
                                             std::string const& newname)
@@ -240,3 +437,63 @@ void cmGeneratedFileStream::WriteRaw(std::string const& data)
   this->write(data.data(), data.size());
 #endif
 }
+
+void cmGeneratedFileStream::LoadManifest(std::string const& file)
+{
+  Manifest& manifest = GetManifest();
+  std::lock_guard<std::mutex> lock(manifest.Mutex);
+  manifest.File = file;
+  manifest.Active = true;
+  manifest.Previous.clear();
+  manifest.Current.clear();
+
+  // Each line holds the hash, size, modification time and path of a file.
+  cmsys::ifstream fin(file.c_str());
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    std::string::size_type const hashEnd = line.find(' ');
+    std::string::size_type const sizeEnd = line.find(' ', hashEnd + 1);
+    std::string::size_type const timeEnd = line.find(' ', sizeEnd + 1);
+    if (hashEnd == std::string::npos || sizeEnd == std::string::npos ||
+        timeEnd == std::string::npos) {
+      continue;
+    }
+    ManifestEntry entry;
+    if (!cmStrToULong(line.substr(hashEnd + 1, sizeEnd - hashEnd - 1),
+                      &entry.Size) ||
+        !ParseTime(line.substr(sizeEnd + 1, timeEnd - sizeEnd - 1),
+                   &entry.Time)) {
+      continue;
+    }
+    entry.Hash = line.substr(0, hashEnd);
+    manifest.Previous.emplace(line.substr(timeEnd + 1), std::move(entry));
+  }
+}
+
+void cmGeneratedFileStream::WriteManifest()
+{
+  Manifest& manifest = GetManifest();
+  std::lock_guard<std::mutex> lock(manifest.Mutex);
+  if (!manifest.Active) {
+    return;
+  }
+  manifest.Active = false;
+  manifest.Previous.clear();
+
+  std::string const tempName = cmStrCat(manifest.File, ".tmp");
+  {
+    cmsys::ofstream fout(tempName.c_str());
+    for (auto const& e : manifest.Current) {
+      fout << e.second.Hash << ' ' << e.second.Size << ' ' << e.second.Time
+           << ' ' << e.first << '\n';
+    }
+    if (!fout) {
+      fout.close();
+      cmSystemTools::RemoveFile(tempName);
+      manifest.Current.clear();
+      return;
+    }
+  }
+  cmSystemTools::RenameFile(tempName, manifest.File);
+  manifest.Current.clear();
+}
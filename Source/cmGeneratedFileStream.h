@@ -4,6 +4,7 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <memory>
 #include <string>
 
 #include "cmsys/FStream.hxx"
@@ -39,6 +40,10 @@ protected:
   // Internal file compression implementation.
   int CompressFile(std::string const& oldname, std::string const& newname);
 
+  // Internal copy-if-different check of the temporary file against the
+  // destination, using the manifest of generated files if possible.
+  bool ContentDiffers(std::string const& resname);
+
   // The name of the final destination file for the output.
   std::string Name;
 
@@ -59,6 +64,8 @@ protected:
 
   // Whether the destination file is compressed
   bool CompressExtraExtension = true;
+  // The hash of the content written, if it was computed while streaming.
+  std::string ContentHash;
 };
 
 /** \class cmGeneratedFileStream
@@ -153,7 +160,30 @@ public:
    */
   void WriteRaw(std::string const& data);
 
+  /**
+   * Load the manifest of files generated with copy-if-different by a
+   * previous run from the given file.  Until WriteManifest is called,
+   * such files are hashed while they are written, and the manifest is
+   * used to decide whether their destination differs without reading
+   * it back.
+   */
+  static void LoadManifest(std::string const& file);
+
+  /**
+   * Write the manifest of the files generated with copy-if-different
+   * since LoadManifest was called, and stop recording them.
+   */
+  static void WriteManifest();
+
 private:
+  class HashBuf;
+
+  // Start or stop hashing the content written to the stream.
+  void StartContentHash();
+  void FinishContentHash();
+
   // The original locale of the stream (performs no encoding conversion).
   std::locale OriginalLocale;
+  // Computes the hash of the content while forwarding it to the file.
+  std::unique_ptr<HashBuf> ContentHashBuf;
 };
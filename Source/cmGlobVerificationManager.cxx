@@ -2,9 +2,13 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmGlobVerificationManager.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <sstream>
+#include <utility>
 
 #include "cmsys/FStream.hxx"
+#include "cmsys/Glob.hxx"
 
 #include "cmGeneratedFileStream.h"
 #include "cmListFileCache.h"
@@ -12,7 +16,153 @@
 #include "cmSystemTools.h"
 #include "cmVersion.h"
 
-bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path)
+namespace {
+// A glob saved to the verification index.
+struct cmGlobIndexEntry
+{
+  bool Recurse = false;
+  bool ListDirectories = false;
+  bool FollowSymlinks = false;
+  std::string Relative;
+  std::string Expression;
+  std::vector<std::string> Files;
+  std::vector<cmGlobWalker::Stamp> Stamps;
+};
+
+bool cmGlobIndexIsLine(std::string const& str)
+{
+  return str.find_first_of("\r\n") == std::string::npos;
+}
+
+bool cmGlobIndexCanSave(cmGlobIndexEntry const& entry)
+{
+  return cmGlobIndexIsLine(entry.Relative) &&
+    cmGlobIndexIsLine(entry.Expression) &&
+    std::all_of(entry.Files.begin(), entry.Files.end(), cmGlobIndexIsLine) &&
+    std::all_of(entry.Stamps.begin(), entry.Stamps.end(),
+                [](cmGlobWalker::Stamp const& stamp) {
+                  return cmGlobIndexIsLine(stamp.Path) &&
+                    cmGlobIndexIsLine(stamp.Value);
+                });
+}
+
+void cmGlobIndexSave(std::ostream& os,
+                     std::vector<cmGlobIndexEntry> const& entries)
+{
+  os << "# CMAKE generated file: DO NOT EDIT!\n";
+  for (cmGlobIndexEntry const& entry : entries) {
+    os << "glob\n";
+    os << "recurse " << entry.Recurse << "\n";
+    os << "list_directories " << entry.ListDirectories << "\n";
+    os << "follow_symlinks " << entry.FollowSymlinks << "\n";
+    if (!entry.Relative.empty()) {
+      os << "relative " << entry.Relative << "\n";
+    }
+    os << "expression " << entry.Expression << "\n";
+    for (std::string const& file : entry.Files) {
+      os << "file " << file << "\n";
+    }
+    for (cmGlobWalker::Stamp const& stamp : entry.Stamps) {
+      switch (stamp.Kind) {
+        case cmGlobWalker::Stamp::Directory:
+          os << "directory " << stamp.MTime << " " << stamp.Value << " "
+             << stamp.Path << "\n";
+          break;
+        case cmGlobWalker::Stamp::Unreadable:
+          os << "unreadable " << stamp.Path << "\n";
+          break;
+        case cmGlobWalker::Stamp::Symlink:
+          os << "symlink " << stamp.Path << "\n";
+          os << "value " << stamp.Value << "\n";
+          break;
+      }
+    }
+    os << "end\n";
+  }
+}
+
+bool cmGlobIndexLoad(std::string const& indexFile,
+                     std::vector<cmGlobIndexEntry>& entries)
+{
+  cmsys::ifstream fin(indexFile.c_str());
+  if (!fin) {
+    return false;
+  }
+  cmGlobIndexEntry* entry = nullptr;
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::string::size_type const space = line.find(' ');
+    std::string const key = line.substr(0, space);
+    std::string const value =
+      space == std::string::npos ? std::string() : line.substr(space + 1);
+    if (key == "glob") {
+      if (entry) {
+        return false;
+      }
+      entries.emplace_back();
+      entry = &entries.back();
+      continue;
+    }
+    if (!entry) {
+      return false;
+    }
+    if (key == "end") {
+      entry = nullptr;
+    } else if (key == "recurse") {
+      entry->Recurse = value == "1";
+    } else if (key == "list_directories") {
+      entry->ListDirectories = value == "1";
+    } else if (key == "follow_symlinks") {
+      entry->FollowSymlinks = value == "1";
+    } else if (key == "relative") {
+      entry->Relative = value;
+    } else if (key == "expression") {
+      entry->Expression = value;
+    } else if (key == "file") {
+      entry->Files.push_back(value);
+    } else if (key == "directory") {
+      std::string::size_type const hash = value.find(' ');
+      std::string::size_type const path = hash == std::string::npos
+        ? std::string::npos
+        : value.find(' ', hash + 1);
+      if (path == std::string::npos) {
+        return false;
+      }
+      cmGlobWalker::Stamp stamp;
+      stamp.Kind = cmGlobWalker::Stamp::Directory;
+      stamp.MTime = std::strtoll(value.c_str(), nullptr, 10);
+      stamp.Value = value.substr(hash + 1, path - hash - 1);
+      stamp.Path = value.substr(path + 1);
+      entry->Stamps.emplace_back(std::move(stamp));
+    } else if (key == "unreadable") {
+      cmGlobWalker::Stamp stamp;
+      stamp.Kind = cmGlobWalker::Stamp::Unreadable;
+      stamp.Path = value;
+      entry->Stamps.emplace_back(std::move(stamp));
+    } else if (key == "symlink") {
+      cmGlobWalker::Stamp stamp;
+      stamp.Kind = cmGlobWalker::Stamp::Symlink;
+      stamp.Path = value;
+      entry->Stamps.emplace_back(std::move(stamp));
+    } else if (key == "value") {
+      if (entry->Stamps.empty() ||
+          entry->Stamps.back().Kind != cmGlobWalker::Stamp::Symlink) {
+        return false;
+      }
+      entry->Stamps.back().Value = value;
+    } else {
+      return false;
+    }
+  }
+  return !entry;
+}
+}
+
+bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path,
+                                                       bool useIndex)
 {
   if (this->Cache.empty()) {
     return true;
@@ -20,9 +170,11 @@ bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path)
 
   std::string scriptFile = cmStrCat(path, "/CMakeFiles");
   std::string stampFile = scriptFile;
+  std::string indexFile = scriptFile;
   cmSystemTools::MakeDirectory(scriptFile);
   scriptFile += "/VerifyGlobs.cmake";
   stampFile += "/cmake.verify_globs";
+  indexFile += "/VerifyGlobs.index";
   cmGeneratedFileStream verifyScriptFile(scriptFile);
   verifyScriptFile.SetCopyIfDifferent(true);
   if (!verifyScriptFile) {
@@ -40,6 +192,7 @@ bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path)
 
   verifyScriptFile << "cmake_policy(SET CMP0009 NEW)\n";
 
+  std::vector<cmGlobIndexEntry> indexEntries;
   for (auto const& i : this->Cache) {
     CacheEntryKey k = std::get<0>(i);
     CacheEntryValue v = std::get<1>(i);
@@ -48,6 +201,21 @@ bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path)
       continue;
     }
 
+    if (useIndex && v.Stamped) {
+      cmGlobIndexEntry entry;
+      entry.Recurse = k.Recurse;
+      entry.ListDirectories = k.ListDirectories;
+      entry.FollowSymlinks = k.FollowSymlinks;
+      entry.Relative = k.Relative;
+      entry.Expression = k.Expression;
+      entry.Files = v.Files;
+      entry.Stamps = v.Stamps;
+      if (cmGlobIndexCanSave(entry)) {
+        indexEntries.emplace_back(std::move(entry));
+        continue;
+      }
+    }
+
     verifyScriptFile << "\n";
 
     for (auto const& bt : v.Backtraces) {
@@ -70,6 +238,29 @@ bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path)
                      << "  file(TOUCH_NOCREATE \"" << stampFile << "\")\n"
                      << "endif()\n";
   }
+
+  if (!indexEntries.empty()) {
+    cmGeneratedFileStream indexStream(indexFile);
+    if (!indexStream) {
+      cmSystemTools::Error("Unable to open glob verification index for "
+                           "save. " +
+                           indexFile);
+      cmSystemTools::ReportLastSystemError("");
+      return false;
+    }
+    cmGlobIndexSave(indexStream, indexEntries);
+
+    verifyScriptFile << "\n"
+                     << "# Globs checked with the stamps in the index.\n"
+                     << "file(_CMAKE_GLOB_VERIFY_INDEX \"" << indexFile
+                     << "\" INDEX_CHANGED)\n"
+                     << "if(INDEX_CHANGED)\n"
+                     << "  message(\"-- GLOB mismatch!\")\n"
+                     << "  file(TOUCH_NOCREATE \"" << stampFile << "\")\n"
+                     << "endif()\n";
+  } else {
+    cmSystemTools::RemoveFile(indexFile);
+  }
   verifyScriptFile.Close();
 
   cmsys::ofstream verifyStampFile(stampFile.c_str());
@@ -145,7 +336,7 @@ void cmGlobVerificationManager::AddCacheEntry(
   const bool recurse, const bool listDirectories, const bool followSymlinks,
   const std::string& relative, const std::string& expression,
   const std::vector<std::string>& files, const std::string& variable,
-  const cmListFileBacktrace& backtrace)
+  const cmListFileBacktrace& backtrace, const cmGlobWalker* walker)
 {
   CacheEntryKey key = CacheEntryKey(recurse, listDirectories, followSymlinks,
                                     relative, expression);
@@ -153,6 +344,10 @@ void cmGlobVerificationManager::AddCacheEntry(
   if (!value.Initialized) {
     value.Files = files;
     value.Initialized = true;
+    if (walker) {
+      value.Stamped = true;
+      value.Stamps = walker->GetStamps();
+    }
     value.Backtraces.emplace_back(variable, backtrace);
   } else if (value.Initialized && value.Files != files) {
     std::ostringstream message;
@@ -179,3 +374,58 @@ void cmGlobVerificationManager::Reset()
   this->VerifyScript.clear();
   this->VerifyStamp.clear();
 }
+
+bool cmGlobVerificationManager::VerificationIndexChanged(
+  const std::string& indexFile)
+{
+  std::vector<cmGlobIndexEntry> entries;
+  if (!cmGlobIndexLoad(indexFile, entries)) {
+    return true;
+  }
+
+  bool updated = false;
+  for (cmGlobIndexEntry& entry : entries) {
+    if (!cmGlobWalker::StampsChanged(entry.Stamps, updated)) {
+      continue;
+    }
+
+    // Evaluate the glob again, as the verification script would.
+    cmsys::Glob g;
+    g.SetRecurse(entry.Recurse);
+    g.SetListDirs(entry.ListDirectories);
+    g.SetRecurseListDirs(entry.ListDirectories);
+    g.SetRecurseThroughSymlinks(entry.FollowSymlinks);
+    if (!entry.Relative.empty()) {
+      g.SetRelative(entry.Relative.c_str());
+    }
+    cmGlobWalker walker(g);
+    walker.SetRecordStamps(true);
+    cmsys::Glob::GlobMessages messages;
+    walker.FindFiles(entry.Expression, &messages);
+    if (std::any_of(messages.begin(), messages.end(),
+                    [](cmsys::Glob::Message const& m) {
+                      return m.type == cmsys::Glob::error;
+                    })) {
+      return true;
+    }
+    std::vector<std::string> files = walker.GetFiles();
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    if (files != entry.Files) {
+      return true;
+    }
+
+    // Nothing changed that matters to this glob.  Keep its new stamps to
+    // avoid evaluating it again.
+    entry.Stamps = walker.GetStamps();
+    updated = true;
+  }
+
+  if (updated) {
+    cmGeneratedFileStream indexStream(indexFile);
+    if (indexStream) {
+      cmGlobIndexSave(indexStream, entries);
+    }
+  }
+  return false;
+}
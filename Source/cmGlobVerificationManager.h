@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 
+#include "cmGlobWalker.h"
 #include "cmListFileCache.h"
 
 /** \class cmGlobVerificationManager
@@ -20,10 +21,18 @@
  */
 class cmGlobVerificationManager
 {
+public:
+  //! Check the globs saved to a verification index.  Only globs that
+  //! looked at something that changed are evaluated again.  Returns
+  //! true if any of their results changed or the index cannot be read.
+  static bool VerificationIndexChanged(const std::string& indexFile);
+
 protected:
   //! Save verification script for given makefile.
   //! Saves to output <path>/<CMakeFilesDirectory>/VerifyGlobs.cmake
-  bool SaveVerificationScript(const std::string& path);
+  //! With 'useIndex', globs evaluated by a walker are saved with its
+  //! stamps to <path>/<CMakeFilesDirectory>/VerifyGlobs.index instead.
+  bool SaveVerificationScript(const std::string& path, bool useIndex);
 
   //! Add an entry into the glob cache
   void AddCacheEntry(bool recurse, bool listDirectories, bool followSymlinks,
@@ -31,7 +40,8 @@ protected:
                      const std::string& expression,
                      const std::vector<std::string>& files,
                      const std::string& variable,
-                     const cmListFileBacktrace& bt);
+                     const cmListFileBacktrace& bt,
+                     const cmGlobWalker* walker);
 
   //! Clear the glob cache for state reset.
   void Reset();
@@ -69,6 +79,9 @@ private:
     bool Initialized = false;
     std::vector<std::string> Files;
     std::vector<std::pair<std::string, cmListFileBacktrace>> Backtraces;
+    // Whether the stamps of a walker were recorded.
+    bool Stamped = false;
+    std::vector<cmGlobWalker::Stamp> Stamps;
   };
 
   using CacheEntryMap = std::map<CacheEntryKey, CacheEntryValue>;
@@ -0,0 +1,608 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmGlobWalker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+#if !defined(CMAKE_BOOTSTRAP)
+#  include <thread>
+#endif
+
+#include <cm3p/uv.h>
+
+#include "cmsys/RegularExpression.hxx"
+#include "cmsys/SystemTools.hxx"
+
+#include "cm_sys_stat.h"
+
+#include "cmCryptoHash.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+#if defined(_WIN32) || defined(__APPLE__)
+// File names are matched case-insensitively, as cmsys::Glob does.
+#  define CM_GLOB_WALKER_CASE_INDEPENDENT
+#endif
+
+namespace {
+
+// A directory modified this recently may still be modified again without
+// a change of its modification time.
+long long const cmGlobWalkerRacyNs = 2000000000;
+
+struct cmGlobWalkerEntry
+{
+  std::string Name;
+  // 'd'irectory, 'l'ink, 'f'ile or 'o'ther.
+  char Type;
+};
+
+bool cmGlobWalkerStat(std::string const& path, bool followSymlinks,
+                      uv_stat_t& st)
+{
+  uv_fs_t req;
+  int const err = followSymlinks
+    ? uv_fs_stat(nullptr, &req, path.c_str(), nullptr)
+    : uv_fs_lstat(nullptr, &req, path.c_str(), nullptr);
+  if (err == 0) {
+    st = req.statbuf;
+  }
+  uv_fs_req_cleanup(&req);
+  return err == 0;
+}
+
+bool cmGlobWalkerIsDirectory(std::string const& path)
+{
+  uv_stat_t st;
+  return cmGlobWalkerStat(path, true, st) && (st.st_mode & S_IFMT) == S_IFDIR;
+}
+
+std::string cmGlobWalkerJoin(std::string const& dir, std::string const& name)
+{
+  // Only the directory a walk starts in ends in a slash.
+  if (!dir.empty() && dir.back() == '/') {
+    return dir + name;
+  }
+  return cmStrCat(dir, '/', name);
+}
+
+bool cmGlobWalkerReadDirectory(std::string const& dir,
+                               std::vector<cmGlobWalkerEntry>& entries,
+                               std::string& error)
+{
+  uv_fs_t req;
+  int const err = uv_fs_scandir(nullptr, &req, dir.c_str(), 0, nullptr);
+  if (err < 0) {
+    error = uv_strerror(err);
+    uv_fs_req_cleanup(&req);
+    return false;
+  }
+  uv_dirent_t dent;
+  while (uv_fs_scandir_next(&req, &dent) != UV_EOF) {
+    cmGlobWalkerEntry entry;
+    entry.Name = dent.name;
+    switch (dent.type) {
+      case UV_DIRENT_DIR:
+        entry.Type = 'd';
+        break;
+      case UV_DIRENT_LINK:
+        entry.Type = 'l';
+        break;
+      case UV_DIRENT_FILE:
+        entry.Type = 'f';
+        break;
+      case UV_DIRENT_UNKNOWN: {
+        // The file system does not report types in directory entries.
+        uv_stat_t st;
+        entry.Type = 'o';
+        if (cmGlobWalkerStat(cmGlobWalkerJoin(dir, entry.Name), false, st)) {
+          switch (st.st_mode & S_IFMT) {
+            case S_IFDIR:
+              entry.Type = 'd';
+              break;
+            case S_IFLNK:
+              entry.Type = 'l';
+              break;
+            case S_IFREG:
+              entry.Type = 'f';
+              break;
+            default:
+              break;
+          }
+        }
+      } break;
+      default:
+        entry.Type = 'o';
+        break;
+    }
+    entries.emplace_back(std::move(entry));
+  }
+  uv_fs_req_cleanup(&req);
+  std::sort(entries.begin(), entries.end(),
+            [](cmGlobWalkerEntry const& l, cmGlobWalkerEntry const& r) {
+              return l.Name < r.Name;
+            });
+  return true;
+}
+
+std::string cmGlobWalkerHash(std::vector<cmGlobWalkerEntry> const& entries)
+{
+  cmCryptoHash hash(cmCryptoHash::AlgoSHA1);
+  hash.Initialize();
+  for (cmGlobWalkerEntry const& entry : entries) {
+    // Names cannot contain a slash, so this separates them unambiguously.
+    hash.Append(entry.Name);
+    char const sep[2] = { '/', entry.Type };
+    hash.Append(sep, sizeof(sep));
+  }
+  return cmCryptoHash::ByteHashToString(hash.Finalize());
+}
+
+long long cmGlobWalkerTrustedMTime(uv_stat_t const& st)
+{
+  long long const mtime =
+    static_cast<long long>(st.st_mtim.tv_sec) * 1000000000 +
+    st.st_mtim.tv_nsec;
+  long long const now =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch())
+      .count();
+  return now - mtime < cmGlobWalkerRacyNs ? 0 : mtime;
+}
+
+std::string cmGlobWalkerSymlinkValue(std::string const& path, bool isDir)
+{
+  std::string value;
+  uv_fs_t req;
+  if (uv_fs_readlink(nullptr, &req, path.c_str(), nullptr) == 0) {
+    value = static_cast<char const*>(req.ptr);
+  }
+  uv_fs_req_cleanup(&req);
+  if (isDir) {
+    value += '/';
+  }
+  return value;
+}
+
+using cmGlobWalkerOrder = std::vector<size_t>;
+}
+
+// State of one walk shared by the threads reading directories.
+struct cmGlobWalker::Walk
+{
+  struct Task
+  {
+    std::string Dir;
+    // Position in the depth-first traversal done by cmsys::Glob.
+    cmGlobWalkerOrder Order;
+    std::vector<std::string> VisitedSymlinks;
+  };
+  struct OrderedMessage
+  {
+    cmGlobWalkerOrder Order;
+    cmsys::Glob::Message Message;
+  };
+  struct Results
+  {
+    std::vector<Task> Tasks;
+    std::vector<std::string> Files;
+    std::vector<OrderedMessage> Messages;
+    std::vector<Stamp> Stamps;
+    bool Failed = false;
+  };
+
+  Walk(cmGlobWalker const& walker, std::string const& pattern)
+    : Walker(walker)
+    , Regex(cmsys::Glob::PatternToRegex(pattern))
+  {
+  }
+
+  cmGlobWalker const& Walker;
+  cmsys::RegularExpression const Regex;
+  std::atomic<unsigned int> FollowedSymlinks{ 0 };
+
+  std::mutex Mutex;
+  std::condition_variable Wake;
+  std::vector<Task> Tasks;
+  size_t Busy = 0;
+  Results Found;
+
+  bool Matches(std::string const& name) const;
+  Stamp StampDirectory(std::string const& dir, uv_stat_t const* st,
+                       std::vector<cmGlobWalkerEntry> const& entries) const;
+  void ListDirectory(std::string const& dir, Results& results) const;
+  void RecurseDirectory(Task const& task, Results& results);
+  void Merge(Results&& results);
+  void Work();
+  void Run(Task root);
+};
+
+bool cmGlobWalker::Walk::Matches(std::string const& name) const
+{
+  cmsys::RegularExpressionMatch match;
+  return this->Regex.find(name.c_str(), match);
+}
+
+cmGlobWalker::Stamp cmGlobWalker::Walk::StampDirectory(
+  std::string const& dir, uv_stat_t const* st,
+  std::vector<cmGlobWalkerEntry> const& entries) const
+{
+  Stamp stamp;
+  stamp.Kind = Stamp::Directory;
+  stamp.Path = dir;
+  stamp.MTime = st ? cmGlobWalkerTrustedMTime(*st) : 0;
+  stamp.Value = cmGlobWalkerHash(entries);
+  return stamp;
+}
+
+void cmGlobWalker::Walk::ListDirectory(std::string const& dir,
+                                       Results& results) const
+{
+  // Like cmsys::Glob::ProcessDirectory for the last path component.
+  bool const record = this->Walker.RecordStamps;
+  uv_stat_t st;
+  bool const stated = record && cmGlobWalkerStat(dir, true, st);
+  std::vector<cmGlobWalkerEntry> entries;
+  std::string error;
+  if (!cmGlobWalkerReadDirectory(dir, entries, error)) {
+    if (record) {
+      Stamp stamp;
+      stamp.Kind = Stamp::Unreadable;
+      stamp.Path = dir;
+      results.Stamps.emplace_back(std::move(stamp));
+    }
+    return;
+  }
+  if (record) {
+    results.Stamps.emplace_back(
+      this->StampDirectory(dir, stated ? &st : nullptr, entries));
+  }
+
+  for (cmGlobWalkerEntry const& entry : entries) {
+    std::string realname = cmGlobWalkerJoin(dir, entry.Name);
+#ifdef CM_GLOB_WALKER_CASE_INDEPENDENT
+    std::string const fname = cmSystemTools::LowerCase(entry.Name);
+#else
+    std::string const& fname = entry.Name;
+#endif
+    bool isDir = entry.Type == 'd';
+    if (entry.Type == 'l') {
+      isDir = cmGlobWalkerIsDirectory(realname);
+      if (record) {
+        Stamp stamp;
+        stamp.Kind = Stamp::Symlink;
+        stamp.Path = realname;
+        stamp.Value = cmGlobWalkerSymlinkValue(realname, isDir);
+        results.Stamps.emplace_back(std::move(stamp));
+      }
+    }
+    if (isDir && !this->Walker.ListDirs) {
+      continue;
+    }
+    if (this->Matches(fname)) {
+      results.Files.emplace_back(std::move(realname));
+    }
+  }
+}
+
+void cmGlobWalker::Walk::RecurseDirectory(Task const& task, Results& results)
+{
+  // Like cmsys::Glob::RecurseDirectory, but subdirectories become tasks.
+  bool const record = this->Walker.RecordStamps;
+  std::string const& dir = task.Dir;
+  uv_stat_t st;
+  bool const stated = record && cmGlobWalkerStat(dir, true, st);
+  std::vector<cmGlobWalkerEntry> entries;
+  std::string error;
+  if (!cmGlobWalkerReadDirectory(dir, entries, error)) {
+    results.Messages.push_back(
+      { task.Order,
+        cmsys::Glob::Message(cmsys::Glob::warning,
+                             cmStrCat("Error listing directory '", dir,
+                                      "'! Reason: '", error, "'")) });
+    if (record) {
+      Stamp stamp;
+      stamp.Kind = Stamp::Unreadable;
+      stamp.Path = dir;
+      results.Stamps.emplace_back(std::move(stamp));
+    }
+    return;
+  }
+  if (record) {
+    results.Stamps.emplace_back(
+      this->StampDirectory(dir, stated ? &st : nullptr, entries));
+  }
+
+  for (size_t k = 0; k < entries.size(); ++k) {
+    cmGlobWalkerEntry const& entry = entries[k];
+    std::string realname = cmGlobWalkerJoin(dir, entry.Name);
+#ifdef CM_GLOB_WALKER_CASE_INDEPENDENT
+    std::string const fname = cmSystemTools::LowerCase(entry.Name);
+#else
+    std::string const& fname = entry.Name;
+#endif
+    bool const isSymLink = entry.Type == 'l';
+    bool isDir = entry.Type == 'd';
+    if (isSymLink) {
+      isDir = cmGlobWalkerIsDirectory(realname);
+      if (record) {
+        Stamp stamp;
+        stamp.Kind = Stamp::Symlink;
+        stamp.Path = realname;
+        stamp.Value = cmGlobWalkerSymlinkValue(realname, isDir);
+        results.Stamps.emplace_back(std::move(stamp));
+      }
+    }
+
+    if (!isDir || (isSymLink && !this->Walker.RecurseThroughSymlinks)) {
+      if (this->Matches(fname)) {
+        results.Files.emplace_back(std::move(realname));
+      }
+      continue;
+    }
+
+    Task child;
+    child.Order = task.Order;
+    child.Order.push_back(k);
+    child.VisitedSymlinks = task.VisitedSymlinks;
+    if (isSymLink) {
+      ++this->FollowedSymlinks;
+      std::string realPathErrorMessage;
+      std::string canonicalPath(
+        cmsys::SystemTools::GetRealPath(dir, &realPathErrorMessage));
+      if (!realPathErrorMessage.empty()) {
+        results.Messages.push_back(
+          { child.Order,
+            cmsys::Glob::Message(
+              cmsys::Glob::error,
+              cmStrCat("Canonical path generation from path '", dir,
+                       "' failed! Reason: '", realPathErrorMessage, "'")) });
+        results.Failed = true;
+        return;
+      }
+
+      auto visited =
+        std::find(child.VisitedSymlinks.begin(), child.VisitedSymlinks.end(),
+                  canonicalPath);
+      if (visited != child.VisitedSymlinks.end()) {
+        // This symlink has been visited already; prevent cyclic recursion.
+        std::string message;
+        for (; visited != child.VisitedSymlinks.end(); ++visited) {
+          message += *visited + "\n";
+        }
+        message += canonicalPath + "/" + fname;
+        results.Messages.push_back(
+          { child.Order,
+            cmsys::Glob::Message(cmsys::Glob::cyclicRecursion, message) });
+        continue;
+      }
+      child.VisitedSymlinks.emplace_back(std::move(canonicalPath));
+    }
+
+    if (this->Walker.RecurseListDirs) {
+      results.Files.push_back(realname);
+    }
+    child.Dir = std::move(realname);
+    results.Tasks.emplace_back(std::move(child));
+  }
+}
+
+void cmGlobWalker::Walk::Merge(Results&& results)
+{
+  // Pop subdirectories in order to read nearby directories together.
+  std::move(results.Tasks.rbegin(), results.Tasks.rend(),
+            std::back_inserter(this->Tasks));
+  std::move(results.Files.begin(), results.Files.end(),
+            std::back_inserter(this->Found.Files));
+  std::move(results.Messages.begin(), results.Messages.end(),
+            std::back_inserter(this->Found.Messages));
+  std::move(results.Stamps.begin(), results.Stamps.end(),
+            std::back_inserter(this->Found.Stamps));
+  this->Found.Failed = this->Found.Failed || results.Failed;
+}
+
+void cmGlobWalker::Walk::Work()
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  for (;;) {
+    while (this->Tasks.empty() && this->Busy != 0 && !this->Found.Failed) {
+      this->Wake.wait(lock);
+    }
+    if (this->Tasks.empty() || this->Found.Failed) {
+      break;
+    }
+    Task task = std::move(this->Tasks.back());
+    this->Tasks.pop_back();
+    ++this->Busy;
+    lock.unlock();
+
+    Results results;
+    this->RecurseDirectory(task, results);
+
+    lock.lock();
+    --this->Busy;
+    this->Merge(std::move(results));
+    this->Wake.notify_all();
+  }
+}
+
+void cmGlobWalker::Walk::Run(Task root)
+{
+  // Read the first directory alone to start threads only if there are
+  // subdirectories to read.
+  {
+    Results results;
+    this->RecurseDirectory(root, results);
+    this->Merge(std::move(results));
+  }
+  if (this->Tasks.empty() || this->Found.Failed) {
+    return;
+  }
+
+#if !defined(CMAKE_BOOTSTRAP)
+  unsigned int numThreads = std::thread::hardware_concurrency();
+  numThreads = std::min<unsigned int>(
+    numThreads, static_cast<unsigned int>(this->Tasks.size()));
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numThreads; ++i) {
+    threads.emplace_back(&Walk::Work, this);
+  }
+  this->Work();
+  for (std::thread& t : threads) {
+    t.join();
+  }
+#else
+  this->Work();
+#endif
+}
+
+cmGlobWalker::cmGlobWalker(cmsys::Glob& glob)
+  : Recurse(glob.GetRecurse())
+  , ListDirs(glob.GetListDirs())
+  , RecurseListDirs(glob.GetRecurseListDirs())
+  , RecurseThroughSymlinks(glob.GetRecurseThroughSymlinks())
+  , Relative(glob.GetRelative() ? glob.GetRelative() : "")
+{
+}
+
+bool cmGlobWalker::CanFindFiles(std::string const& expr)
+{
+  if (!cmsys::SystemTools::FileIsFullPath(expr)) {
+    return false;
+  }
+  // Wildcards or escapes in the directory part need cmsys::Glob.
+  std::string::size_type const slash = expr.rfind('/');
+  return slash != std::string::npos && slash + 1 < expr.size() &&
+    expr.find_first_of("[?*\\") > slash;
+}
+
+bool cmGlobWalker::FindFiles(std::string const& expr,
+                             cmsys::Glob::GlobMessages* messages)
+{
+  this->Files.clear();
+  this->Stamps.clear();
+
+  std::string::size_type const slash = expr.rfind('/');
+  Walk walk(*this, expr.substr(slash + 1));
+  Walk::Task root;
+  root.Dir = expr.substr(0, slash) + "/";
+  if (!this->Recurse) {
+    walk.ListDirectory(root.Dir, walk.Found);
+  } else if (cmGlobWalkerIsDirectory(root.Dir)) {
+    walk.Run(std::move(root));
+  } else if (this->RecordStamps) {
+    Stamp stamp;
+    stamp.Kind = Stamp::Unreadable;
+    stamp.Path = root.Dir;
+    walk.Found.Stamps.emplace_back(std::move(stamp));
+  }
+  this->FollowedSymlinkCount += walk.FollowedSymlinks;
+
+  // Report messages in the order of a serial walk, which stops at the
+  // first error.
+  std::vector<Walk::OrderedMessage>& found = walk.Found.Messages;
+  std::stable_sort(
+    found.begin(), found.end(),
+    [](Walk::OrderedMessage const& l, Walk::OrderedMessage const& r) {
+      return l.Order < r.Order;
+    });
+  if (messages) {
+    for (Walk::OrderedMessage& m : found) {
+      messages->emplace_back(std::move(m.Message));
+      if (messages->back().type == cmsys::Glob::error) {
+        break;
+      }
+    }
+  }
+
+  this->Files = std::move(walk.Found.Files);
+  if (!this->Relative.empty()) {
+    for (std::string& file : this->Files) {
+      file = cmsys::SystemTools::RelativePath(this->Relative, file);
+    }
+  }
+  this->Stamps = std::move(walk.Found.Stamps);
+  std::sort(this->Stamps.begin(), this->Stamps.end(),
+            [](Stamp const& l, Stamp const& r) { return l.Path < r.Path; });
+  return true;
+}
+
+bool cmGlobWalker::StampsChanged(std::vector<Stamp>& stamps, bool& updated)
+{
+  std::atomic<bool> changed(false);
+  std::atomic<bool> refreshed(false);
+  std::atomic<size_t> next(0);
+  auto worker = [&stamps, &changed, &refreshed, &next]() {
+    for (size_t i = next++; i < stamps.size() && !changed; i = next++) {
+      Stamp& stamp = stamps[i];
+      switch (stamp.Kind) {
+        case Stamp::Directory: {
+          uv_stat_t st;
+          if (!cmGlobWalkerStat(stamp.Path, true, st) ||
+              (st.st_mode & S_IFMT) != S_IFDIR) {
+            changed = true;
+            break;
+          }
+          long long const mtime = cmGlobWalkerTrustedMTime(st);
+          if (mtime != 0 && mtime == stamp.MTime) {
+            break;
+          }
+          // Read the directory again and compare its entries.
+          std::vector<cmGlobWalkerEntry> entries;
+          std::string error;
+          if (!cmGlobWalkerReadDirectory(stamp.Path, entries, error) ||
+              cmGlobWalkerHash(entries) != stamp.Value) {
+            changed = true;
+            break;
+          }
+          if (mtime != stamp.MTime) {
+            stamp.MTime = mtime;
+            refreshed = true;
+          }
+        } break;
+        case Stamp::Unreadable: {
+          std::vector<cmGlobWalkerEntry> entries;
+          std::string error;
+          if (cmGlobWalkerIsDirectory(stamp.Path) &&
+              cmGlobWalkerReadDirectory(stamp.Path, entries, error)) {
+            changed = true;
+          }
+        } break;
+        case Stamp::Symlink: {
+          bool const isDir = cmGlobWalkerIsDirectory(stamp.Path);
+          if (cmGlobWalkerSymlinkValue(stamp.Path, isDir) != stamp.Value) {
+            changed = true;
+          }
+        } break;
+      }
+    }
+  };
+
+#if !defined(CMAKE_BOOTSTRAP)
+  // Querying a few hundred files is not worth starting threads for.
+  size_t const stampsPerThread = 256;
+  size_t numThreads = std::thread::hardware_concurrency();
+  numThreads = std::min(numThreads, stamps.size() / stampsPerThread);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < numThreads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& t : threads) {
+    t.join();
+  }
+#else
+  worker();
+#endif
+
+  if (refreshed) {
+    updated = true;
+  }
+  return changed;
+}
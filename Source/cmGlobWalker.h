@@ -0,0 +1,86 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <vector>
+
+#include "cmsys/Glob.hxx"
+
+/** \class cmGlobWalker
+ * \brief Evaluate a glob expression by reading directories concurrently.
+ *
+ * This handles expressions whose wildcards are all in the last path
+ * component, which covers almost all uses of file(GLOB_RECURSE).  It
+ * finds the same files and reports the same messages as cmsys::Glob.
+ *
+ * A walker may also record stamps of what it looked at.  They tell later
+ * whether the result may have changed by reading only the directories
+ * that were modified since.
+ */
+class cmGlobWalker
+{
+public:
+  //! Take the settings of the given glob.
+  cmGlobWalker(cmsys::Glob& glob);
+
+  //! Whether the given full path expression can be evaluated by a walker.
+  static bool CanFindFiles(std::string const& expr);
+
+  //! Find files matching the expression, like cmsys::Glob::FindFiles.
+  bool FindFiles(std::string const& expr,
+                 cmsys::Glob::GlobMessages* messages = nullptr);
+
+  std::vector<std::string>& GetFiles() { return this->Files; }
+  unsigned int GetFollowedSymlinkCount() const
+  {
+    return this->FollowedSymlinkCount;
+  }
+
+  //! Record stamps while finding files.
+  void SetRecordStamps(bool record) { this->RecordStamps = record; }
+
+  //! What a walk looked at.
+  struct Stamp
+  {
+    enum StampKind
+    {
+      // A directory that was read.
+      Directory,
+      // A directory that could not be read.
+      Unreadable,
+      // A symbolic link that was classified.
+      Symlink
+    };
+    StampKind Kind = Directory;
+    std::string Path;
+    // Modification time of a directory in nanoseconds, or 0 if it was too
+    // recent to be trusted.
+    long long MTime = 0;
+    // Hash of the entries of a directory, or the target of a symbolic
+    // link followed by a slash if it points to a directory.
+    std::string Value;
+  };
+  std::vector<Stamp> const& GetStamps() const { return this->Stamps; }
+
+  /** Check whether anything the stamps describe has changed.  A directory
+      whose modification time changed is read again and only counts as
+      changed if its entries did.  Its stamp is then updated in place and
+      'updated' is set.  */
+  static bool StampsChanged(std::vector<Stamp>& stamps, bool& updated);
+
+private:
+  struct Walk;
+
+  bool Recurse;
+  bool ListDirs;
+  bool RecurseListDirs;
+  bool RecurseThroughSymlinks;
+  bool RecordStamps = false;
+  std::string Relative;
+  unsigned int FollowedSymlinkCount = 0;
+  std::vector<std::string> Files;
+  std::vector<Stamp> Stamps;
+};
@@ -7,6 +7,7 @@
 
 #include <cmext/algorithm>
 
+#include "cmGeneratedFileStream.h"
 #include "cmGeneratorExpression.h"
 #include "cmGeneratorTarget.h"
 #include "cmLocalGenerator.h"
@@ -16,8 +17,8 @@
 #include "cmStateSnapshot.h"
 #include "cmStateTypes.h"
 #include "cmStringAlgorithms.h"
-
-class cmake;
+#include "cmSystemTools.h"
+#include "cmake.h"
 
 cmGlobalCommonGenerator::cmGlobalCommonGenerator(cmake* cm)
   : cmGlobalGenerator(cm)
@@ -95,3 +96,67 @@ bool cmGlobalCommonGenerator::IsExcludedFromAllInConfig(
   }
   return !t.ExcludedFromAllInConfigs.empty();
 }
+
+void cmGlobalCommonGenerator::AddCompileCommand(
+  cmLocalGenerator const* lg, std::string const& sourceFile,
+  std::string const& workingDirectory, std::string const& compileCommand)
+{
+  auto it = this->CompileCommandsIndex.find(lg);
+  if (it == this->CompileCommandsIndex.end()) {
+    it = this->CompileCommandsIndex
+           .emplace(lg, this->CompileCommands.size())
+           .first;
+    this->CompileCommands.emplace_back();
+    this->CompileCommands.back().LG = lg;
+  }
+  std::string& entries = this->CompileCommands[it->second].Entries;
+  if (!entries.empty()) {
+    entries += ",\n";
+  }
+  entries += cmStrCat("{\n", R"(  "directory": ")",
+                      cmGlobalGenerator::EscapeJSON(workingDirectory),
+                      "\",\n", R"(  "command": ")",
+                      cmGlobalGenerator::EscapeJSON(compileCommand), "\",\n",
+                      R"(  "file": ")",
+                      cmGlobalGenerator::EscapeJSON(sourceFile), "\"\n}");
+}
+
+void cmGlobalCommonGenerator::WriteCompileCommands()
+{
+  if (!this->CompileCommands.empty()) {
+    // Merge the entries of all directories.  The file is replaced
+    // atomically, and only if it changed, so that tools watching it do
+    // not reload an identical database after every regeneration.
+    cmGeneratedFileStream fout(
+      cmStrCat(this->GetCMakeInstance()->GetHomeOutputDirectory(),
+               "/compile_commands.json"));
+    fout.SetCopyIfDifferent(true);
+    fout << "[\n";
+    const char* sep = "";
+    for (CompileCommandsFragment const& fragment : this->CompileCommands) {
+      fout << sep << fragment.Entries;
+      sep = ",\n";
+    }
+    fout << "\n]";
+  }
+
+  if (this->GlobalSettingIsOn("CMAKE_EXPORT_COMPILE_COMMANDS_PER_DIRECTORY")) {
+    for (auto const& lg : this->LocalGenerators) {
+      std::string const fragmentFile =
+        cmStrCat(lg->GetCurrentBinaryDirectory(),
+                 "/CMakeFiles/compile_commands.json");
+      auto it = this->CompileCommandsIndex.find(lg.get());
+      if (it == this->CompileCommandsIndex.end()) {
+        // Do not leave a stale fragment behind.
+        cmSystemTools::RemoveFile(fragmentFile);
+        continue;
+      }
+      cmGeneratedFileStream fout(fragmentFile);
+      fout.SetCopyIfDifferent(true);
+      fout << "[\n" << this->CompileCommands[it->second].Entries << "\n]";
+    }
+  }
+
+  this->CompileCommands.clear();
+  this->CompileCommandsIndex.clear();
+}
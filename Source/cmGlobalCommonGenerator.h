@@ -4,6 +4,7 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <cstddef>
 #include <map>
 #include <string>
 #include <vector>
@@ -42,4 +43,33 @@ public:
   std::map<std::string, DirectoryTarget> ComputeDirectoryTargets() const;
   bool IsExcludedFromAllInConfig(const DirectoryTarget::Target& t,
                                  const std::string& config);
+
+  /**
+   * Add an entry for @a sourceFile to the compilation database.  Entries
+   * are collected per directory of @a lg and written by
+   * WriteCompileCommands.
+   */
+  void AddCompileCommand(cmLocalGenerator const* lg,
+                         std::string const& sourceFile,
+                         std::string const& workingDirectory,
+                         std::string const& compileCommand);
+
+protected:
+  /**
+   * Write compile_commands.json, and the fragment of each directory if
+   * enabled by CMAKE_EXPORT_COMPILE_COMMANDS_PER_DIRECTORY.  Each file is
+   * replaced only if its content changed.
+   */
+  void WriteCompileCommands();
+
+private:
+  struct CompileCommandsFragment
+  {
+    cmLocalGenerator const* LG = nullptr;
+    std::string Entries;
+  };
+  /// The compilation database entries of each directory, in the order
+  /// in which the directories added their first entry.
+  std::vector<CompileCommandsFragment> CompileCommands;
+  std::map<cmLocalGenerator const*, std::size_t> CompileCommandsIndex;
 };
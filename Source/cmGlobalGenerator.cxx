@@ -1546,6 +1546,8 @@ void cmGlobalGenerator::Generate()
 
   this->WriteSummary();
 
+  this->WriteTestTargetGraph();
+
   if (this->ExtraGenerator) {
     this->ExtraGenerator->Generate();
   }
@@ -1648,11 +1650,163 @@ bool cmGlobalGenerator::QtAutoGen()
 #endif
 }
 
+namespace {
+// Whether 'target' depends, directly or not, on one of the 'others'.
+bool TargetDependsOnAny(cmGeneratorTarget const* target,
+                        std::set<cmGeneratorTarget const*> const& others,
+                        std::vector<std::string> const& configs,
+                        std::set<cmGeneratorTarget const*>& visited)
+{
+  auto reaches = [&](cmGeneratorTarget const* dep) -> bool {
+    return others.count(dep) ||
+      (visited.insert(dep).second &&
+       TargetDependsOnAny(dep, others, configs, visited));
+  };
+  cmGlobalGenerator* gg = target->GetGlobalGenerator();
+  for (auto const& util : target->GetUtilities()) {
+    cmGeneratorTarget const* dep = gg->FindGeneratorTarget(util.Value.first);
+    if (dep && reaches(dep)) {
+      return true;
+    }
+  }
+  for (std::string const& config : configs) {
+    cmLinkImplementationLibraries const* impl =
+      target->GetLinkImplementationLibraries(config);
+    if (!impl) {
+      continue;
+    }
+    for (cmLinkImplItem const& lib : impl->Libraries) {
+      if (lib.Target && !lib.Target->IsImported() && reaches(lib.Target)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+}
+
+void cmGlobalGenerator::DeduplicatePrecompileHeaders()
+{
+  // Xcode builds precompiled headers itself.  Where the compiler needs the
+  // object file of the precompiled header to be linked, sharing it also
+  // requires sharing the compiler PDB, which is left to explicit use of
+  // PRECOMPILE_HEADERS_REUSE_FROM.
+  if (this->IsXcode() || this->LocalGenerators.empty()) {
+    return;
+  }
+
+  std::vector<std::string> const configs =
+    this->LocalGenerators.front()->GetMakefile()->GetGeneratorConfigs(
+      cmMakefile::IncludeEmptyConfig);
+
+  // Targets whose precompiled headers are already reused explicitly must
+  // keep building them, because reuse is followed only one level.
+  std::set<std::string> donors;
+  for (const auto& lg : this->LocalGenerators) {
+    for (const auto& gt : lg->GetGeneratorTargets()) {
+      if (cmProp reuseFrom =
+            gt->GetProperty("PRECOMPILE_HEADERS_REUSE_FROM")) {
+        donors.insert(*reuseFrom);
+      }
+    }
+  }
+
+  // Reusing precompiled headers requires sharing the compiler PDB, so
+  // leave alone targets that name their own.
+  auto hasCompilePdbName = [&configs](cmGeneratorTarget const* gt) -> bool {
+    if (gt->GetProperty("COMPILE_PDB_NAME")) {
+      return true;
+    }
+    return std::any_of(configs.begin(), configs.end(),
+                       [gt](std::string const& config) {
+                         return gt->GetProperty(
+                                  cmStrCat("COMPILE_PDB_NAME_",
+                                           cmSystemTools::UpperCase(config)));
+                       });
+  };
+
+  // Group the targets by the context of their precompiled headers.
+  std::map<std::string, std::vector<cmGeneratorTarget*>> groups;
+  std::map<cmGeneratorTarget const*, unsigned int> pchBuilds;
+  for (const auto& lg : this->LocalGenerators) {
+    if (lg->GetMakefile()->IsOn("CMAKE_LINK_PCH")) {
+      continue;
+    }
+    for (const auto& gt : lg->GetGeneratorTargets()) {
+      if (!gt->CanCompileSources() ||
+          !gt->GetPropertyAsBool("PRECOMPILE_HEADERS_DEDUPLICATE") ||
+          gt->GetPropertyAsBool("DISABLE_PRECOMPILE_HEADERS") ||
+          gt->GetProperty("PRECOMPILE_HEADERS_REUSE_FROM") ||
+          cm::contains(donors, gt->GetName()) ||
+          hasCompilePdbName(gt.get()) || gt->GetPropertyAsBool("AUTOMOC") ||
+          gt->GetPropertyAsBool("AUTOUIC")) {
+        continue;
+      }
+      std::string const context =
+        lg->GetPchCompileContext(gt.get(), pchBuilds[gt.get()]);
+      if (!context.empty()) {
+        groups[context].push_back(gt.get());
+      }
+    }
+  }
+
+  unsigned int eliminated = 0;
+  for (auto& group : groups) {
+    std::vector<cmGeneratorTarget*> members = std::move(group.second);
+    while (members.size() > 1) {
+      // The target that builds the precompiled headers must not depend on
+      // the targets reusing them.  Prefer one that depends on none of the
+      // others, so they can all reuse its precompiled headers.
+      auto owner = std::find_if(
+        members.begin(), members.end(), [&](cmGeneratorTarget const* gt) {
+          std::set<cmGeneratorTarget const*> others(members.begin(),
+                                                    members.end());
+          others.erase(gt);
+          std::set<cmGeneratorTarget const*> visited{ gt };
+          return !TargetDependsOnAny(gt, others, configs, visited);
+        });
+      if (owner == members.end()) {
+        owner = members.begin();
+      }
+      std::string const& ownerName = (*owner)->GetName();
+
+      std::vector<cmGeneratorTarget*> remaining;
+      for (cmGeneratorTarget* gt : members) {
+        if (gt == *owner) {
+          continue;
+        }
+        std::set<cmGeneratorTarget const*> visited{ *owner };
+        if (TargetDependsOnAny(*owner, { gt }, configs, visited)) {
+          remaining.push_back(gt);
+          continue;
+        }
+        // Do what setting PRECOMPILE_HEADERS_REUSE_FROM does, without its
+        // check that the target does not list precompiled headers itself.
+        gt->Target->AppendProperty("PRECOMPILE_HEADERS_REUSE_FROM",
+                                   ownerName);
+        gt->Target->SetProperty("COMPILE_PDB_NAME", ownerName);
+        gt->Target->AddUtility(ownerName, false);
+        eliminated += pchBuilds[gt];
+      }
+      members = std::move(remaining);
+    }
+  }
+
+  if (eliminated > 0) {
+    this->GetCMakeInstance()->UpdateProgress(
+      cmStrCat("Deduplicated precompiled headers: ", eliminated,
+               " PCH compilation", eliminated == 1 ? "" : "s",
+               " eliminated"),
+      -1);
+  }
+}
+
 bool cmGlobalGenerator::AddAutomaticSources()
 {
   for (const auto& lg : this->LocalGenerators) {
     lg->CreateEvaluationFileOutputs();
   }
+  this->DeduplicatePrecompileHeaders();
   for (const auto& lg : this->LocalGenerators) {
     for (const auto& gt : lg->GetGeneratorTargets()) {
       if (!gt->CanCompileSources()) {
@@ -3233,6 +3387,73 @@ void cmGlobalGenerator::WriteSummary(cmGeneratorTarget* target)
   }
 }
 
+void cmGlobalGenerator::WriteTestTargetGraph()
+{
+  // Record the sources, artifacts and dependencies of every target so
+  // that 'ctest --affected-by' can map changed files to tests.  This is
+  // only done when the project asks for it.
+  std::string fname = cmStrCat(this->CMakeInstance->GetHomeOutputDirectory(),
+                               "/CMakeFiles/CTestTargetGraph.json");
+#ifndef CMAKE_BOOTSTRAP
+  cmMakefile* topMakefile = this->LocalGenerators.empty()
+    ? nullptr
+    : this->LocalGenerators[0]->GetMakefile();
+  if (topMakefile && topMakefile->IsOn("CMAKE_TESTING_ENABLED") &&
+      topMakefile->IsOn("CMAKE_CTEST_TARGET_GRAPH")) {
+    Json::Value root(Json::objectValue);
+    root["sourceDir"] = this->CMakeInstance->GetHomeDirectory();
+    Json::Value& targets = root["targets"] = Json::arrayValue;
+
+    for (const auto& lg : this->LocalGenerators) {
+      std::vector<std::string> const& configs =
+        lg->GetMakefile()->GetGeneratorConfigs(cmMakefile::IncludeEmptyConfig);
+      for (const auto& tgt : lg->GetGeneratorTargets()) {
+        if (!tgt->IsInBuildSystem() ||
+            tgt->GetType() == cmStateEnums::GLOBAL_TARGET) {
+          continue;
+        }
+        Json::Value& target = targets.append(Json::objectValue);
+        target["name"] = tgt->GetName();
+
+        Json::Value& artifacts = target["artifacts"] = Json::arrayValue;
+        std::vector<cmSourceFile*> sources;
+        for (std::string const& c : configs) {
+          switch (tgt->GetType()) {
+            case cmStateEnums::EXECUTABLE:
+            case cmStateEnums::STATIC_LIBRARY:
+            case cmStateEnums::SHARED_LIBRARY:
+            case cmStateEnums::MODULE_LIBRARY:
+              artifacts.append(tgt->GetFullPath(c));
+              break;
+            default:
+              break;
+          }
+          tgt->GetSourceFiles(sources, c);
+        }
+
+        Json::Value& sourcesValue = target["sources"] = Json::arrayValue;
+        auto const sourcesEnd = cmRemoveDuplicates(sources);
+        for (cmSourceFile* sf : cmMakeRange(sources.cbegin(), sourcesEnd)) {
+          sourcesValue.append(sf->ResolveFullPath());
+        }
+
+        Json::Value& dependencies = target["dependencies"] = Json::arrayValue;
+        for (cmTargetDepend const& dep :
+             this->GetTargetDirectDepends(tgt.get())) {
+          dependencies.append(dep->GetName());
+        }
+      }
+    }
+
+    cmGeneratedFileStream fout(fname);
+    fout.SetCopyIfDifferent(true);
+    fout << root;
+    return;
+  }
+#endif
+  cmSystemTools::RemoveFile(fname);
+}
+
 // static
 std::string cmGlobalGenerator::EscapeJSON(const std::string& s)
 {
@@ -550,6 +550,7 @@ protected:
   bool QtAutoGen();
 
   bool AddAutomaticSources();
+  void DeduplicatePrecompileHeaders();
 
   std::string SelectMakeProgram(const std::string& makeProgram,
                                 const std::string& makeDefault = "") const;
@@ -676,6 +677,7 @@ private:
 
   void WriteSummary();
   void WriteSummary(cmGeneratorTarget* target);
+  void WriteTestTargetGraph();
   void FinalizeTargetCompileInfo();
 
   virtual void ForceLinkerLanguages();
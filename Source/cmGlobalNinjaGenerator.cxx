@@ -17,8 +17,12 @@
 #include <cm3p/json/writer.h>
 
 #include "cmsys/FStream.hxx"
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmsys/SystemInformation.hxx"
+#endif
 
 #include "cmDocumentationEntry.h"
+#include "cmFileTime.h"
 #include "cmFortranParser.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGeneratorExpressionEvaluationFile.h"
@@ -471,6 +475,14 @@ void cmGlobalNinjaGenerator::WriteInclude(std::ostream& os,
   os << "include " << filename << "\n";
 }
 
+void cmGlobalNinjaGenerator::WriteSubninja(std::ostream& os,
+                                           const std::string& filename,
+                                           const std::string& comment)
+{
+  cmGlobalNinjaGenerator::WriteComment(os, comment);
+  os << "subninja " << filename << "\n";
+}
+
 void cmGlobalNinjaGenerator::WriteDefault(std::ostream& os,
                                           const cmNinjaDeps& targets,
                                           const std::string& comment)
@@ -519,12 +531,45 @@ void cmGlobalNinjaGenerator::GetDocumentation(cmDocumentationEntry& entry)
   entry.Brief = "Generates build.ninja files.";
 }
 
+std::map<std::string, double> const&
+cmGlobalNinjaGenerator::GetNinjaLogDurations()
+{
+  if (this->NinjaLogDurations) {
+    return *this->NinjaLogDurations;
+  }
+  this->NinjaLogDurations.emplace();
+  std::map<std::string, double>& durations = *this->NinjaLogDurations;
+  std::string const path = cmStrCat(
+    this->CMakeInstance->GetHomeOutputDirectory(), "/.ninja_log");
+  cmsys::ifstream fin(path.c_str());
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    // Lines are of the form "<start>\t<end>\t<mtime>\t<output>[\t<hash>]".
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::vector<std::string> const fields = cmTokenize(line, "\t");
+    unsigned long start;
+    unsigned long end;
+    if (fields.size() < 4 || !cmStrToULong(fields[0], &start) ||
+        !cmStrToULong(fields[1], &end) || end < start) {
+      continue;
+    }
+    durations[fields[3]] = static_cast<double>(end - start);
+  }
+  return durations;
+}
+
 // Implemented in all cmGlobaleGenerator sub-classes.
 // Used in:
 //   Source/cmLocalGenerator.cxx
 //   Source/cmake.cxx
 void cmGlobalNinjaGenerator::Generate()
 {
+  // The durations of the last build were used while computing this
+  // generation.  Read them again for the next one.
+  this->NinjaLogDurations.reset();
+
   // Check minimum Ninja version.
   if (cmSystemTools::VersionCompare(cmSystemTools::OP_LESS,
                                     this->NinjaVersion.c_str(),
@@ -564,8 +609,26 @@ void cmGlobalNinjaGenerator::Generate()
     (this->PolicyCMP0058 == cmPolicies::OLD ||
      this->PolicyCMP0058 == cmPolicies::WARN);
 
+  this->UseDirectoryBuildFiles = !this->IsMultiConfig() &&
+    this->GlobalSettingIsOn("CMAKE_NINJA_DIRECTORY_BUILD_FILES");
+  this->DirectoryBuildFiles.clear();
+  this->UseAutoJobPools =
+    this->GlobalSettingIsOn("CMAKE_NINJA_AUTO_JOB_POOLS");
+  this->AutoJobPools.clear();
+
   this->cmGlobalGenerator::Generate();
 
+  if (!this->DirectoryBuildFiles.empty()) {
+    std::ostream& os = *this->GetCommonFileStream();
+    cmGlobalNinjaGenerator::WriteDivider(os);
+    os << "# Include the build statements of each directory.\n\n";
+    for (std::string const& file : this->DirectoryBuildFiles) {
+      cmGlobalNinjaGenerator::WriteSubninja(
+        os, this->EncodePath(this->ConvertToNinjaPath(file)));
+    }
+    os << "\n";
+  }
+
   this->WriteAssumedSourceDependencies();
   this->WriteTargetAliases(*this->GetCommonFileStream());
   this->WriteFolderTargets(*this->GetCommonFileStream());
@@ -582,7 +645,7 @@ void cmGlobalNinjaGenerator::Generate()
     this->GetCommonFileStream()->setstate(std::ios::failbit);
   }
 
-  this->CloseCompileCommandsStream();
+  this->WriteCompileCommands();
   this->CloseRulesFileStream();
   this->CloseBuildFileStreams();
 
@@ -925,6 +988,53 @@ void cmGlobalNinjaGenerator::AddRule(cmNinjaRule const& rule)
   cmGlobalNinjaGenerator::WriteRule(*this->RulesFileStream, rule);
 }
 
+std::string cmGlobalNinjaGenerator::GetAutoJobPool(
+  std::string const& poolProperty, unsigned long memory)
+{
+  if (!this->UseAutoJobPools || memory == 0) {
+    return std::string();
+  }
+
+  if (this->AutoJobPoolHostProcessors == 0) {
+#ifndef CMAKE_BOOTSTRAP
+    cmsys::SystemInformation info;
+    info.RunCPUCheck();
+    info.RunMemoryCheck();
+    this->AutoJobPoolHostMemory =
+      static_cast<unsigned long>(info.GetTotalPhysicalMemory());
+    this->AutoJobPoolHostProcessors = info.GetNumberOfLogicalCPU();
+#endif
+    if (this->AutoJobPoolHostProcessors == 0) {
+      this->AutoJobPoolHostProcessors = 1;
+    }
+  }
+  // Without knowing the memory of the host, leave the jobs to the
+  // parallelism requested by the user.
+  if (this->AutoJobPoolHostMemory == 0) {
+    return std::string();
+  }
+
+  std::string name =
+    cmStrCat("cmake_", cmSystemTools::LowerCase(poolProperty), '_', memory);
+  if (this->AutoJobPools.insert(name).second) {
+    // Run as many jobs as fit in physical memory, but never more than
+    // there are processors and always at least one.
+    unsigned long depth = this->AutoJobPoolHostMemory / memory;
+    depth = std::min<unsigned long>(depth, this->AutoJobPoolHostProcessors);
+    depth = std::max<unsigned long>(depth, 1);
+
+    std::ostream& os = *this->RulesFileStream;
+    cmGlobalNinjaGenerator::WriteComment(
+      os,
+      cmStrCat("Automatic pool for ", poolProperty, " jobs needing ", memory,
+               " MiB each, sized for ", this->AutoJobPoolHostMemory,
+               " MiB of memory and ", this->AutoJobPoolHostProcessors,
+               " processors."));
+    os << "pool " << name << "\n  depth = " << depth << "\n\n";
+  }
+  return name;
+}
+
 bool cmGlobalNinjaGenerator::HasRule(const std::string& name)
 {
   return (this->Rules.find(name) != this->Rules.end());
@@ -1012,6 +1122,43 @@ cm::optional<std::set<std::string>> cmGlobalNinjaGenerator::ListSubsetWithAll(
   return cm::make_optional(result);
 }
 
+bool cmGlobalNinjaGenerator::OpenDirectoryBuildFileStream(
+  cmLocalGenerator const* lg)
+{
+  if (!this->UseDirectoryBuildFiles) {
+    return true;
+  }
+
+  std::string const path = cmStrCat(lg->GetCurrentBinaryDirectory(),
+                                    "/CMakeFiles/", NINJA_BUILD_FILE);
+  this->DirectoryBuildFileStream = cm::make_unique<cmGeneratedFileStream>(
+    path, false, this->GetMakefileEncoding());
+  if (!(*this->DirectoryBuildFileStream)) {
+    this->DirectoryBuildFileStream.reset();
+    return false;
+  }
+  // Leave the file and its timestamp alone if the build statements of
+  // the directory did not change.
+  this->DirectoryBuildFileStream->SetCopyIfDifferent(true);
+  this->DirectoryBuildFiles.push_back(path);
+
+  this->WriteDisclaimer(*this->DirectoryBuildFileStream);
+  *this->DirectoryBuildFileStream
+    << "# This file contains the build statements of the directory\n"
+    << "# " << lg->GetCurrentSourceDirectory() << "\n"
+    << "# It is included by the main '" << NINJA_BUILD_FILE << "'.\n\n";
+  return true;
+}
+
+void cmGlobalNinjaGenerator::CloseDirectoryBuildFileStream()
+{
+  if (this->DirectoryBuildFileStream &&
+      cmSystemTools::GetErrorOccuredFlag()) {
+    this->DirectoryBuildFileStream->setstate(std::ios::failbit);
+  }
+  this->DirectoryBuildFileStream.reset();
+}
+
 void cmGlobalNinjaGenerator::CloseBuildFileStreams()
 {
   if (this->BuildFileStream) {
@@ -1092,25 +1239,15 @@ void cmGlobalNinjaGenerator::AddAdditionalCleanFile(std::string fileName,
 }
 
 void cmGlobalNinjaGenerator::AddCXXCompileCommand(
-  const std::string& commandLine, const std::string& sourceFile)
+  cmLocalGenerator const* lg, const std::string& commandLine,
+  const std::string& sourceFile)
 {
   // Compute Ninja's build file path.
-  std::string buildFileDir =
+  std::string const& buildFileDir =
     this->GetCMakeInstance()->GetHomeOutputDirectory();
-  if (!this->CompileCommandsStream) {
-    std::string buildFilePath =
-      cmStrCat(buildFileDir, "/compile_commands.json");
-    if (this->ComputingUnknownDependencies) {
-      this->CombinedBuildOutputs.insert(
-        this->NinjaOutputPath("compile_commands.json"));
-    }
-
-    // Get a stream where to generate things.
-    this->CompileCommandsStream =
-      cm::make_unique<cmGeneratedFileStream>(buildFilePath);
-    *this->CompileCommandsStream << "[\n";
-  } else {
-    *this->CompileCommandsStream << ",\n";
+  if (this->ComputingUnknownDependencies) {
+    this->CombinedBuildOutputs.insert(
+      this->NinjaOutputPath("compile_commands.json"));
   }
 
   std::string sourceFileName = sourceFile;
@@ -1119,24 +1256,7 @@ void cmGlobalNinjaGenerator::AddCXXCompileCommand(
       sourceFileName, this->GetCMakeInstance()->GetHomeOutputDirectory());
   }
 
-  /* clang-format off */
-  *this->CompileCommandsStream << "{\n"
-     << R"(  "directory": ")"
-     << cmGlobalGenerator::EscapeJSON(buildFileDir) << "\",\n"
-     << R"(  "command": ")"
-     << cmGlobalGenerator::EscapeJSON(commandLine) << "\",\n"
-     << R"(  "file": ")"
-     << cmGlobalGenerator::EscapeJSON(sourceFileName) << "\"\n"
-     << "}";
-  /* clang-format on */
-}
-
-void cmGlobalNinjaGenerator::CloseCompileCommandsStream()
-{
-  if (this->CompileCommandsStream) {
-    *this->CompileCommandsStream << "\n]";
-    this->CompileCommandsStream.reset();
-  }
+  this->AddCompileCommand(lg, sourceFileName, buildFileDir, commandLine);
 }
 
 void cmGlobalNinjaGenerator::WriteDisclaimer(std::ostream& os) const
@@ -2198,8 +2318,99 @@ Compilation of source files within a target is split into the following steps:
    (because the latter consumes the module).
 */
 
-static std::unique_ptr<cmSourceInfo> cmcmd_cmake_ninja_depends_fortran(
-  std::string const& arg_tdi, std::string const& arg_pp);
+namespace {
+struct cmNinjaDependsFortran
+{
+  cmFortranCompiler Compiler;
+  std::vector<std::string> Includes;
+};
+
+bool cmcmd_cmake_ninja_depends_fortran_load(std::string const& arg_tdi,
+                                            cmNinjaDependsFortran& fortran);
+std::unique_ptr<cmSourceInfo> cmcmd_cmake_ninja_depends_fortran(
+  cmNinjaDependsFortran const& fortran, std::string const& arg_pp);
+
+// Scan one source and write its "ddi" file, and its depfile if any.
+bool cmcmd_cmake_ninja_depends_scan(cmNinjaDependsFortran const& fortran,
+                                    std::string const& arg_src,
+                                    std::string const& arg_pp,
+                                    std::string const& arg_dep,
+                                    std::string const& arg_obj,
+                                    std::string const& arg_ddi,
+                                    std::set<std::string>* batch_includes)
+{
+  std::unique_ptr<cmSourceInfo> info =
+    cmcmd_cmake_ninja_depends_fortran(fortran, arg_pp);
+  if (!info) {
+    // The error message is already expected to have been output.
+    return false;
+  }
+
+  info->PrimaryOutput = arg_obj;
+
+  if (!arg_dep.empty()) {
+    cmGeneratedFileStream depfile(arg_dep);
+    depfile << cmSystemTools::ConvertToUnixOutputPath(arg_pp) << ":";
+    for (std::string const& include : info->Includes) {
+      depfile << " \\\n " << cmSystemTools::ConvertToUnixOutputPath(include);
+    }
+    depfile << "\n";
+  }
+  if (batch_includes) {
+    batch_includes->insert(info->Includes.begin(), info->Includes.end());
+  }
+
+  if (!cmScanDepFormat_P1689_Write(arg_ddi, arg_src, *info)) {
+    cmSystemTools::Error(
+      cmStrCat("-E cmake_ninja_depends failed to write ", arg_ddi));
+    return false;
+  }
+  return true;
+}
+
+// Scan the sources listed in a batch file with one process.  Each source
+// gets the same "ddi" file as if scanned on its own, and the depfile of
+// the batch build statement lists the includes of them all.
+int cmcmd_cmake_ninja_depends_batch(cmNinjaDependsFortran const& fortran,
+                                    std::string const& arg_batch,
+                                    std::string const& arg_dep)
+{
+  Json::Value batch;
+  {
+    cmsys::ifstream bf(arg_batch.c_str(), std::ios::in | std::ios::binary);
+    Json::Reader reader;
+    if (!reader.parse(bf, batch, false) || !batch.isArray()) {
+      cmSystemTools::Error(cmStrCat("-E cmake_ninja_depends failed to parse ",
+                                    arg_batch,
+                                    reader.getFormattedErrorMessages()));
+      return 1;
+    }
+  }
+
+  std::set<std::string> includes;
+  std::string first_ddi;
+  for (Json::Value const& entry : batch) {
+    std::string const src = entry["src"].asString();
+    std::string const ddi = entry["ddi"].asString();
+    if (!cmcmd_cmake_ninja_depends_scan(fortran, src, src, std::string(),
+                                        entry["obj"].asString(), ddi,
+                                        &includes)) {
+      return 1;
+    }
+    if (first_ddi.empty()) {
+      first_ddi = ddi;
+    }
+  }
+
+  cmGeneratedFileStream depfile(arg_dep);
+  depfile << cmSystemTools::ConvertToUnixOutputPath(first_ddi) << ":";
+  for (std::string const& include : includes) {
+    depfile << " \\\n " << cmSystemTools::ConvertToUnixOutputPath(include);
+  }
+  depfile << "\n";
+  return 0;
+}
+}
 
 int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
                               std::vector<std::string>::const_iterator argEnd)
@@ -2211,6 +2422,7 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
   std::string arg_obj;
   std::string arg_ddi;
   std::string arg_lang;
+  std::string arg_batch;
   for (std::string const& arg : cmMakeRange(argBeg, argEnd)) {
     if (cmHasLiteralPrefix(arg, "--tdi=")) {
       arg_tdi = arg.substr(6);
@@ -2226,6 +2438,8 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
       arg_ddi = arg.substr(6);
     } else if (cmHasLiteralPrefix(arg, "--lang=")) {
       arg_lang = arg.substr(7);
+    } else if (cmHasLiteralPrefix(arg, "--batch=")) {
+      arg_batch = arg.substr(8);
     } else {
       cmSystemTools::Error(
         cmStrCat("-E cmake_ninja_depends unknown argument: ", arg));
@@ -2236,7 +2450,7 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
     cmSystemTools::Error("-E cmake_ninja_depends requires value for --tdi=");
     return 1;
   }
-  if (arg_pp.empty()) {
+  if (arg_pp.empty() && arg_batch.empty()) {
     cmSystemTools::Error("-E cmake_ninja_depends requires value for --pp=");
     return 1;
   }
@@ -2244,11 +2458,11 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
     cmSystemTools::Error("-E cmake_ninja_depends requires value for --dep=");
     return 1;
   }
-  if (arg_obj.empty()) {
+  if (arg_obj.empty() && arg_batch.empty()) {
     cmSystemTools::Error("-E cmake_ninja_depends requires value for --obj=");
     return 1;
   }
-  if (arg_ddi.empty()) {
+  if (arg_ddi.empty() && arg_batch.empty()) {
     cmSystemTools::Error("-E cmake_ninja_depends requires value for --ddi=");
     return 1;
   }
@@ -2260,9 +2474,11 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
     arg_src = cmStrCat("<", arg_obj, " input file>");
   }
 
-  std::unique_ptr<cmSourceInfo> info;
+  cmNinjaDependsFortran fortran;
   if (arg_lang == "Fortran") {
-    info = cmcmd_cmake_ninja_depends_fortran(arg_tdi, arg_pp);
+    if (!cmcmd_cmake_ninja_depends_fortran_load(arg_tdi, fortran)) {
+      return 1;
+    }
   } else {
     cmSystemTools::Error(
       cmStrCat("-E cmake_ninja_depends does not understand the ", arg_lang,
@@ -2270,69 +2486,57 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
     return 1;
   }
 
-  if (!info) {
-    // The error message is already expected to have been output.
-    return 1;
+  if (!arg_batch.empty()) {
+    return cmcmd_cmake_ninja_depends_batch(fortran, arg_batch, arg_dep);
   }
-
-  info->PrimaryOutput = arg_obj;
-
-  {
-    cmGeneratedFileStream depfile(arg_dep);
-    depfile << cmSystemTools::ConvertToUnixOutputPath(arg_pp) << ":";
-    for (std::string const& include : info->Includes) {
-      depfile << " \\\n " << cmSystemTools::ConvertToUnixOutputPath(include);
-    }
-    depfile << "\n";
-  }
-
-  if (!cmScanDepFormat_P1689_Write(arg_ddi, arg_src, *info)) {
-    cmSystemTools::Error(
-      cmStrCat("-E cmake_ninja_depends failed to write ", arg_ddi));
+  if (!cmcmd_cmake_ninja_depends_scan(fortran, arg_src, arg_pp, arg_dep,
+                                      arg_obj, arg_ddi, nullptr)) {
     return 1;
   }
   return 0;
 }
 
-std::unique_ptr<cmSourceInfo> cmcmd_cmake_ninja_depends_fortran(
-  std::string const& arg_tdi, std::string const& arg_pp)
+namespace {
+bool cmcmd_cmake_ninja_depends_fortran_load(std::string const& arg_tdi,
+                                            cmNinjaDependsFortran& fortran)
 {
-  cmFortranCompiler fc;
-  std::vector<std::string> includes;
+  Json::Value tdio;
+  Json::Value const& tdi = tdio;
   {
-    Json::Value tdio;
-    Json::Value const& tdi = tdio;
-    {
-      cmsys::ifstream tdif(arg_tdi.c_str(), std::ios::in | std::ios::binary);
-      Json::Reader reader;
-      if (!reader.parse(tdif, tdio, false)) {
-        cmSystemTools::Error(
-          cmStrCat("-E cmake_ninja_depends failed to parse ", arg_tdi,
-                   reader.getFormattedErrorMessages()));
-        return nullptr;
-      }
+    cmsys::ifstream tdif(arg_tdi.c_str(), std::ios::in | std::ios::binary);
+    Json::Reader reader;
+    if (!reader.parse(tdif, tdio, false)) {
+      cmSystemTools::Error(
+        cmStrCat("-E cmake_ninja_depends failed to parse ", arg_tdi,
+                 reader.getFormattedErrorMessages()));
+      return false;
     }
+  }
 
-    Json::Value const& tdi_include_dirs = tdi["include-dirs"];
-    if (tdi_include_dirs.isArray()) {
-      for (auto const& tdi_include_dir : tdi_include_dirs) {
-        includes.push_back(tdi_include_dir.asString());
-      }
+  Json::Value const& tdi_include_dirs = tdi["include-dirs"];
+  if (tdi_include_dirs.isArray()) {
+    for (auto const& tdi_include_dir : tdi_include_dirs) {
+      fortran.Includes.push_back(tdi_include_dir.asString());
     }
+  }
 
-    Json::Value const& tdi_compiler_id = tdi["compiler-id"];
-    fc.Id = tdi_compiler_id.asString();
+  Json::Value const& tdi_compiler_id = tdi["compiler-id"];
+  fortran.Compiler.Id = tdi_compiler_id.asString();
 
-    Json::Value const& tdi_submodule_sep = tdi["submodule-sep"];
-    fc.SModSep = tdi_submodule_sep.asString();
+  Json::Value const& tdi_submodule_sep = tdi["submodule-sep"];
+  fortran.Compiler.SModSep = tdi_submodule_sep.asString();
 
-    Json::Value const& tdi_submodule_ext = tdi["submodule-ext"];
-    fc.SModExt = tdi_submodule_ext.asString();
-  }
+  Json::Value const& tdi_submodule_ext = tdi["submodule-ext"];
+  fortran.Compiler.SModExt = tdi_submodule_ext.asString();
+  return true;
+}
 
+std::unique_ptr<cmSourceInfo> cmcmd_cmake_ninja_depends_fortran(
+  cmNinjaDependsFortran const& fortran, std::string const& arg_pp)
+{
   cmFortranSourceInfo finfo;
   std::set<std::string> defines;
-  cmFortranParser parser(fc, includes, defines, finfo);
+  cmFortranParser parser(fortran.Compiler, fortran.Includes, defines, finfo);
   if (!cmFortranParser_FilePush(&parser, arg_pp.c_str())) {
     cmSystemTools::Error(
       cmStrCat("-E cmake_ninja_depends failed to open ", arg_pp));
@@ -2365,6 +2569,51 @@ std::unique_ptr<cmSourceInfo> cmcmd_cmake_ninja_depends_fortran(
   }
   return info;
 }
+}
+
+namespace {
+Json::Value SourceReqInfoToJson(std::vector<cmSourceReqInfo> const& reqs)
+{
+  Json::Value json = Json::arrayValue;
+  for (cmSourceReqInfo const& req : reqs) {
+    Json::Value& entry = json.append(Json::objectValue);
+    entry["logical-name"] = req.LogicalName;
+    entry["compiled-module-path"] = req.CompiledModulePath;
+  }
+  return json;
+}
+
+void SourceReqInfoFromJson(Json::Value const& json,
+                           std::vector<cmSourceReqInfo>& reqs)
+{
+  if (!json.isArray()) {
+    return;
+  }
+  for (Json::Value const& entry : json) {
+    cmSourceReqInfo req;
+    req.LogicalName = entry["logical-name"].asString();
+    req.CompiledModulePath = entry["compiled-module-path"].asString();
+    reqs.push_back(std::move(req));
+  }
+}
+
+// Only the parts of the scan results used to collate them are cached.
+Json::Value SourceInfoToJson(cmSourceInfo const& info)
+{
+  Json::Value json = Json::objectValue;
+  json["primary-output"] = info.PrimaryOutput;
+  json["provides"] = SourceReqInfoToJson(info.Provides);
+  json["requires"] = SourceReqInfoToJson(info.Requires);
+  return json;
+}
+
+void SourceInfoFromJson(Json::Value const& json, cmSourceInfo& info)
+{
+  info.PrimaryOutput = json["primary-output"].asString();
+  SourceReqInfoFromJson(json["provides"], info.Provides);
+  SourceReqInfoFromJson(json["requires"], info.Requires);
+}
+}
 
 bool cmGlobalNinjaGenerator::WriteDyndepFile(
   std::string const& dir_top_src, std::string const& dir_top_bld,
@@ -2387,14 +2636,47 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
     this->LocalGenerators.push_back(std::move(lgd));
   }
 
+  // Load the scan results of a previous run.  Those of files that did not
+  // change since are reused instead of parsing the files again.
+  std::string const ddi_cache_file = cmStrCat(arg_dd, ".cache");
+  Json::Value ddi_cache_in;
+  {
+    cmsys::ifstream dcf(ddi_cache_file.c_str(),
+                        std::ios::in | std::ios::binary);
+    Json::Reader reader;
+    if (!dcf || !reader.parse(dcf, ddi_cache_in, false) ||
+        !ddi_cache_in.isObject()) {
+      ddi_cache_in = Json::objectValue;
+    }
+  }
+  Json::Value ddi_cache_out = Json::objectValue;
+
   std::vector<cmSourceInfo> objects;
   for (std::string const& arg_ddi : arg_ddis) {
+    cmFileTime ddi_time;
+    bool const ddi_stat = ddi_time.Load(arg_ddi);
+    Json::Int64 const ddi_mtime = ddi_time.GetTime();
+    Json::UInt64 const ddi_size = cmSystemTools::FileLength(arg_ddi);
+
     cmSourceInfo info;
-    if (!cmScanDepFormat_P1689_Parse(arg_ddi, &info)) {
+    Json::Value const& cached = ddi_cache_in[arg_ddi];
+    if (ddi_stat && cached.isObject() &&
+        cached["mtime"].isInt64() &&
+        cached["mtime"].asInt64() == ddi_mtime &&
+        cached["size"].isUInt64() &&
+        cached["size"].asUInt64() == ddi_size) {
+      SourceInfoFromJson(cached, info);
+    } else if (!cmScanDepFormat_P1689_Parse(arg_ddi, &info)) {
       cmSystemTools::Error(
         cmStrCat("-E cmake_ninja_dyndep failed to parse ddi file ", arg_ddi));
       return false;
     }
+
+    if (ddi_stat) {
+      Json::Value& entry = ddi_cache_out[arg_ddi] = SourceInfoToJson(info);
+      entry["mtime"] = ddi_mtime;
+      entry["size"] = ddi_size;
+    }
     objects.push_back(std::move(info));
   }
 
@@ -2434,7 +2716,10 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
     }
   }
 
+  // Replace the dyndep file and the files written with it only if their
+  // content changes so that their consumers are not rebuilt needlessly.
   cmGeneratedFileStream ddf(arg_dd);
+  ddf.SetCopyIfDifferent(true);
   ddf << "ninja_dyndep_version = 1.0\n";
 
   {
@@ -2498,6 +2783,7 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
         // `cmNinjaTargetGenerator::WriteObjectBuildStatements` to generate the
         // corresponding file path.
         cmGeneratedFileStream mmf(cmStrCat(object.PrimaryOutput, ".modmap"));
+        mmf.SetCopyIfDifferent(true);
         mmf << mm.str();
       }
 
@@ -2510,8 +2796,13 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
   std::string const target_mods_file = cmStrCat(
     cmSystemTools::GetFilenamePath(arg_dd), '/', arg_lang, "Modules.json");
   cmGeneratedFileStream tmf(target_mods_file);
+  tmf.SetCopyIfDifferent(true);
   tmf << tm;
 
+  cmGeneratedFileStream dcf(ddi_cache_file);
+  dcf.SetCopyIfDifferent(true);
+  dcf << ddi_cache_out;
+
   return true;
 }
 
@@ -143,6 +143,13 @@ public:
   static void WriteInclude(std::ostream& os, const std::string& filename,
                            const std::string& comment = "");
 
+  /**
+   * Write a subninja statement including the given @a filename in a
+   * new variable scope.
+   */
+  static void WriteSubninja(std::ostream& os, const std::string& filename,
+                            const std::string& comment = "");
+
   /**
    * Write a default target statement specifying @a targets as
    * the default targets.
@@ -220,7 +227,7 @@ public:
   virtual cmGeneratedFileStream* GetImplFileStream(
     const std::string& /*config*/) const
   {
-    return this->BuildFileStream.get();
+    return this->GetBuildFileStream();
   }
 
   virtual cmGeneratedFileStream* GetConfigFileStream(
@@ -236,7 +243,7 @@ public:
 
   virtual cmGeneratedFileStream* GetCommonFileStream() const
   {
-    return this->BuildFileStream.get();
+    return this->GetBuildFileStream();
   }
 
   cmGeneratedFileStream* GetRulesFileStream() const
@@ -244,6 +251,24 @@ public:
     return this->RulesFileStream.get();
   }
 
+  /**
+   * Direct the build statements of the directory of @a lg to a file
+   * of its own, included by the main build file, if enabled by the
+   * CMAKE_NINJA_DIRECTORY_BUILD_FILES variable.
+   */
+  bool OpenDirectoryBuildFileStream(cmLocalGenerator const* lg);
+  void CloseDirectoryBuildFileStream();
+
+  /**
+   * Return the name of the automatic pool for jobs of the kind named by
+   * @a poolProperty that need @a memory MiB each, writing its definition
+   * to the rules file the first time it is used.  Returns an empty string
+   * if automatic pools are not enabled by the CMAKE_NINJA_AUTO_JOB_POOLS
+   * variable or the memory of the host is unknown.
+   */
+  std::string GetAutoJobPool(std::string const& poolProperty,
+                             unsigned long memory);
+
   std::string const& ConvertToNinjaPath(const std::string& path) const;
 
   struct MapToNinjaPathImpl
@@ -272,7 +297,8 @@ public:
     return "CMakeFiles/cmake_byproducts_for_clean_target";
   }
 
-  void AddCXXCompileCommand(const std::string& commandLine,
+  void AddCXXCompileCommand(cmLocalGenerator const* lg,
+                            const std::string& commandLine,
                             const std::string& sourceFile);
 
   /**
@@ -353,6 +379,9 @@ public:
   virtual void AddRebuildManifestOutputs(cmNinjaDeps& outputs) const
   {
     outputs.push_back(this->NinjaOutputPath(NINJA_BUILD_FILE));
+    for (std::string const& file : this->DirectoryBuildFiles) {
+      outputs.push_back(this->ConvertToNinjaPath(file));
+    }
   }
 
   int GetRuleCmdLength(const std::string& name)
@@ -449,6 +478,11 @@ public:
 
   bool CheckCxxModuleSupport();
 
+  /** Get the duration in milliseconds of the last run of the command
+      producing each output, as recorded in the '.ninja_log' file at the
+      top of the build tree.  The file is read once per generation.  */
+  std::map<std::string, double> const& GetNinjaLogDurations();
+
 protected:
   void Generate() override;
 
@@ -457,6 +491,13 @@ protected:
   virtual bool OpenBuildFileStreams();
   virtual void CloseBuildFileStreams();
 
+  cmGeneratedFileStream* GetBuildFileStream() const
+  {
+    return this->DirectoryBuildFileStream
+      ? this->DirectoryBuildFileStream.get()
+      : this->BuildFileStream.get();
+  }
+
   bool OpenFileStream(std::unique_ptr<cmGeneratedFileStream>& stream,
                       const std::string& name);
 
@@ -479,8 +520,6 @@ private:
   bool CheckFortran(cmMakefile* mf) const;
   bool CheckISPC(cmMakefile* mf) const;
 
-  void CloseCompileCommandsStream();
-
   bool OpenRulesFileStream();
   void CloseRulesFileStream();
   void CleanMetaData();
@@ -511,10 +550,22 @@ private:
   /// The file containing the build statement. (the relationship of the
   /// compilation DAG).
   std::unique_ptr<cmGeneratedFileStream> BuildFileStream;
+  /// The file containing the build statements of the directory being
+  /// generated, if they are written to a file of their own.
+  std::unique_ptr<cmGeneratedFileStream> DirectoryBuildFileStream;
+  /// The directory build files to include from the main build file.
+  std::vector<std::string> DirectoryBuildFiles;
+  bool UseDirectoryBuildFiles = false;
+
+  /// The automatic pools defined so far, sized from the physical memory
+  /// and processors of the host detected on first use.
+  std::set<std::string> AutoJobPools;
+  bool UseAutoJobPools = false;
+  unsigned long AutoJobPoolHostMemory = 0;
+  unsigned int AutoJobPoolHostProcessors = 0;
   /// The file containing the rule statements. (The action attached to each
   /// edge of the compilation DAG).
   std::unique_ptr<cmGeneratedFileStream> RulesFileStream;
-  std::unique_ptr<cmGeneratedFileStream> CompileCommandsStream;
 
   /// The set of rules added to the generated build system.
   std::unordered_set<std::string> Rules;
@@ -571,6 +622,8 @@ private:
 
   bool DiagnosedCxxModuleSupport = false;
 
+  cm::optional<std::map<std::string, double>> NinjaLogDurations;
+
   void InitOutputPathPrefix();
 
   std::string OutputPathPrefix;
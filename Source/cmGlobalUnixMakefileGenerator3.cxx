@@ -166,36 +166,7 @@ void cmGlobalUnixMakefileGenerator3::Generate()
   this->WriteMainMakefile2();
   this->WriteMainCMakefile();
 
-  if (this->CommandDatabase) {
-    *this->CommandDatabase << "\n]";
-    this->CommandDatabase.reset();
-  }
-}
-
-void cmGlobalUnixMakefileGenerator3::AddCXXCompileCommand(
-  const std::string& sourceFile, const std::string& workingDirectory,
-  const std::string& compileCommand)
-{
-  if (!this->CommandDatabase) {
-    std::string commandDatabaseName =
-      this->GetCMakeInstance()->GetHomeOutputDirectory() +
-      "/compile_commands.json";
-    this->CommandDatabase =
-      cm::make_unique<cmGeneratedFileStream>(commandDatabaseName);
-    *this->CommandDatabase << "[\n";
-  } else {
-    *this->CommandDatabase << ",\n";
-  }
-  *this->CommandDatabase << "{\n"
-                         << R"(  "directory": ")"
-                         << cmGlobalGenerator::EscapeJSON(workingDirectory)
-                         << "\",\n"
-                         << R"(  "command": ")"
-                         << cmGlobalGenerator::EscapeJSON(compileCommand)
-                         << "\",\n"
-                         << R"(  "file": ")"
-                         << cmGlobalGenerator::EscapeJSON(sourceFile)
-                         << "\"\n}";
+  this->WriteCompileCommands();
 }
 
 void cmGlobalUnixMakefileGenerator3::WriteMainMakefile2()
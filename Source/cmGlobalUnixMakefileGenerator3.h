@@ -170,10 +170,6 @@ public:
   /** Record per-target progress information.  */
   void RecordTargetProgress(cmMakefileTargetGenerator* tg);
 
-  void AddCXXCompileCommand(const std::string& sourceFile,
-                            const std::string& workingDirectory,
-                            const std::string& compileCommand);
-
   /** Does the make tool tolerate .NOTPARALLEL? */
   virtual bool AllowNotParallel() const { return true; }
 
@@ -274,8 +270,6 @@ protected:
     std::set<cmGeneratorTarget const*>& emitted);
   size_t CountProgressMarksInAll(const cmLocalGenerator& lg);
 
-  std::unique_ptr<cmGeneratedFileStream> CommandDatabase;
-
 private:
   const char* GetBuildIgnoreErrorsFlag() const override { return "-i"; }
   std::string GetEditCacheCommand() const override;
@@ -95,6 +95,18 @@ void cmInstallFilesGenerator::AddFilesInstallRule(
     this->GetRename(config).c_str(), nullptr, indent);
 }
 
+bool cmInstallFilesGenerator::GenerateBulkManifest(std::ostream& os)
+{
+  // Rules evaluated per configuration need the script.
+  if (this->ActionsPerConfig) {
+    return false;
+  }
+  return this->AddBulkManifestRule(
+    os, this->Destination,
+    (this->Programs ? cmInstallType_PROGRAMS : cmInstallType_FILES),
+    this->Files, this->Optional, this->FilePermissions, this->Rename);
+}
+
 void cmInstallFilesGenerator::GenerateScriptActions(std::ostream& os,
                                                     Indent indent)
 {
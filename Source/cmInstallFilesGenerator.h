@@ -31,6 +31,8 @@ public:
 
   bool Compute(cmLocalGenerator* lg) override;
 
+  bool GenerateBulkManifest(std::ostream& os) override;
+
   std::string GetDestination(std::string const& config) const;
   std::string GetRename(std::string const& config) const;
   std::vector<std::string> GetFiles(std::string const& config) const;
@@ -2,6 +2,7 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmInstallGenerator.h"
 
+#include <algorithm>
 #include <ostream>
 #include <utility>
 
@@ -142,6 +143,85 @@ void cmInstallGenerator::AddInstallRule(
   os << ")\n";
 }
 
+bool cmInstallGenerator::GenerateBulkManifest(std::ostream& /*os*/)
+{
+  return false;
+}
+
+static bool cmInstallGeneratorIsLiteral(std::string const& str)
+{
+  // Installation scripts would evaluate variable references and escape
+  // sequences in these strings, and manifest entries are single lines.
+  return str.find_first_of("$\\\"\n\r") == std::string::npos;
+}
+
+bool cmInstallGenerator::AddBulkManifestRule(
+  std::ostream& os, std::string const& dest, cmInstallType type,
+  std::vector<std::string> const& files, bool optional,
+  std::string const& permissions_file, std::string const& rename)
+{
+  // Only plain files are installed without further script code.
+  const char* stype;
+  switch (type) {
+    case cmInstallType_PROGRAMS:
+      stype = "PROGRAM";
+      break;
+    case cmInstallType_FILES:
+      stype = "FILE";
+      break;
+    default:
+      return false;
+  }
+  // Absolute destinations are subject to checks of the script code.
+  if (dest.empty() || cmSystemTools::FileIsFullPath(dest) ||
+      !cmInstallGeneratorIsLiteral(dest) ||
+      !cmInstallGeneratorIsLiteral(this->Component) ||
+      !cmInstallGeneratorIsLiteral(rename) ||
+      !std::all_of(files.begin(), files.end(), cmInstallGeneratorIsLiteral) ||
+      !std::all_of(this->Configurations.begin(), this->Configurations.end(),
+                   cmInstallGeneratorIsLiteral)) {
+    return false;
+  }
+
+  os << "rule\n";
+  os << "component " << this->Component << "\n";
+  if (this->ExcludeFromAll) {
+    os << "exclude_from_all\n";
+  }
+  for (std::string const& config : this->Configurations) {
+    os << "configuration " << config << "\n";
+  }
+  os << "destination " << dest << "\n";
+  os << "type " << stype << "\n";
+  if (optional) {
+    os << "optional\n";
+  }
+  switch (this->Message) {
+    case MessageDefault:
+      break;
+    case MessageAlways:
+      os << "message ALWAYS\n";
+      break;
+    case MessageLazy:
+      os << "message LAZY\n";
+      break;
+    case MessageNever:
+      os << "message NEVER\n";
+      break;
+  }
+  if (!permissions_file.empty()) {
+    os << "permissions" << permissions_file << "\n";
+  }
+  if (!rename.empty()) {
+    os << "rename " << rename << "\n";
+  }
+  for (std::string const& f : files) {
+    os << "file " << f << "\n";
+  }
+  os << "end\n";
+  return true;
+}
+
 std::string cmInstallGenerator::CreateComponentTest(
   const std::string& component, bool exclude_from_all)
 {
@@ -50,6 +50,10 @@ public:
     const char* permissions_dir = nullptr, const char* rename = nullptr,
     const char* literal_args = nullptr, Indent indent = Indent());
 
+  /** Write the rules of this generator to a bulk install manifest if
+      they can be applied without evaluating any script code.  */
+  virtual bool GenerateBulkManifest(std::ostream& os);
+
   /** Get the install destination as it should appear in the
       installation script.  */
   std::string ConvertToAbsoluteDestination(std::string const& dest) const;
@@ -74,6 +78,12 @@ protected:
   std::string CreateComponentTest(const std::string& component,
                                   bool exclude_from_all);
 
+  bool AddBulkManifestRule(std::ostream& os, std::string const& dest,
+                           cmInstallType type,
+                           std::vector<std::string> const& files,
+                           bool optional, std::string const& permissions_file,
+                           std::string const& rename);
+
   // Information shared by most generator types.
   std::string const Destination;
   std::string const Component;
@@ -9,6 +9,7 @@
 #include <cstdlib>
 #include <initializer_list>
 #include <iterator>
+#include <numeric>
 #include <sstream>
 #include <unordered_set>
 #include <utility>
@@ -19,6 +20,7 @@
 #include <cmext/algorithm>
 #include <cmext/string_view>
 
+#include "cmsys/FStream.hxx"
 #include "cmsys/RegularExpression.hxx"
 
 #include "cmAlgorithms.h"
@@ -32,6 +34,7 @@
 #include "cmGeneratorExpressionEvaluationFile.h"
 #include "cmGeneratorTarget.h"
 #include "cmGlobalGenerator.h"
+#include "cmGlobalNinjaGenerator.h"
 #include "cmInstallGenerator.h"
 #include "cmInstallScriptGenerator.h"
 #include "cmInstallTargetGenerator.h"
@@ -649,22 +652,41 @@ void cmLocalGenerator::GenerateInstallRules()
 
   this->AddGeneratorSpecificInstallSetup(fout);
 
-  // Ask each install generator to write its code.
+  // Ask each install generator to write its code.  Consecutive rules that
+  // need no script code may be collected in bulk manifests instead.
   cmPolicies::PolicyStatus status = this->GetPolicyStatus(cmPolicies::CMP0082);
   auto const& installers = this->Makefile->GetInstallGenerators();
   bool haveSubdirectoryInstall = false;
   bool haveInstallAfterSubdirectory = false;
-  if (status == cmPolicies::WARN) {
-    for (const auto& installer : installers) {
+  bool const bulk = this->Makefile->IsOn("CMAKE_INSTALL_BULK_MANIFEST");
+  std::ostringstream bulkRules;
+  unsigned int bulkManifests = 0;
+  auto writeBulkManifest = [&]() {
+    if (bulkRules.tellp() == 0) {
+      return;
+    }
+    std::string const manifest =
+      cmStrCat(this->StateSnapshot.GetDirectory().GetCurrentBinary(),
+               "/CMakeFiles/cmake_install_", bulkManifests++, ".manifest");
+    cmGeneratedFileStream mout(manifest);
+    mout.SetCopyIfDifferent(true);
+    mout << "# CMake generated bulk install manifest\n" << bulkRules.str();
+    fout << "file(INSTALL _CMAKE_BULK_MANIFEST "
+         << cmOutputConverter::EscapeForCMake(manifest) << ")\n\n";
+    bulkRules.str(std::string());
+  };
+  for (const auto& installer : installers) {
+    if (status == cmPolicies::WARN) {
       installer->CheckCMP0082(haveSubdirectoryInstall,
                               haveInstallAfterSubdirectory);
-      installer->Generate(fout, config, configurationTypes);
     }
-  } else {
-    for (const auto& installer : installers) {
-      installer->Generate(fout, config, configurationTypes);
+    if (bulk && installer->GenerateBulkManifest(bulkRules)) {
+      continue;
     }
+    writeBulkManifest();
+    installer->Generate(fout, config, configurationTypes);
   }
+  writeBulkManifest();
 
   // Write rules from old-style specification stored in targets.
   this->GenerateTargetInstallRules(fout, config, configurationTypes);
@@ -2660,6 +2682,95 @@ void cmLocalGenerator::AddPchDependencies(cmGeneratorTarget* target)
   }
 }
 
+std::string cmLocalGenerator::GetPchCompileContext(cmGeneratorTarget* target,
+                                                   unsigned int& pchBuilds)
+{
+  pchBuilds = 0;
+  std::string context;
+
+  std::vector<std::string> configsList =
+    this->Makefile->GetGeneratorConfigs(cmMakefile::IncludeEmptyConfig);
+
+  for (std::string const& config : configsList) {
+    std::vector<cmSourceFile*> sources;
+    target->GetSourceFiles(sources, config);
+
+    static const std::array<std::string, 4> langs = { { "C", "CXX", "OBJC",
+                                                        "OBJCXX" } };
+
+    for (const std::string& lang : langs) {
+      auto langSources = std::count_if(
+        sources.begin(), sources.end(), [lang](cmSourceFile* sf) {
+          return lang == sf->GetLanguage() &&
+            !sf->GetProperty("SKIP_PRECOMPILE_HEADERS");
+        });
+      if (langSources == 0) {
+        continue;
+      }
+
+      std::vector<BT<std::string>> const headers =
+        target->GetPrecompileHeaders(config, lang);
+      if (headers.empty()) {
+        continue;
+      }
+
+      std::vector<std::string> architectures;
+      target->GetAppleArchs(config, architectures);
+      pchBuilds += static_cast<unsigned int>(
+        std::max<size_t>(architectures.size(), 1));
+
+      context += cmStrCat("config=", config, "\nlang=", lang, '\n');
+      for (BT<std::string> const& header : headers) {
+        context += cmStrCat("header=", header.Value, '\n');
+      }
+      for (std::string const& arch : architectures) {
+        context += cmStrCat("arch=", arch, '\n');
+      }
+
+      std::string flags;
+      this->GetTargetCompileFlags(target, config, lang, flags, "");
+      context += cmStrCat("flags=", flags, '\n');
+
+      // The language standard is computed from the compile features later,
+      // so describe it by the inputs of that computation.
+      for (BT<std::string> const& feature :
+           target->GetCompileFeatures(config)) {
+        context += cmStrCat("feature=", feature.Value, '\n');
+      }
+      for (const char* suffix :
+           { "_STANDARD", "_STANDARD_REQUIRED", "_EXTENSIONS" }) {
+        context += cmStrCat(lang, suffix, '=',
+                            target->GetSafeProperty(cmStrCat(lang, suffix)),
+                            '\n');
+      }
+
+      for (BT<std::string> const& define :
+           this->GetTargetDefines(target, config, lang)) {
+        context += cmStrCat("define=", define.Value, '\n');
+      }
+
+      std::vector<std::string> includes;
+      this->GetIncludeDirectories(includes, target, lang, config);
+      for (std::string const& include : includes) {
+        context += cmStrCat("include=", include, '\n');
+      }
+    }
+  }
+
+  if (context.empty()) {
+    return context;
+  }
+
+  for (const char* var : { "CMAKE_PCH_PROLOGUE", "CMAKE_PCH_EPILOGUE" }) {
+    context +=
+      cmStrCat(var, '=', this->Makefile->GetSafeDefinition(var), '\n');
+  }
+  for (const char* prop : { "PCH_WARN_INVALID", "PCH_INSTANTIATE_TEMPLATES" }) {
+    context += cmStrCat(prop, '=', target->GetPropertyAsBool(prop), '\n');
+  }
+  return context;
+}
+
 void cmLocalGenerator::CopyPchCompilePdb(
   const std::string& config, cmGeneratorTarget* target,
   const std::string& ReuseFrom, cmGeneratorTarget* reuseTarget,
@@ -2779,6 +2890,38 @@ inline void RegisterUnitySources(cmGeneratorTarget* target, cmSourceFile* sf,
   target->AddSourceFileToUnityBatch(sf->ResolveFullPath());
   sf->SetProperty("UNITY_SOURCE_FILE", filename.c_str());
 }
+
+struct UnityCostRecord
+{
+  unsigned long Batch;
+  double Cost;
+};
+
+// Read the unity batch and predicted cost of each source recorded by
+// a previous generation.
+std::map<std::string, UnityCostRecord> ReadUnityCosts(std::string const& path)
+{
+  std::map<std::string, UnityCostRecord> records;
+  cmsys::ifstream fin(path.c_str());
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    // Lines are of the form "<batch> <cost> <source>".
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::string::size_type const pos1 = line.find(' ');
+    std::string::size_type const pos2 = line.find(' ', pos1 + 1);
+    unsigned long batch;
+    if (pos2 == std::string::npos ||
+        !cmStrToULong(line.substr(0, pos1), &batch)) {
+      continue;
+    }
+    double const cost =
+      std::atof(line.substr(pos1 + 1, pos2 - pos1 - 1).c_str());
+    records[line.substr(pos2 + 1)] = { batch, cost };
+  }
+  return records;
+}
 }
 
 void cmLocalGenerator::IncludeFileInUnitySources(
@@ -2862,6 +3005,194 @@ std::vector<std::string> cmLocalGenerator::AddUnityFilesModeAuto(
   return unity_files;
 }
 
+std::vector<std::string> cmLocalGenerator::AddUnityFilesModeCost(
+  cmGeneratorTarget* target, std::string const& lang,
+  std::vector<cmSourceFile*> const& filtered_sources, cmProp beforeInclude,
+  cmProp afterInclude, std::string const& filename_base, size_t batchSize)
+{
+  std::vector<std::string> unity_files;
+  if (filtered_sources.empty()) {
+    return unity_files;
+  }
+  if (batchSize == 0) {
+    batchSize = filtered_sources.size();
+  }
+  size_t const batchCount =
+    (filtered_sources.size() + batchSize - 1) / batchSize;
+
+  cmProp uniqueIdName = target->GetProperty("UNITY_BUILD_UNIQUE_ID");
+  std::string const suffix = (lang == "C") ? "_c.c" : "_cxx.cxx";
+  std::string const costFile = cmStrCat(
+    filename_base, "unity", (lang == "C") ? "_c" : "_cxx", "_costs.txt");
+
+  // The batches of the previous generation and the costs predicted then.
+  std::map<std::string, UnityCostRecord> const previous =
+    ReadUnityCosts(costFile);
+  std::map<unsigned long, double> previousBatchCosts;
+  for (auto const& record : previous) {
+    previousBatchCosts[record.second.Batch] += record.second.Cost;
+  }
+
+  // The compile durations measured by the last Ninja build, either of
+  // the sources compiled alone or of the unity sources.  Other generators
+  // record no durations.
+  static std::map<std::string, double> const noDurations;
+  std::map<std::string, double> const& durations =
+    this->GlobalGenerator->IsNinja()
+    ? static_cast<cmGlobalNinjaGenerator*>(this->GlobalGenerator)
+        ->GetNinjaLogDurations()
+    : noDurations;
+  std::string const objectDir =
+    cmStrCat(this->MaybeConvertToRelativePath(this->GetBinaryDirectory(),
+                                              target->GetSupportDirectory()),
+             '/');
+  std::map<std::string, double> sourceDurations;
+  std::map<unsigned long, double> batchDurations;
+  for (auto const& duration : durations) {
+    if (!cmHasPrefix(duration.first, objectDir)) {
+      continue;
+    }
+    // Drop the object file extension.
+    std::string name = duration.first.substr(objectDir.size());
+    name = name.substr(0, name.rfind('.'));
+    unsigned long batch;
+    if (cmHasLiteralPrefix(name, "Unity/unity_") &&
+        cmHasSuffix(name, suffix) &&
+        cmStrToULong(name.substr(12, name.size() - 12 - suffix.size()),
+                     &batch)) {
+      batchDurations[batch] = duration.second;
+    } else {
+      sourceDurations[name] = duration.second;
+    }
+  }
+
+  // Predict the cost of compiling each source.
+  std::vector<std::string> paths;
+  std::vector<double> costs;
+  double knownCost = 0;
+  size_t knownCount = 0;
+  for (cmSourceFile* sf : filtered_sources) {
+    std::string const& path = sf->ResolveFullPath();
+    double cost = -1;
+    // Object names are relative to the source or binary directory,
+    // so try the longest trailing part of the path first.
+    for (std::string::size_type pos = path.find('/');
+         cost < 0 && pos != std::string::npos;
+         pos = path.find('/', pos + 1)) {
+      auto duration = sourceDurations.find(path.substr(pos + 1));
+      if (duration != sourceDurations.end()) {
+        cost = duration->second;
+      }
+    }
+    auto record = previous.find(path);
+    if (cost < 0 && record != previous.end()) {
+      // Share the measured cost of the batch that included the source
+      // in proportion to the costs predicted for its members.
+      auto duration = batchDurations.find(record->second.Batch);
+      double const batchCost = previousBatchCosts[record->second.Batch];
+      if (duration != batchDurations.end() && batchCost > 0) {
+        cost = duration->second * record->second.Cost / batchCost;
+      } else {
+        cost = record->second.Cost;
+      }
+    }
+    if (cost >= 0) {
+      knownCost += cost;
+      ++knownCount;
+    }
+    paths.push_back(path);
+    costs.push_back(cost);
+  }
+  for (size_t i = 0; i < costs.size(); ++i) {
+    if (costs[i] < 0) {
+      // Without any measurement use the size of the sources.
+      costs[i] = knownCount > 0
+        ? knownCost / static_cast<double>(knownCount)
+        : static_cast<double>(cmSystemTools::FileLength(paths[i]));
+    }
+    costs[i] = std::max(costs[i], 1.0);
+  }
+
+  // Place the given sources in the least loaded batches, most costly
+  // sources first.
+  std::vector<size_t> assignment(filtered_sources.size(), batchCount);
+  std::vector<double> loads(batchCount, 0);
+  auto pack = [&](std::vector<size_t> order) {
+    std::sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+      if (costs[l] != costs[r]) {
+        return costs[l] > costs[r];
+      }
+      return paths[l] < paths[r];
+    });
+    for (size_t i : order) {
+      size_t const batch = static_cast<size_t>(
+        std::min_element(loads.begin(), loads.end()) - loads.begin());
+      assignment[i] = batch;
+      loads[batch] += costs[i];
+    }
+  };
+
+  // Keep sources in the batches they were in before so that changing
+  // costs do not change the contents of all unity sources.  Repack all
+  // of them only if the batches became too unbalanced.
+  std::vector<size_t> unassigned;
+  for (size_t i = 0; i < filtered_sources.size(); ++i) {
+    auto record = previous.find(paths[i]);
+    if (record != previous.end() && record->second.Batch < batchCount) {
+      assignment[i] = record->second.Batch;
+      loads[assignment[i]] += costs[i];
+    } else {
+      unassigned.push_back(i);
+    }
+  }
+  pack(unassigned);
+  double const average =
+    std::accumulate(loads.begin(), loads.end(), 0.0) /
+    static_cast<double>(batchCount);
+  if (unassigned.size() != filtered_sources.size() &&
+      (*std::min_element(loads.begin(), loads.end()) <= 0 ||
+       *std::max_element(loads.begin(), loads.end()) > 1.25 * average)) {
+    std::vector<size_t> all(filtered_sources.size());
+    std::iota(all.begin(), all.end(), 0);
+    std::fill(loads.begin(), loads.end(), 0);
+    pack(all);
+  }
+
+  for (size_t batch = 0; batch < batchCount; ++batch) {
+    std::string filename = cmStrCat(filename_base, "unity_", batch, suffix);
+    const std::string filename_tmp = cmStrCat(filename, ".tmp");
+    {
+      cmGeneratedFileStream file(
+        filename_tmp, false,
+        target->GetGlobalGenerator()->GetMakefileEncoding());
+      file << "/* generated by CMake */\n\n";
+
+      for (size_t i = 0; i < filtered_sources.size(); ++i) {
+        if (assignment[i] != batch) {
+          continue;
+        }
+        cmSourceFile* sf = filtered_sources[i];
+        RegisterUnitySources(target, sf, filename);
+        IncludeFileInUnitySources(file, paths[i], beforeInclude,
+                                  afterInclude, uniqueIdName);
+      }
+    }
+    cmSystemTools::MoveFileIfDifferent(filename_tmp, filename);
+    unity_files.emplace_back(std::move(filename));
+  }
+
+  // Record the batches and costs for the next generation.
+  cmGeneratedFileStream fout(costFile);
+  fout.SetCopyIfDifferent(true);
+  fout << "# Unity batch and predicted cost of the " << lang
+       << " sources of target " << target->GetName() << "\n";
+  for (size_t i = 0; i < filtered_sources.size(); ++i) {
+    fout << assignment[i] << ' ' << costs[i] << ' ' << paths[i] << '\n';
+  }
+
+  return unity_files;
+}
+
 std::vector<std::string> cmLocalGenerator::AddUnityFilesModeGroup(
   cmGeneratorTarget* target, std::string const& lang,
   std::vector<cmSourceFile*> const& filtered_sources, cmProp beforeInclude,
@@ -2963,11 +3294,15 @@ void cmLocalGenerator::AddUnityBuild(cmGeneratorTarget* target)
       unity_files =
         AddUnityFilesModeGroup(target, lang, filtered_sources, beforeInclude,
                                afterInclude, filename_base);
+    } else if (unityMode && *unityMode == "COST") {
+      unity_files =
+        AddUnityFilesModeCost(target, lang, filtered_sources, beforeInclude,
+                              afterInclude, filename_base, unityBatchSize);
     } else {
       // unity mode is set to an unsupported value
       std::string e("Invalid UNITY_BUILD_MODE value of " + *unityMode +
                     " assigned to target " + target->GetName() +
-                    ". Acceptable values are BATCH and GROUP.");
+                    ". Acceptable values are BATCH, COST and GROUP.");
       this->IssueMessage(MessageType::FATAL_ERROR, e);
     }
 
@@ -163,6 +163,14 @@ public:
                                 const std::string& rawFlag) const;
   void AddISPCDependencies(cmGeneratorTarget* target);
   void AddPchDependencies(cmGeneratorTarget* target);
+  /**
+   * Describe everything that affects the precompiled headers of the given
+   * target.  Targets with equal descriptions can share their precompiled
+   * headers.  Returns an empty string if the target has none, and sets
+   * 'pchBuilds' to the number of precompiled headers it builds.
+   */
+  std::string GetPchCompileContext(cmGeneratorTarget* target,
+                                   unsigned int& pchBuilds);
   void AddUnityBuild(cmGeneratorTarget* target);
   void AppendIPOLinkerFlags(std::string& flags, cmGeneratorTarget* target,
                             const std::string& config,
@@ -666,6 +674,10 @@ private:
     cmGeneratorTarget* target, std::string const& lang,
     std::vector<cmSourceFile*> const& filtered_sources, cmProp beforeInclude,
     cmProp afterInclude, std::string const& filename_base, size_t batchSize);
+  std::vector<std::string> AddUnityFilesModeCost(
+    cmGeneratorTarget* target, std::string const& lang,
+    std::vector<cmSourceFile*> const& filtered_sources, cmProp beforeInclude,
+    cmProp afterInclude, std::string const& filename_base, size_t batchSize);
   std::vector<std::string> AddUnityFilesModeGroup(
     cmGeneratorTarget* target, std::string const& lang,
     std::vector<cmSourceFile*> const& filtered_sources, cmProp beforeInclude,
@@ -110,6 +110,15 @@ void cmLocalNinjaGenerator::Generate()
     }
   }
 
+  if (!this->GetGlobalNinjaGenerator()->OpenDirectoryBuildFileStream(this)) {
+    this->IssueMessage(
+      MessageType::FATAL_ERROR,
+      cmStrCat("Could not open the build file of directory\n  ",
+               this->GetCurrentBinaryDirectory(),
+               "\nfor writing.  No build statements were generated for it."));
+    return;
+  }
+
   for (const auto& target : this->GetGeneratorTargets()) {
     if (!target->IsInBuildSystem()) {
       continue;
@@ -170,6 +179,8 @@ void cmLocalNinjaGenerator::Generate()
     this->WriteCustomCommandBuildStatements(config);
     this->AdditionalCleanFiles(config);
   }
+
+  this->GetGlobalNinjaGenerator()->CloseDirectoryBuildFileStream();
 }
 
 // TODO: Picked up from cmLocalUnixMakefileGenerator3.  Refactor it.
@@ -951,8 +951,9 @@ void cmMakefileTargetGenerator::WriteObjectRuleFiles(
         }
       }
 
-      this->GlobalGenerator->AddCXXCompileCommand(
-        source.GetFullPath(), workingDirectory, compileCommand);
+      this->GlobalGenerator->AddCompileCommand(
+        this->LocalGenerator, source.GetFullPath(), workingDirectory,
+        compileCommand);
     }
 
     // See if we need to use a compiler launcher like ccache or distcc
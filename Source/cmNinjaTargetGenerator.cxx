@@ -3,6 +3,7 @@
 #include "cmNinjaTargetGenerator.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <iterator>
 #include <map>
@@ -28,6 +29,7 @@
 #include "cmLocalGenerator.h"
 #include "cmLocalNinjaGenerator.h"
 #include "cmMakefile.h"
+#include "cmMessageType.h"
 #include "cmNinjaNormalTargetGenerator.h"
 #include "cmNinjaUtilityTargetGenerator.h"
 #include "cmOutputConverter.h"
@@ -126,6 +128,15 @@ std::string cmNinjaTargetGenerator::LanguageScanRule(
     '_', config);
 }
 
+std::string cmNinjaTargetGenerator::LanguageScanBatchRule(
+  std::string const& lang, const std::string& config) const
+{
+  return cmStrCat(
+    lang, "_SCAN_BATCH__",
+    cmGlobalNinjaGenerator::EncodeRuleName(this->GeneratorTarget->GetName()),
+    '_', config);
+}
+
 bool cmNinjaTargetGenerator::NeedExplicitPreprocessing(
   std::string const& lang) const
 {
@@ -711,6 +722,27 @@ void cmNinjaTargetGenerator::WriteCompileRule(const std::string& lang,
         cmStrCat("Generating ", lang, " dependencies for $in");
 
       this->GetGlobalGenerator()->AddRule(scanRule);
+
+      if (this->BatchDependencyScan()) {
+        // Rule to scan all such sources of the target with one process.
+        cmNinjaRule batchRule(this->LanguageScanBatchRule(lang, config));
+        batchRule.DepType = ""; // no deps= for multiple outputs
+        batchRule.DepFile = "$DEP_FILE";
+        std::vector<std::string> batchCommands;
+        batchCommands.emplace_back(
+          cmStrCat(cmakeCmd, " -E cmake_ninja_depends --tdi=", tdi,
+                   " --lang=", lang, " --batch=$SCAN_BATCH_FILE",
+                   " --dep=$DEP_FILE"));
+        batchRule.Command = this->GetLocalGenerator()->BuildCommandLine(
+          batchCommands, config, config);
+        batchRule.Comment =
+          cmStrCat("Rule for generating ", lang,
+                   " dependencies on non-preprocessed files in one batch.");
+        batchRule.Description = cmStrCat(
+          "Generating ", lang, " dependencies for target ",
+          this->GetGeneratorTarget()->GetName());
+        this->GetGlobalGenerator()->AddRule(batchRule);
+      }
     }
 
     // Write the rule for ninja dyndep file generation.
@@ -740,6 +772,8 @@ void cmNinjaTargetGenerator::WriteCompileRule(const std::string& lang,
     rule.Comment =
       cmStrCat("Rule to generate ninja dyndep files for ", lang, '.');
     rule.Description = cmStrCat("Generating ", lang, " dyndep file $out");
+    // The dyndep file is only replaced when the module map changes.
+    rule.Restat = "1";
     this->GetGlobalGenerator()->AddRule(rule);
   }
 
@@ -1045,17 +1079,28 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatements(
     std::vector<cmSourceFile const*> objectSources;
     this->GeneratorTarget->GetObjectSources(objectSources, config);
 
+    if (this->ShareCompileVariables()) {
+      this->WriteSharedObjectVariables(objectSources, config, fileConfig);
+    }
+
     for (cmSourceFile const* sf : objectSources) {
       this->WriteObjectBuildStatement(sf, config, fileConfig, firstForConfig);
     }
   }
 
+  for (auto const& langScanBatch : this->Configs[config].ScanBatches) {
+    this->WriteScanBatchBuild(langScanBatch.first, config, fileConfig,
+                              langScanBatch.second);
+  }
+
   for (auto const& langDDIFiles : this->Configs[config].DDIFiles) {
     std::string const& language = langDDIFiles.first;
     cmNinjaDeps const& ddiFiles = langDDIFiles.second;
 
     cmNinjaBuild build(this->LanguageDyndepRule(language, config));
     build.Outputs.push_back(this->GetDyndepFilePath(language, config));
+    // The scan results collated so far are cached next to the dyndep file.
+    build.ImplicitOuts.push_back(cmStrCat(build.Outputs.back(), ".cache"));
     build.ExplicitDeps = ddiFiles;
 
     this->WriteTargetDependInfo(language, config);
@@ -1103,6 +1148,104 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatements(
   }
 }
 
+void cmNinjaTargetGenerator::WriteSharedObjectVariables(
+  std::vector<cmSourceFile const*> const& objectSources,
+  const std::string& config, const std::string& fileConfig)
+{
+  static std::array<std::string, 3> const names = { { "FLAGS", "DEFINES",
+                                                      "INCLUDES" } };
+
+  ByConfig& byConfig = this->Configs[config];
+  byConfig.ObjectVariables.clear();
+  byConfig.SharedVariables.clear();
+
+  // Count how many objects of each language use each variable value.
+  std::vector<std::string> languages;
+  std::map<std::string, std::map<std::string, std::map<std::string, int>>>
+    counts;
+  for (cmSourceFile const* sf : objectSources) {
+    std::string const& language = sf->GetLanguage();
+    if (language.empty() || language == "Swift") {
+      continue;
+    }
+    cmNinjaVars& vars = byConfig.ObjectVariables[sf];
+    vars["FLAGS"] = this->ComputeFlagsForObject(sf, language, config);
+    vars["DEFINES"] = this->ComputeDefines(sf, language, config);
+    vars["INCLUDES"] = this->ComputeIncludes(sf, language, config);
+    if (counts.find(language) == counts.end()) {
+      languages.push_back(language);
+    }
+    for (std::string const& name : names) {
+      ++counts[language][name][vars[name]];
+    }
+  }
+
+  // Write the most common value of each variable once.  Objects with
+  // source-specific values keep their own.
+  cmGeneratedFileStream& os = this->GetImplFileStream(fileConfig);
+  for (std::string const& language : languages) {
+    bool first = true;
+    for (std::string const& name : names) {
+      auto const& valueCounts = counts[language][name];
+      auto best = std::max_element(
+        valueCounts.begin(), valueCounts.end(),
+        [](std::pair<std::string const, int> const& l,
+           std::pair<std::string const, int> const& r) {
+          return l.second < r.second;
+        });
+      if (best->second < 2 || cmTrimWhitespace(best->first).empty()) {
+        continue;
+      }
+      if (first) {
+        cmGlobalNinjaGenerator::WriteComment(
+          os,
+          cmStrCat("Compile variables shared by the ", language,
+                   " objects of target ", this->GetTargetName()));
+        first = false;
+      }
+      cmGlobalNinjaGenerator::WriteVariable(
+        os, this->SharedObjectVariableName(language, name, config),
+        best->first);
+      byConfig.SharedVariables[language][name] = best->first;
+    }
+    if (!first) {
+      os << "\n";
+    }
+  }
+}
+
+void cmNinjaTargetGenerator::UseSharedObjectVariables(
+  std::string const& language, const std::string& config,
+  cmNinjaVars& vars) const
+{
+  auto byConfig = this->Configs.find(config);
+  if (byConfig == this->Configs.end()) {
+    return;
+  }
+  auto shared = byConfig->second.SharedVariables.find(language);
+  if (shared == byConfig->second.SharedVariables.end()) {
+    return;
+  }
+  for (auto const& var : shared->second) {
+    auto it = vars.find(var.first);
+    if (it != vars.end() && it->second == var.second) {
+      it->second = cmStrCat(
+        "${", this->SharedObjectVariableName(language, var.first, config),
+        '}');
+    }
+  }
+}
+
+std::string cmNinjaTargetGenerator::SharedObjectVariableName(
+  std::string const& language, std::string const& name,
+  const std::string& config) const
+{
+  return cmStrCat(
+    language, '_', name, "__",
+    cmGlobalNinjaGenerator::EncodeRuleName(this->GeneratorTarget->GetName()),
+    '_', config);
+}
+
 namespace {
 cmNinjaBuild GetScanBuildStatement(const std::string& ruleName,
                                    const std::string& ppFileName,
@@ -1221,9 +1364,16 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatement(
 
   cmNinjaBuild objBuild(this->LanguageCompilerRule(language, config));
   cmNinjaVars& vars = objBuild.Variables;
-  vars["FLAGS"] = this->ComputeFlagsForObject(source, language, config);
-  vars["DEFINES"] = this->ComputeDefines(source, language, config);
-  vars["INCLUDES"] = this->ComputeIncludes(source, language, config);
+  auto& objectVariables = this->Configs[config].ObjectVariables;
+  auto precomputed = objectVariables.find(source);
+  if (precomputed != objectVariables.end()) {
+    vars = std::move(precomputed->second);
+    objectVariables.erase(precomputed);
+  } else {
+    vars["FLAGS"] = this->ComputeFlagsForObject(source, language, config);
+    vars["DEFINES"] = this->ComputeDefines(source, language, config);
+    vars["INCLUDES"] = this->ComputeIncludes(source, language, config);
+  }
 
   if (this->GetMakefile()->GetSafeDefinition(
         cmStrCat("CMAKE_", language, "_DEPFILE_FORMAT")) != "msvc"_s) {
@@ -1394,11 +1544,22 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatement(
       this->Configs[config].DDIFiles[language].push_back(ddiFile);
     }
 
-    this->addPoolNinjaVariable("JOB_POOL_COMPILE", this->GetGeneratorTarget(),
-                               ppBuild.Variables);
+    if (!compilationPreprocesses && !compilePP &&
+        this->BatchDependencyScan()) {
+      // The source is scanned together with the others of the target.
+      if (firstForConfig) {
+        this->Configs[config].ScanBatches[language].push_back(
+          std::move(ppBuild));
+      }
+    } else {
+      this->addPoolNinjaVariable("JOB_POOL_COMPILE",
+                                 this->GetGeneratorTarget(),
+                                 ppBuild.Variables);
 
-    this->GetGlobalGenerator()->WriteBuild(this->GetImplFileStream(fileConfig),
-                                           ppBuild, commandLineLengthLimit);
+      this->UseSharedObjectVariables(language, config, ppBuild.Variables);
+      this->GetGlobalGenerator()->WriteBuild(
+        this->GetImplFileStream(fileConfig), ppBuild, commandLineLengthLimit);
+    }
 
     std::string const dyndep = this->GetDyndepFilePath(language, config);
     objBuild.OrderOnlyDeps.push_back(dyndep);
@@ -1493,6 +1654,7 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatement(
   if (language == "Swift") {
     this->EmitSwiftDependencyInfo(source, config);
   } else {
+    this->UseSharedObjectVariables(language, config, vars);
     this->GetGlobalGenerator()->WriteBuild(this->GetImplFileStream(fileConfig),
                                            objBuild, commandLineLengthLimit);
   }
@@ -1514,6 +1676,58 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatement(
   }
 }
 
+void cmNinjaTargetGenerator::WriteScanBatchBuild(
+  std::string const& lang, const std::string& config,
+  const std::string& fileConfig, std::vector<cmNinjaBuild> const& scanBuilds)
+{
+  std::string const batchFile = cmStrCat(
+    cmSystemTools::GetFilenamePath(this->GetTargetDependInfoPath(lang, config)),
+    '/', lang, "ScanBatch.json");
+  std::string const batchPath = this->ConvertToNinjaPath(batchFile);
+
+  // List the sources to scan along with the files to produce for each,
+  // as the per-source build statements would have passed them.
+  Json::Value batch = Json::arrayValue;
+  cmNinjaBuild build(this->LanguageScanBatchRule(lang, config));
+  build.Comment = cmStrCat("Scan the ", lang, " sources of target ",
+                           this->GetGeneratorTarget()->GetName(),
+                           " for dependencies.");
+  for (cmNinjaBuild const& scanBuild : scanBuilds) {
+    Json::Value& entry = batch.append(Json::objectValue);
+    entry["src"] = scanBuild.ExplicitDeps.front();
+    entry["obj"] = scanBuild.Variables.at("OBJ_FILE");
+    entry["ddi"] = scanBuild.Outputs.front();
+    cm::append(build.Outputs, scanBuild.Outputs);
+    cm::append(build.ImplicitOuts, scanBuild.ImplicitOuts);
+    cm::append(build.ExplicitDeps, scanBuild.ExplicitDeps);
+    cm::append(build.ImplicitDeps, scanBuild.ImplicitDeps);
+    cm::append(build.OrderOnlyDeps, scanBuild.OrderOnlyDeps);
+  }
+  for (cmNinjaDeps* deps : { &build.ImplicitDeps, &build.OrderOnlyDeps }) {
+    std::sort(deps->begin(), deps->end());
+    deps->erase(std::unique(deps->begin(), deps->end()), deps->end());
+  }
+  {
+    cmGeneratedFileStream bf(batchFile);
+    bf.SetCopyIfDifferent(true);
+    bf << batch;
+  }
+
+  // Rescan when the list of sources changes.
+  build.ImplicitDeps.push_back(batchPath);
+  build.Variables["SCAN_BATCH_FILE"] =
+    this->GetLocalGenerator()->ConvertToOutputFormat(
+      batchPath, cmOutputConverter::SHELL);
+  build.Variables["DEP_FILE"] =
+    this->GetLocalGenerator()->ConvertToOutputFormat(
+      cmStrCat(batchPath, ".d"), cmOutputConverter::SHELL);
+  this->addPoolNinjaVariable("JOB_POOL_COMPILE", this->GetGeneratorTarget(),
+                             build.Variables);
+
+  this->GetGlobalGenerator()->WriteBuild(this->GetImplFileStream(fileConfig),
+                                         build);
+}
+
 void cmNinjaTargetGenerator::WriteTargetDependInfo(std::string const& lang,
                                                    const std::string& config)
 {
@@ -1687,7 +1901,8 @@ void cmNinjaTargetGenerator::ExportObjectCompileCommand(
   std::string cmdLine = this->GetLocalGenerator()->BuildCommandLine(
     compileCmds, outputConfig, outputConfig);
 
-  this->GetGlobalGenerator()->AddCXXCompileCommand(cmdLine, sourceFileName);
+  this->GetGlobalGenerator()->AddCXXCompileCommand(this->GetLocalGenerator(),
+                                                   cmdLine, sourceFileName);
 }
 
 void cmNinjaTargetGenerator::AdditionalCleanFiles(const std::string& config)
@@ -1785,6 +2000,37 @@ void cmNinjaTargetGenerator::addPoolNinjaVariable(
   cmProp pool = target->GetProperty(pool_property);
   if (pool) {
     vars["pool"] = *pool;
+    return;
+  }
+
+  // Without an explicit pool, use an automatic one sized from the
+  // memory each job of this target is known or assumed to need.  This
+  // is computed once per target, so that an invalid value is reported
+  // only once.
+  auto it = this->AutoJobPools.find(pool_property);
+  if (it == this->AutoJobPools.end()) {
+    it = this->AutoJobPools.emplace(pool_property, std::string()).first;
+    std::string const memoryProperty = cmStrCat(pool_property, "_MEMORY");
+    unsigned long mib = 0;
+    if (cmProp memory = target->GetProperty(memoryProperty)) {
+      if (!cmStrToULong(*memory, &mib)) {
+        this->GetLocalGenerator()->IssueMessage(
+          MessageType::FATAL_ERROR,
+          cmStrCat("Target \"", target->GetName(), "\" property ",
+                   memoryProperty, " value \"", *memory,
+                   "\" is not a non-negative integer number of MiB."));
+        return;
+      }
+    } else if (pool_property == "JOB_POOL_COMPILE") {
+      mib = 1024;
+    } else if (pool_property == "JOB_POOL_LINK") {
+      mib = 4096;
+    }
+    it->second =
+      this->GetGlobalGenerator()->GetAutoJobPool(pool_property, mib);
+  }
+  if (!it->second.empty()) {
+    vars["pool"] = it->second;
   }
 }
 
@@ -1794,3 +2040,13 @@ bool cmNinjaTargetGenerator::ForceResponseFile()
   return (this->GetMakefile()->IsDefinitionSet(forceRspFile) ||
           cmSystemTools::HasEnv(forceRspFile));
 }
+
+bool cmNinjaTargetGenerator::ShareCompileVariables()
+{
+  return this->GetMakefile()->IsOn("CMAKE_NINJA_SHARED_COMPILE_VARIABLES");
+}
+
+bool cmNinjaTargetGenerator::BatchDependencyScan() const
+{
+  return this->GetMakefile()->IsOn("CMAKE_NINJA_BATCH_DEPENDENCY_SCAN");
+}
@@ -69,6 +69,8 @@ protected:
                                             const std::string& config) const;
   std::string LanguageScanRule(std::string const& lang,
                                const std::string& config) const;
+  std::string LanguageScanBatchRule(std::string const& lang,
+                                    const std::string& config) const;
   std::string LanguageDyndepRule(std::string const& lang,
                                  const std::string& config) const;
   bool NeedDyndep(std::string const& lang, std::string const& config) const;
@@ -152,8 +154,20 @@ protected:
                                  const std::string& config,
                                  const std::string& fileConfig,
                                  bool firstForConfig);
+  void WriteSharedObjectVariables(
+    std::vector<cmSourceFile const*> const& objectSources,
+    const std::string& config, const std::string& fileConfig);
+  void UseSharedObjectVariables(std::string const& language,
+                                const std::string& config,
+                                cmNinjaVars& vars) const;
+  std::string SharedObjectVariableName(std::string const& language,
+                                       std::string const& name,
+                                       const std::string& config) const;
   void WriteTargetDependInfo(std::string const& lang,
                              const std::string& config);
+  void WriteScanBatchBuild(std::string const& lang, const std::string& config,
+                           const std::string& fileConfig,
+                           std::vector<cmNinjaBuild> const& scanBuilds);
 
   void EmitSwiftDependencyInfo(cmSourceFile const* source,
                                const std::string& config);
@@ -200,6 +214,8 @@ protected:
                             cmGeneratorTarget* target, cmNinjaVars& vars);
 
   bool ForceResponseFile();
+  bool ShareCompileVariables();
+  bool BatchDependencyScan() const;
 
 private:
   cmLocalNinjaGenerator* LocalGenerator;
@@ -210,12 +226,23 @@ private:
     cmNinjaDeps Objects;
     // Fortran Support
     std::map<std::string, cmNinjaDeps> DDIFiles;
+    // Scan build statements of each language, if the sources of the
+    // target are scanned together by one process.
+    std::map<std::string, std::vector<cmNinjaBuild>> ScanBatches;
     // Swift Support
     Json::Value SwiftOutputMap;
     std::vector<cmCustomCommand const*> CustomCommands;
     cmNinjaDeps ExtraFiles;
     std::unique_ptr<MacOSXContentGeneratorType> MacOSXContentGenerator;
+    // Compile variables of each object source, computed up front when
+    // the values common to a target are written once.
+    std::map<cmSourceFile const*, cmNinjaVars> ObjectVariables;
+    // Compile variable values written once for each language.
+    std::map<std::string, cmNinjaVars> SharedVariables;
   };
 
   std::map<std::string, ByConfig> Configs;
+
+  // Automatic pool of each JOB_POOL_* property, computed on first use.
+  std::map<std::string, std::string> AutoJobPools;
 };
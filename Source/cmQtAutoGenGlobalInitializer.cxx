@@ -6,10 +6,12 @@
 #include <utility>
 
 #include <cm/memory>
+#include <cmext/algorithm>
 
 #include "cmCustomCommandLines.h"
 #include "cmDuration.h"
 #include "cmGeneratorTarget.h"
+#include "cmGlobalGenerator.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
@@ -61,6 +63,10 @@ cmQtAutoGenGlobalInitializer::cmQtAutoGenGlobalInitializer(
         this->GlobalAutoGenTargets_.emplace(localGen.get(),
                                             std::move(targetName));
         globalAutoGenTarget = true;
+        // Detect global autogen batch processing
+        if (makefile->IsOn("CMAKE_GLOBAL_AUTOGEN_TARGET_BATCH")) {
+          this->GlobalAutoGenBatches_[localGen.get()];
+        }
       }
 
       // Detect global autorcc target name
@@ -163,7 +169,8 @@ cmQtAutoGenGlobalInitializer::~cmQtAutoGenGlobalInitializer() = default;
 
 void cmQtAutoGenGlobalInitializer::GetOrCreateGlobalTarget(
   cmLocalGenerator* localGen, std::string const& name,
-  std::string const& comment)
+  std::string const& comment, std::vector<std::string> const& depends,
+  cmCustomCommandLines const& commandLines)
 {
   // Test if the target already exists
   if (localGen->FindGeneratorTargetToUse(name) == nullptr) {
@@ -171,12 +178,10 @@ void cmQtAutoGenGlobalInitializer::GetOrCreateGlobalTarget(
 
     // Create utility target
     std::vector<std::string> no_byproducts;
-    std::vector<std::string> no_depends;
-    cmCustomCommandLines no_commands;
     const cmPolicies::PolicyStatus cmp0116_new = cmPolicies::NEW;
     cmTarget* target = localGen->AddUtilityCommand(
       name, true, makefile->GetHomeOutputDirectory().c_str(), no_byproducts,
-      no_depends, no_commands, cmp0116_new, false, comment.c_str());
+      depends, commandLines, cmp0116_new, false, comment.c_str());
     localGen->AddGeneratorTarget(
       cm::make_unique<cmGeneratorTarget>(target, localGen));
 
@@ -192,8 +197,17 @@ void cmQtAutoGenGlobalInitializer::GetOrCreateGlobalTarget(
 }
 
 void cmQtAutoGenGlobalInitializer::AddToGlobalAutoGen(
-  cmLocalGenerator* localGen, std::string const& targetName)
+  cmLocalGenerator* localGen, std::string const& targetName,
+  std::string const& infoFile, std::set<std::string> const& depends)
 {
+  // A batch target processes the info file itself
+  auto bit = this->GlobalAutoGenBatches_.find(localGen);
+  if (bit != this->GlobalAutoGenBatches_.end()) {
+    bit->second.InfoFiles.push_back(infoFile);
+    bit->second.Depends.insert(depends.begin(), depends.end());
+    return;
+  }
+
   auto it = this->GlobalAutoGenTargets_.find(localGen);
   if (it != this->GlobalAutoGenTargets_.end()) {
     cmGeneratorTarget* target = localGen->FindGeneratorTargetToUse(it->second);
@@ -273,18 +287,25 @@ bool cmQtAutoGenGlobalInitializer::generate()
 
 bool cmQtAutoGenGlobalInitializer::InitializeCustomTargets()
 {
+  std::vector<std::string> const no_depends;
+  cmCustomCommandLines const no_commands;
   // Initialize global autogen targets
   {
     std::string const comment = "Global AUTOGEN target";
     for (auto const& pair : this->GlobalAutoGenTargets_) {
-      this->GetOrCreateGlobalTarget(pair.first, pair.second, comment);
+      // Batch targets are created when all info files are known
+      if (this->GlobalAutoGenBatches_.count(pair.first) == 0) {
+        this->GetOrCreateGlobalTarget(pair.first, pair.second, comment,
+                                      no_depends, no_commands);
+      }
     }
   }
   // Initialize global autorcc targets
   {
     std::string const comment = "Global AUTORCC target";
     for (auto const& pair : this->GlobalAutoRccTargets_) {
-      this->GetOrCreateGlobalTarget(pair.first, pair.second, comment);
+      this->GetOrCreateGlobalTarget(pair.first, pair.second, comment,
+                                    no_depends, no_commands);
     }
   }
   // Initialize per target autogen targets
@@ -293,6 +314,31 @@ bool cmQtAutoGenGlobalInitializer::InitializeCustomTargets()
       return false;
     }
   }
+  // Initialize global autogen batch targets
+  {
+    std::string const comment = "Automatic MOC and UIC for all targets";
+    for (auto const& pair : this->GlobalAutoGenBatches_) {
+      cmLocalGenerator* localGen = pair.first;
+      GlobalAutoGenBatch const& batch = pair.second;
+      cmCustomCommandLines commandLines;
+      if (!batch.InfoFiles.empty()) {
+        std::vector<std::string> configs;
+        localGen->GetGlobalGenerator()->GetQtAutoGenConfigs(configs);
+        for (std::string const& config : configs) {
+          cmCustomCommandLine command =
+            cmMakeCommandLine({ cmSystemTools::GetCMakeCommand(), "-E",
+                                "cmake_autogen_batch", config });
+          cm::append(command, batch.InfoFiles);
+          commandLines.push_back(std::move(command));
+        }
+      }
+      std::vector<std::string> const depends(batch.Depends.begin(),
+                                             batch.Depends.end());
+      this->GetOrCreateGlobalTarget(localGen,
+                                    this->GlobalAutoGenTargets_[localGen],
+                                    comment, depends, commandLines);
+    }
+  }
   return true;
 }
 
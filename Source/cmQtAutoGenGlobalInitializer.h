@@ -6,12 +6,14 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "cmQtAutoGen.h"
 
+class cmCustomCommandLines;
 class cmLocalGenerator;
 class cmQtAutoGenInitializer;
 
@@ -61,10 +63,14 @@ private:
 
   void GetOrCreateGlobalTarget(cmLocalGenerator* localGen,
                                std::string const& name,
-                               std::string const& comment);
+                               std::string const& comment,
+                               std::vector<std::string> const& depends,
+                               cmCustomCommandLines const& commandLines);
 
   void AddToGlobalAutoGen(cmLocalGenerator* localGen,
-                          std::string const& targetName);
+                          std::string const& targetName,
+                          std::string const& infoFile,
+                          std::set<std::string> const& depends);
   void AddToGlobalAutoRcc(cmLocalGenerator* localGen,
                           std::string const& targetName);
 
@@ -74,6 +80,13 @@ private:
 
   std::vector<std::unique_ptr<cmQtAutoGenInitializer>> Initializers_;
   std::map<cmLocalGenerator*, std::string> GlobalAutoGenTargets_;
+  /// @brief Global autogen target that processes all targets in one batch
+  struct GlobalAutoGenBatch
+  {
+    std::vector<std::string> InfoFiles;
+    std::set<std::string> Depends;
+  };
+  std::map<cmLocalGenerator*, GlobalAutoGenBatch> GlobalAutoGenBatches_;
   std::map<cmLocalGenerator*, std::string> GlobalAutoRccTargets_;
   std::unordered_map<std::string, cmQtAutoGen::CompilerFeaturesHandle>
     CompilerFeatures_;
@@ -1316,8 +1316,20 @@ bool cmQtAutoGenInitializer::InitAutogenTarget()
 
     // Add autogen target to the global autogen target dependencies
     if (this->AutogenTarget.GlobalTarget) {
-      this->GlobalInitializer->AddToGlobalAutoGen(this->LocalGen,
-                                                  this->AutogenTarget.Name);
+      // A global batch target depends on what the autogen target depends on
+      std::set<std::string> globalDepends(
+        this->AutogenTarget.DependFiles.begin(),
+        this->AutogenTarget.DependFiles.end());
+      for (cmTarget const* depTarget : this->AutogenTarget.DependTargets) {
+        globalDepends.insert(depTarget->GetName());
+      }
+      for (BT<std::pair<std::string, bool>> const& depName :
+           autogenTarget->GetUtilities()) {
+        globalDepends.insert(depName.Value.first);
+      }
+      this->GlobalInitializer->AddToGlobalAutoGen(
+        this->LocalGen, this->AutogenTarget.Name, this->AutogenTarget.InfoFile,
+        globalDepends);
     }
   }
 
@@ -428,6 +428,12 @@ std::string cmQtAutoGenerator::MessagePath(cm::string_view path) const
 }
 
 bool cmQtAutoGenerator::Run(cm::string_view infoFile, cm::string_view config)
+{
+  // Read the info file and call the virtual process method.
+  return this->Init(infoFile, config) && this->Process();
+}
+
+bool cmQtAutoGenerator::Init(cm::string_view infoFile, cm::string_view config)
 {
   // Info config
   this->InfoConfig_ = std::string(config);
@@ -490,6 +496,5 @@ bool cmQtAutoGenerator::Run(cm::string_view infoFile, cm::string_view config)
     }
   }
 
-  // Call virtual process method.
-  return this->Process();
+  return true;
 }
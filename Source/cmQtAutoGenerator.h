@@ -152,6 +152,8 @@ public:
 
   // -- Run
   bool Run(cm::string_view infoFile, cm::string_view config);
+  /** Read the info file without processing.  */
+  bool Init(cm::string_view infoFile, cm::string_view config);
 
 protected:
   // -- Abstract processing interface
@@ -178,6 +178,8 @@ public:
     std::string CMakeExecutable;
     cmFileTime CMakeExecutableTime;
     std::string ParseCacheFile;
+    // Hash of the settings that file parse results depend on
+    std::string ParseKey;
     std::string DepFile;
     std::string DepFileRuleName;
     std::vector<std::string> HeaderExtensions;
@@ -307,10 +309,7 @@ public:
     }
 
     //! Get the generator. Only valid during Process() call!
-    cmQtAutoMocUicT* Gen() const
-    {
-      return static_cast<cmQtAutoMocUicT*>(this->UserData());
-    };
+    cmQtAutoMocUicT* Gen() const { return this->Gen_; }
 
     // -- Accessors. Only valid during Process() call!
     Logger const& Log() const { return this->Gen()->Log(); }
@@ -336,6 +335,12 @@ public:
     bool RunProcess(GenT genType, cmWorkerPool::ProcessResultT& result,
                     std::vector<std::string> const& command,
                     std::string* infoMessage = nullptr);
+
+  private:
+    //! Needs access to Gen_
+    friend class cmQtAutoMocUicT;
+
+    cmQtAutoMocUicT* Gen_ = nullptr;
   };
 
   /** Fence job utility class.  */
@@ -352,8 +357,18 @@ public:
   /** Generate moc_predefs.h.  */
   class JobMocPredefsT : public JobFenceT
   {
+  public:
+    JobMocPredefsT(std::vector<cmQtAutoMocUicT*> gens)
+      : Gens(std::move(gens))
+    {
+    }
+
+  private:
     void Process() override;
-    bool Update(std::string* reason) const;
+    static bool Update(cmQtAutoMocUicT* gen, std::string* reason);
+
+    // Generators with the same moc_predefs.h content
+    std::vector<cmQtAutoMocUicT*> Gens;
   };
 
   /** File parse job base class.  */
@@ -528,6 +543,39 @@ public:
     void Process() override;
   };
 
+  /** State shared by the generators of a batch.  */
+  class BatchT
+  {
+  public:
+    cmWorkerPool WorkerPool;
+    std::atomic<std::size_t> Running = ATOMIC_VAR_INIT(0);
+    std::mutex CMakeLibMutex;
+    // Files that are parsed by a job, by parse settings and file name
+    std::unordered_map<std::string, ParseCacheT::FileHandleT> Parsed;
+    // Parse data to copy from the parsed file once all parse jobs are done
+    std::vector<std::pair<ParseCacheT::FileHandleT, ParseCacheT::FileHandleT>>
+      ParsedCopies;
+  };
+
+  /** Batch: Copy the shared parse data once all parse jobs are done.  */
+  class JobBatchParseFinishT : public cmWorkerPool::JobFenceT
+  {
+  public:
+    JobBatchParseFinishT(BatchT& batch)
+      : Batch(batch)
+    {
+    }
+
+  private:
+    void Process() override;
+
+    BatchT& Batch;
+  };
+
+  /** Process the generators of several info files in one worker pool.  */
+  static bool RunBatch(std::vector<std::string> const& infoFiles,
+                       cm::string_view config);
+
   // -- Const settings interface
   BaseSettingsT const& BaseConst() const { return this->BaseConst_; }
   BaseEvalT& BaseEval() { return this->BaseEval_; }
@@ -537,7 +585,19 @@ public:
   UicEvalT& UicEval() { return this->UicEval_; }
 
   // -- Parallel job processing interface
-  cmWorkerPool& WorkerPool() { return this->WorkerPool_; }
+  cmWorkerPool& WorkerPool()
+  {
+    return (this->Batch_ != nullptr) ? this->Batch_->WorkerPool
+                                     : this->WorkerPool_;
+  }
+  template <class JOBTYPE, typename... Args>
+  void EmplaceJob(Args&&... args)
+  {
+    auto job = cm::make_unique<JOBTYPE>(std::forward<Args>(args)...);
+    job->Gen_ = this;
+    job->SetFenceGroup(this);
+    this->WorkerPool().PushJob(std::move(job));
+  }
   void AbortError() { this->Abort(true); }
   void AbortSuccess() { this->Abort(false); }
 
@@ -551,8 +611,11 @@ public:
 private:
   // -- Abstract processing interface
   bool InitFromInfo(InfoT const& info) override;
-  void InitJobs();
+  bool Prepare();
+  void InitParseJobs();
+  void InitEvalJobs();
   bool Process() override;
+  bool Complete();
   // -- Settings file
   void SettingsFileRead();
   bool SettingsFileWrite();
@@ -579,8 +642,15 @@ private:
   std::string SettingsStringUic_;
   // -- Worker thread pool
   std::atomic<bool> JobError_ = ATOMIC_VAR_INIT(false);
+  bool Finished_ = false;
   cmWorkerPool WorkerPool_;
+  BatchT* Batch_ = nullptr;
   // -- Concurrent processing
+  std::mutex& CMakeLibMutex() const
+  {
+    return (this->Batch_ != nullptr) ? this->Batch_->CMakeLibMutex
+                                     : this->CMakeLibMutex_;
+  }
   mutable std::mutex CMakeLibMutex_;
 };
 
@@ -818,30 +888,37 @@ void cmQtAutoMocUicT::JobMocPredefsT::Process()
   if (this->Log().Verbose()) {
     reason = cm::make_unique<std::string>();
   }
-  if (!this->Update(reason.get())) {
+  std::vector<cmQtAutoMocUicT*> update;
+  for (cmQtAutoMocUicT* gen : this->Gens) {
+    if (Update(gen, (reason && reason->empty()) ? reason.get() : nullptr)) {
+      update.push_back(gen);
+    }
+  }
+  if (update.empty()) {
     return;
   }
-  std::string const& predefsFileAbs = this->MocConst().PredefsFileAbs;
+  cmWorkerPool::ProcessResultT result;
   {
-    cmWorkerPool::ProcessResultT result;
-    {
-      // Compose command
-      std::vector<std::string> cmd = this->MocConst().PredefsCmd;
-      // Add definitions
-      cm::append(cmd, this->MocConst().OptionsDefinitions);
-      // Add includes
-      cm::append(cmd, this->MocConst().OptionsIncludes);
-      // Execute command
-      if (!this->RunProcess(GenT::MOC, result, cmd, reason.get())) {
-        this->LogCommandError(GenT::MOC,
-                              cmStrCat("The content generation command for ",
-                                       this->MessagePath(predefsFileAbs),
-                                       " failed.\n", result.ErrorMessage),
-                              cmd, result.StdOut);
-        return;
-      }
+    // Compose command
+    std::vector<std::string> cmd = this->MocConst().PredefsCmd;
+    // Add definitions
+    cm::append(cmd, this->MocConst().OptionsDefinitions);
+    // Add includes
+    cm::append(cmd, this->MocConst().OptionsIncludes);
+    // Execute command
+    if (!this->RunProcess(GenT::MOC, result, cmd, reason.get())) {
+      this->LogCommandError(
+        GenT::MOC,
+        cmStrCat("The content generation command for ",
+                 this->MessagePath(update.front()->MocConst().PredefsFileAbs),
+                 " failed.\n", result.ErrorMessage),
+        cmd, result.StdOut);
+      return;
     }
+  }
 
+  for (cmQtAutoMocUicT* gen : update) {
+    std::string const& predefsFileAbs = gen->MocConst().PredefsFileAbs;
     // (Re)write predefs file only on demand
     if (cmQtAutoGenerator::FileDiffers(predefsFileAbs, result.StdOut)) {
       if (!cmQtAutoGenerator::FileWrite(predefsFileAbs, result.StdOut)) {
@@ -863,34 +940,36 @@ void cmQtAutoMocUicT::JobMocPredefsT::Process()
         return;
       }
     }
-  }
 
-  // Read file time afterwards
-  if (!this->MocEval().PredefsTime.Load(predefsFileAbs)) {
-    this->LogError(GenT::MOC,
-                   cmStrCat("Reading the file time of ",
-                            this->MessagePath(predefsFileAbs), " failed."));
-    return;
+    // Read file time afterwards
+    if (!gen->MocEval().PredefsTime.Load(predefsFileAbs)) {
+      this->LogError(GenT::MOC,
+                     cmStrCat("Reading the file time of ",
+                              this->MessagePath(predefsFileAbs), " failed."));
+      return;
+    }
   }
 }
 
-bool cmQtAutoMocUicT::JobMocPredefsT::Update(std::string* reason) const
+bool cmQtAutoMocUicT::JobMocPredefsT::Update(cmQtAutoMocUicT* gen,
+                                             std::string* reason)
 {
+  MocSettingsT const& mocConst = gen->MocConst();
   // Test if the file exists
-  if (!this->MocEval().PredefsTime.Load(this->MocConst().PredefsFileAbs)) {
+  if (!gen->MocEval().PredefsTime.Load(mocConst.PredefsFileAbs)) {
     if (reason != nullptr) {
       *reason = cmStrCat("Generating ",
-                         this->MessagePath(this->MocConst().PredefsFileAbs),
+                         gen->MessagePath(mocConst.PredefsFileAbs),
                          ", because it doesn't exist.");
     }
     return true;
   }
 
   // Test if the settings changed
-  if (this->MocConst().SettingsChanged) {
+  if (mocConst.SettingsChanged) {
     if (reason != nullptr) {
       *reason = cmStrCat("Generating ",
-                         this->MessagePath(this->MocConst().PredefsFileAbs),
+                         gen->MessagePath(mocConst.PredefsFileAbs),
                          ", because the moc settings changed.");
     }
     return true;
@@ -898,14 +977,14 @@ bool cmQtAutoMocUicT::JobMocPredefsT::Update(std::string* reason) const
 
   // Test if the executable is newer
   {
-    std::string const& exec = this->MocConst().PredefsCmd.at(0);
+    std::string const& exec = mocConst.PredefsCmd.at(0);
     cmFileTime execTime;
     if (execTime.Load(exec)) {
-      if (this->MocEval().PredefsTime.Older(execTime)) {
+      if (gen->MocEval().PredefsTime.Older(execTime)) {
         if (reason != nullptr) {
           *reason = cmStrCat(
-            "Generating ", this->MessagePath(this->MocConst().PredefsFileAbs),
-            " because it is older than ", this->MessagePath(exec), '.');
+            "Generating ", gen->MessagePath(mocConst.PredefsFileAbs),
+            " because it is older than ", gen->MessagePath(exec), '.');
         }
         return true;
       }
@@ -1670,15 +1749,15 @@ void cmQtAutoMocUicT::JobEvalCacheFinishT::Process()
   // Add dependency probing jobs
   {
     // Add fence job to ensure all parsing has finished
-    this->Gen()->WorkerPool().EmplaceJob<JobFenceT>();
+    this->Gen()->EmplaceJob<JobFenceT>();
     if (this->MocConst().Enabled) {
-      this->Gen()->WorkerPool().EmplaceJob<JobProbeDepsMocT>();
+      this->Gen()->EmplaceJob<JobProbeDepsMocT>();
     }
     if (this->UicConst().Enabled) {
-      this->Gen()->WorkerPool().EmplaceJob<JobProbeDepsUicT>();
+      this->Gen()->EmplaceJob<JobProbeDepsUicT>();
     }
     // Add probe finish job
-    this->Gen()->WorkerPool().EmplaceJob<JobProbeDepsFinishT>();
+    this->Gen()->EmplaceJob<JobProbeDepsFinishT>();
   }
 }
 
@@ -1721,7 +1800,7 @@ bool cmQtAutoMocUicT::JobProbeDepsMocT::Generate(MappingHandleT const& mapping,
     ParseCacheT::GetOrInsertT cacheEntry =
       this->BaseEval().ParseCache.GetOrInsert(sourceFile);
     // Add moc job
-    this->Gen()->WorkerPool().EmplaceJob<JobCompileMocT>(
+    this->Gen()->EmplaceJob<JobCompileMocT>(
       mapping, std::move(reason), std::move(cacheEntry.first));
     // Check if a moc job for a mocs_compilation.cpp entry was generated
     if (compFile) {
@@ -1876,8 +1955,7 @@ void cmQtAutoMocUicT::JobProbeDepsUicT::Process()
     this->UicEval().OutputDirs.emplace(
       cmQtAutoGen::ParentDir(mapping->OutputFile));
     // Add uic job
-    this->Gen()->WorkerPool().EmplaceJob<JobCompileUicT>(mapping,
-                                                         std::move(reason));
+    this->Gen()->EmplaceJob<JobCompileUicT>(mapping, std::move(reason));
   }
 }
 
@@ -1960,16 +2038,16 @@ void cmQtAutoMocUicT::JobProbeDepsFinishT::Process()
 
   if (this->MocConst().Enabled) {
     // Add mocs compilations job
-    this->Gen()->WorkerPool().EmplaceJob<JobMocsCompilationT>();
+    this->Gen()->EmplaceJob<JobMocsCompilationT>();
   }
 
   if (!this->BaseConst().DepFile.empty()) {
     // Add job to merge dep files
-    this->Gen()->WorkerPool().EmplaceJob<JobDepFilesMergeT>();
+    this->Gen()->EmplaceJob<JobDepFilesMergeT>();
   }
 
   // Add finish job
-  this->Gen()->WorkerPool().EmplaceJob<JobFinishT>();
+  this->Gen()->EmplaceJob<JobFinishT>();
 }
 
 void cmQtAutoMocUicT::JobCompileMocT::Process()
@@ -2383,9 +2461,13 @@ bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
     }
 
     // -- Evaluate settings
+    cmCryptoHash parseHash(cmCryptoHash::AlgoSHA256);
+    parseHash.Initialize();
     for (std::string const& item : tmp.MacroNames) {
       this->MocConst_.MacroFilters.emplace_back(
         item, ("[\n][ \t]*{?[ \t]*" + item).append("[^a-zA-Z0-9_]"));
+      parseHash.Append(item);
+      parseHash.Append(";");
     }
     // Can moc output dependencies or do we need to setup dependency filters?
     if (this->BaseConst_.QtVersion >= IntegerVersion(5, 15)) {
@@ -2430,6 +2512,7 @@ bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
         }
 
         this->MocConst_.DependFilters.emplace_back(key, exp);
+        parseHash.Append(cmStrCat(key, ';', exp, ';'));
         if (testEntry(
               this->MocConst_.DependFilters.back().Exp.is_valid(),
               cmStrCat("Regular expression compilation failed.\nKeyword: ",
@@ -2438,6 +2521,7 @@ bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
         }
       }
     }
+    this->BaseConst_.ParseKey = parseHash.FinalizeHex();
     // Check if moc executable exists (by reading the file time)
     if (!this->MocConst_.ExecutableTime.Load(this->MocConst_.Executable)) {
       return info.LogError(cmStrCat(
@@ -2714,7 +2798,21 @@ void cmQtAutoMocUicT::CreateParseJobs(SourceFileMapT const& sourceMap)
     // Create a parse job if the cache file was missing or is older
     if (cacheEntry.second || src.second->FileTime.Newer(parseCacheTime)) {
       this->BaseEval().ParseCacheChanged = true;
-      this->WorkerPool().EmplaceJob<JOBTYPE>(src.second);
+      // In a batch parse each file only once for the same parse settings
+      if (this->Batch_ != nullptr) {
+        SourceFileT const& sf = *src.second;
+        auto parsed = this->Batch_->Parsed.emplace(
+          cmStrCat(this->BaseConst().ParseKey, ';', sf.IsHeader ? 'h' : 's',
+                   sf.Moc ? 'm' : '-', sf.Uic ? 'u' : '-', ';',
+                   sf.FileName),
+          sf.ParseData);
+        if (!parsed.second) {
+          this->Batch_->ParsedCopies.emplace_back(sf.ParseData,
+                                                  parsed.first->second);
+          continue;
+        }
+      }
+      this->EmplaceJob<JOBTYPE>(src.second);
     }
   }
 }
@@ -2722,50 +2820,65 @@ void cmQtAutoMocUicT::CreateParseJobs(SourceFileMapT const& sourceMap)
 /** Concurrently callable implementation of cmSystemTools::CollapseFullPath */
 std::string cmQtAutoMocUicT::CollapseFullPathTS(std::string const& path) const
 {
-  std::lock_guard<std::mutex> guard(this->CMakeLibMutex_);
+  std::lock_guard<std::mutex> guard(this->CMakeLibMutex());
   return cmSystemTools::CollapseFullPath(path,
                                          this->ProjectDirs().CurrentSource);
 }
 
-void cmQtAutoMocUicT::InitJobs()
+void cmQtAutoMocUicT::InitParseJobs()
 {
-  // Add moc_predefs.h job
-  if (this->MocConst().Enabled && !this->MocConst().PredefsCmd.empty()) {
-    this->WorkerPool().EmplaceJob<JobMocPredefsT>();
+  // Add moc_predefs.h job.  A batch adds these jobs itself.
+  if (this->MocConst().Enabled && !this->MocConst().PredefsCmd.empty() &&
+      this->Batch_ == nullptr) {
+    this->EmplaceJob<JobMocPredefsT>(std::vector<cmQtAutoMocUicT*>{ this });
   }
 
   // Add header parse jobs
   this->CreateParseJobs<JobParseHeaderT>(this->BaseEval().Headers);
   // Add source parse jobs
   this->CreateParseJobs<JobParseSourceT>(this->BaseEval().Sources);
+}
 
+void cmQtAutoMocUicT::InitEvalJobs()
+{
   // Add parse cache evaluations jobs
   {
     // Add a fence job to ensure all parsing has finished
-    this->WorkerPool().EmplaceJob<JobFenceT>();
+    this->EmplaceJob<JobFenceT>();
     if (this->MocConst().Enabled) {
-      this->WorkerPool().EmplaceJob<JobEvalCacheMocT>();
+      this->EmplaceJob<JobEvalCacheMocT>();
     }
     if (this->UicConst().Enabled) {
-      this->WorkerPool().EmplaceJob<JobEvalCacheUicT>();
+      this->EmplaceJob<JobEvalCacheUicT>();
     }
     // Add evaluate job
-    this->WorkerPool().EmplaceJob<JobEvalCacheFinishT>();
+    this->EmplaceJob<JobEvalCacheFinishT>();
   }
 }
 
-bool cmQtAutoMocUicT::Process()
+bool cmQtAutoMocUicT::Prepare()
 {
   this->SettingsFileRead();
   this->ParseCacheRead();
-  if (!this->CreateDirectories()) {
+  return this->CreateDirectories();
+}
+
+bool cmQtAutoMocUicT::Process()
+{
+  if (!this->Prepare()) {
     return false;
   }
-  this->InitJobs();
-  if (!this->WorkerPool_.Process(this)) {
+  this->InitParseJobs();
+  this->InitEvalJobs();
+  if (!this->WorkerPool_.Process()) {
     return false;
   }
-  if (this->JobError_) {
+  return this->Complete();
+}
+
+bool cmQtAutoMocUicT::Complete()
+{
+  if (this->JobError_ || !this->Finished_) {
     return false;
   }
   if (!this->ParseCacheWrite()) {
@@ -2777,6 +2890,68 @@ bool cmQtAutoMocUicT::Process()
   return true;
 }
 
+void cmQtAutoMocUicT::JobBatchParseFinishT::Process()
+{
+  for (auto const& copy : this->Batch.ParsedCopies) {
+    *copy.first = *copy.second;
+  }
+}
+
+bool cmQtAutoMocUicT::RunBatch(std::vector<std::string> const& infoFiles,
+                               cm::string_view config)
+{
+  BatchT batch;
+  std::vector<std::unique_ptr<cmQtAutoMocUicT>> gens;
+  unsigned int threadCount = 1;
+  for (std::string const& infoFile : infoFiles) {
+    gens.emplace_back(cm::make_unique<cmQtAutoMocUicT>());
+    cmQtAutoMocUicT& gen = *gens.back();
+    gen.Batch_ = &batch;
+    if (!gen.Init(infoFile, config) || !gen.Prepare()) {
+      return false;
+    }
+    threadCount = std::max(threadCount, gen.BaseConst().ThreadCount);
+  }
+  batch.WorkerPool.SetThreadCount(threadCount);
+  batch.Running = gens.size();
+
+  // Add one moc_predefs.h job for the generators with the same command
+  {
+    std::map<std::string, std::vector<cmQtAutoMocUicT*>> predefs;
+    for (auto const& gen : gens) {
+      MocSettingsT const& mocConst = gen->MocConst();
+      if (mocConst.Enabled && !mocConst.PredefsCmd.empty()) {
+        predefs[cmStrCat(cmJoin(mocConst.PredefsCmd, ";"), '\n',
+                         cmJoin(mocConst.OptionsDefinitions, ";"), '\n',
+                         cmJoin(mocConst.OptionsIncludes, ";"))]
+          .push_back(gen.get());
+      }
+    }
+    for (auto& pair : predefs) {
+      pair.second.front()->EmplaceJob<JobMocPredefsT>(std::move(pair.second));
+    }
+  }
+  // Add parse jobs and wait for all of them before the evaluation
+  for (auto const& gen : gens) {
+    gen->InitParseJobs();
+  }
+  batch.WorkerPool.PushJob(cm::make_unique<JobBatchParseFinishT>(batch));
+  for (auto const& gen : gens) {
+    gen->InitEvalJobs();
+  }
+
+  if (!batch.WorkerPool.Process()) {
+    return false;
+  }
+  bool success = true;
+  for (auto const& gen : gens) {
+    if (!gen->Complete()) {
+      success = false;
+    }
+  }
+  return success;
+}
+
 void cmQtAutoMocUicT::SettingsFileRead()
 {
   // Compose current settings strings
@@ -2961,7 +3136,7 @@ bool cmQtAutoMocUicT::CreateDirectories()
 std::vector<std::string> cmQtAutoMocUicT::dependenciesFromDepFile(
   const char* filePath)
 {
-  std::lock_guard<std::mutex> guard(this->CMakeLibMutex_);
+  std::lock_guard<std::mutex> guard(this->CMakeLibMutex());
   auto const content = cmReadGccDepfile(filePath);
   if (!content || content->empty()) {
     return {};
@@ -2976,8 +3151,14 @@ void cmQtAutoMocUicT::Abort(bool error)
 {
   if (error) {
     this->JobError_.store(true);
+  } else {
+    this->Finished_ = true;
+    // A batch ends when the last of its generators finished
+    if (this->Batch_ != nullptr && --this->Batch_->Running != 0) {
+      return;
+    }
   }
-  this->WorkerPool_.Abort();
+  this->WorkerPool().Abort();
 }
 
 std::string cmQtAutoMocUicT::AbsoluteBuildPath(
@@ -2998,3 +3179,9 @@ bool cmQtAutoMocUic(cm::string_view infoFile, cm::string_view config)
 {
   return cmQtAutoMocUicT().Run(infoFile, config);
 }
+
+bool cmQtAutoMocUic(std::vector<std::string> const& infoFiles,
+                    cm::string_view config)
+{
+  return cmQtAutoMocUicT::RunBatch(infoFiles, config);
+}
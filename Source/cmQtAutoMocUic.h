@@ -4,6 +4,9 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <string>
+#include <vector>
+
 #include <cm/string_view>
 
 /**
@@ -11,3 +14,12 @@
  * @return true on success
  */
 bool cmQtAutoMocUic(cm::string_view infoFile, cm::string_view config);
+
+/**
+ * Process AUTOMOC and AUTOUIC of several targets in one worker pool.
+ * Files and moc_predefs.h commands that the targets have in common are
+ * processed only once.
+ * @return true on success
+ */
+bool cmQtAutoMocUic(std::vector<std::string> const& infoFiles,
+                    cm::string_view config);
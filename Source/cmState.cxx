@@ -226,9 +226,10 @@ std::string const& cmState::GetGlobVerifyStamp() const
   return this->GlobVerificationManager->GetVerifyStamp();
 }
 
-bool cmState::SaveVerificationScript(const std::string& path)
+bool cmState::SaveVerificationScript(const std::string& path, bool useIndex)
 {
-  return this->GlobVerificationManager->SaveVerificationScript(path);
+  return this->GlobVerificationManager->SaveVerificationScript(path,
+                                                               useIndex);
 }
 
 void cmState::AddGlobCacheEntry(bool recurse, bool listDirectories,
@@ -237,11 +238,12 @@ void cmState::AddGlobCacheEntry(bool recurse, bool listDirectories,
                                 const std::string& expression,
                                 const std::vector<std::string>& files,
                                 const std::string& variable,
-                                cmListFileBacktrace const& backtrace)
+                                cmListFileBacktrace const& backtrace,
+                                cmGlobWalker const* walker)
 {
   this->GlobVerificationManager->AddCacheEntry(
     recurse, listDirectories, followSymlinks, relative, expression, files,
-    variable, backtrace);
+    variable, backtrace, walker);
 }
 
 void cmState::RemoveCacheEntry(std::string const& key)
@@ -19,14 +19,22 @@
 #include <cm3p/uv.h>
 
 #include "cmDuration.h"
+#include "cmFileTimes.h"
 #include "cmProcessOutput.h"
 #include "cmRange.h"
 #include "cmStringAlgorithms.h"
 
 #if !defined(CMAKE_BOOTSTRAP)
+#  include <condition_variable>
+#  include <deque>
+#  include <mutex>
+#  include <thread>
+#  include <unordered_set>
+
 #  include <cm3p/archive.h>
 #  include <cm3p/archive_entry.h>
 
+#  include "cmArchiveIndex.h"
 #  include "cmArchiveWrite.h"
 #  include "cmLocale.h"
 #  ifndef __LA_INT64_T
@@ -60,6 +68,7 @@
 #include <cassert>
 #include <cctype>
 #include <cerrno>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -1471,7 +1480,8 @@ bool cmSystemTools::CreateTar(const std::string& outFileName,
                               const std::vector<std::string>& files,
                               cmTarCompression compressType, bool verbose,
                               std::string const& mtime,
-                              std::string const& format, int compressionLevel)
+                              std::string const& format, int compressionLevel,
+                              int numThreads, std::string const& indexFile)
 {
 #if !defined(CMAKE_BOOTSTRAP)
   std::string cwd = cmSystemTools::GetCurrentWorkingDirectory();
@@ -1501,28 +1511,58 @@ bool cmSystemTools::CreateTar(const std::string& outFileName,
       break;
   }
 
-  cmArchiveWrite a(fout, compress, format.empty() ? "paxr" : format,
-                   compressionLevel);
-
-  a.Open();
-  a.SetMTime(mtime);
-  a.SetVerbose(verbose);
+  cmArchiveIndex index;
   bool tarCreatedSuccessfully = true;
-  for (auto path : files) {
-    if (cmSystemTools::FileIsFullPath(path)) {
-      // Get the relative path to the file.
-      path = cmSystemTools::RelativePath(cwd, path);
+  {
+    cmArchiveWrite a(fout, compress, format.empty() ? "paxr" : format,
+                     compressionLevel, numThreads);
+
+    a.Open();
+    a.SetMTime(mtime);
+    a.SetVerbose(verbose);
+    if (!indexFile.empty()) {
+      a.SetEntryCallback([&index](std::string const& path, char type,
+                                  long long size, long long offset) {
+        cmArchiveIndex::Entry e;
+        e.Type = type;
+        e.Offset = offset;
+        e.Size = size;
+        e.Path = path;
+        index.Entries.emplace_back(std::move(e));
+      });
+    }
+    for (auto path : files) {
+      if (cmSystemTools::FileIsFullPath(path)) {
+        // Get the relative path to the file.
+        path = cmSystemTools::RelativePath(cwd, path);
+      }
+      if (!a.Add(path)) {
+        cmSystemTools::Error(a.GetError());
+        tarCreatedSuccessfully = false;
+      }
     }
-    if (!a.Add(path)) {
-      cmSystemTools::Error(a.GetError());
-      tarCreatedSuccessfully = false;
+  }
+  fout.close();
+
+  if (tarCreatedSuccessfully && !indexFile.empty()) {
+    if (!index.Describe(outFileName)) {
+      cmSystemTools::Error("Cannot read archive: " + outFileName);
+      return false;
     }
+    // Offsets in the uncompressed stream are only file positions when
+    // nothing compressed the stream.
+    index.Seekable = compressType == TarCompressNone &&
+      std::all_of(
+        index.Entries.begin(), index.Entries.end(),
+        [](cmArchiveIndex::Entry const& e) { return e.Offset >= 0; });
+    tarCreatedSuccessfully = index.Save(indexFile);
   }
   return tarCreatedSuccessfully;
 #else
   (void)outFileName;
   (void)files;
   (void)verbose;
+  (void)indexFile;
   return false;
 #endif
 }
@@ -1698,10 +1738,392 @@ bool copy_data(struct archive* ar, struct archive* aw)
 #  endif
 }
 
+// Writes regular files read from an archive on worker threads while the
+// calling thread goes on decompressing the archive.  Creating a disk writer
+// changes the umask of the process and writing a header creates the parent
+// directories of a file, so both are done on the calling thread and the
+// workers only write the data of files already opened.
+class cmArchiveExtractWriters
+{
+public:
+  cmArchiveExtractWriters() = default;
+  ~cmArchiveExtractWriters()
+  {
+    this->Finish();
+    for (struct archive* ext : this->Free) {
+      archive_write_free(ext);
+    }
+  }
+
+  cmArchiveExtractWriters(cmArchiveExtractWriters const&) = delete;
+  cmArchiveExtractWriters& operator=(cmArchiveExtractWriters const&) =
+    delete;
+
+  // Whether an entry can be buffered and written by a worker.
+  static bool CanWrite(struct archive_entry* entry)
+  {
+    return archive_entry_filetype(entry) == AE_IFREG &&
+      !archive_entry_hardlink(entry) &&
+      archive_entry_sparse_count(entry) == 0 &&
+      archive_entry_size_is_set(entry) &&
+      archive_entry_size(entry) <= MaxFileSize;
+  }
+
+  // Read the data of an entry, open its file and queue writing it.
+  bool Add(struct archive* ar, struct archive_entry* entry)
+  {
+    // A file given twice must be written in archive order.
+    std::string path = cm_archive_entry_pathname(entry);
+    if (this->Queued.count(path)) {
+      this->Drain();
+    }
+
+    Job job;
+    job.Path = path;
+    job.Data.resize(static_cast<size_t>(archive_entry_size(entry)));
+    for (;;) {
+      const void* buff;
+      size_t size;
+      __LA_INT64_T offset;
+      long r = archive_read_data_block(ar, &buff, &size, &offset);
+      if (r == ARCHIVE_EOF) {
+        break;
+      }
+      if (!la_diagnostic(ar, r)) {
+        return false;
+      }
+      size_t const end = static_cast<size_t>(offset) + size;
+      if (end > job.Data.size()) {
+        job.Data.resize(end);
+      }
+      if (size > 0) {
+        memcpy(job.Data.data() + offset, buff, size);
+      }
+    }
+
+    // Writing overlaps with decompression even on a single processor.
+    if (this->Threads.empty()) {
+      unsigned int threads = std::thread::hardware_concurrency();
+      threads = std::max(2u, std::min(threads, 8u));
+      for (unsigned int i = 0; i < 2 * threads; ++i) {
+        struct archive* ext = archive_write_disk_new();
+        archive_write_disk_set_options(ext, ARCHIVE_EXTRACT_TIME);
+        this->Free.push_back(ext);
+      }
+      for (unsigned int i = 0; i < threads; ++i) {
+        this->Threads.emplace_back([this]() { this->Work(); });
+      }
+    }
+
+    size_t const bytes = job.Data.size();
+    {
+      std::unique_lock<std::mutex> lock(this->Mutex);
+      this->Space.wait(lock, [this, bytes]() {
+        return !this->Free.empty() &&
+          (this->Bytes == 0 || this->Bytes + bytes <= MaxQueuedBytes);
+      });
+      job.Ext = this->Free.back();
+      this->Free.pop_back();
+    }
+
+    if (archive_write_header(job.Ext, entry) != ARCHIVE_OK) {
+      ArchiveError("Problem with archive_write_header(): ", job.Ext);
+      cmSystemTools::Error("Current file: " + path);
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Free.push_back(job.Ext);
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Bytes += bytes;
+      ++this->Pending;
+      this->Jobs.emplace_back(std::move(job));
+    }
+    this->Ready.notify_one();
+    this->Queued.emplace(std::move(path));
+    return true;
+  }
+
+  // Wait until all queued files are written.
+  void Drain()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->Idle.wait(lock, [this]() { return this->Pending == 0; });
+    this->Queued.clear();
+  }
+
+  // Write all queued files and stop the workers.
+  bool Finish()
+  {
+    if (!this->Threads.empty()) {
+      {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        this->Done = true;
+      }
+      this->Ready.notify_all();
+      for (std::thread& t : this->Threads) {
+        t.join();
+      }
+      this->Threads.clear();
+    }
+    bool const ok = this->Errors.empty();
+    for (std::string const& e : this->Errors) {
+      cmSystemTools::Error(e);
+    }
+    this->Errors.clear();
+    return ok;
+  }
+
+private:
+  static constexpr la_int64_t MaxFileSize = 4 << 20;
+  static constexpr size_t MaxQueuedBytes = 64 << 20;
+
+  struct Job
+  {
+    // Disk writer whose header for the file is already written.
+    struct archive* Ext = nullptr;
+    std::string Path;
+    std::vector<char> Data;
+  };
+
+  static std::string Write(Job const& job)
+  {
+    if (!job.Data.empty() &&
+        archive_write_data(job.Ext, job.Data.data(), job.Data.size()) < 0) {
+      return cmStrCat("Problem with archive_write_data(): ",
+                      archive_error_string(job.Ext), "\nCurrent file: ",
+                      job.Path);
+    }
+    if (archive_write_finish_entry(job.Ext) != ARCHIVE_OK) {
+      return cmStrCat("Problem with archive_write_finish_entry(): ",
+                      archive_error_string(job.Ext));
+    }
+    return std::string();
+  }
+
+  void Work()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    for (;;) {
+      this->Ready.wait(lock,
+                       [this]() { return this->Done || !this->Jobs.empty(); });
+      if (this->Jobs.empty()) {
+        break;
+      }
+      Job job = std::move(this->Jobs.front());
+      this->Jobs.pop_front();
+      lock.unlock();
+      std::string error = Write(job);
+      lock.lock();
+      if (!error.empty()) {
+        this->Errors.emplace_back(std::move(error));
+      }
+      this->Free.push_back(job.Ext);
+      this->Bytes -= job.Data.size();
+      --this->Pending;
+      this->Space.notify_one();
+      if (this->Pending == 0) {
+        this->Idle.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> Threads;
+  std::mutex Mutex;
+  std::condition_variable Ready;
+  std::condition_variable Space;
+  std::condition_variable Idle;
+  std::deque<Job> Jobs;
+  // Disk writers not used by a queued file.
+  std::vector<struct archive*> Free;
+  size_t Bytes = 0;
+  size_t Pending = 0;
+  bool Done = false;
+  std::vector<std::string> Errors;
+  // Paths queued since the workers were last idle.
+  std::unordered_set<std::string> Queued;
+};
+
+// Select the members of an indexed archive that match the given patterns.
+bool match_index(cmArchiveIndex const& index,
+                 const std::vector<std::string>& files,
+                 std::vector<cmArchiveIndex::Entry const*>& selected)
+{
+  struct archive* matching = archive_match_new();
+  if (matching == nullptr) {
+    cmSystemTools::Error("Out of memory");
+    return false;
+  }
+  for (const auto& filename : files) {
+    if (archive_match_include_pattern(matching, filename.c_str()) !=
+        ARCHIVE_OK) {
+      cmSystemTools::Error("Failed to add to inclusion list: " + filename);
+      archive_match_free(matching);
+      return false;
+    }
+  }
+
+  struct archive_entry* entry = archive_entry_new();
+  for (cmArchiveIndex::Entry const& e : index.Entries) {
+#  if cmsys_STL_HAS_WSTRING
+    archive_entry_copy_pathname_w(entry,
+                                  cmsys::Encoding::ToWide(e.Path).c_str());
+#  else
+    archive_entry_copy_pathname(entry, e.Path.c_str());
+#  endif
+    if (!archive_match_excluded(matching, entry)) {
+      selected.push_back(&e);
+    }
+  }
+  archive_entry_free(entry);
+
+  bool error_occured = false;
+  const char* p;
+  int ar;
+  while ((ar = archive_match_path_unmatched_inclusions_next(matching, &p)) ==
+         ARCHIVE_OK) {
+    cmSystemTools::Error("tar: " + std::string(p) + ": Not found in archive");
+    error_occured = true;
+  }
+  if (!error_occured && ar == ARCHIVE_FATAL) {
+    cmSystemTools::Error("tar: Out of memory");
+    error_occured = true;
+  }
+  archive_match_free(matching);
+  return !error_occured;
+}
+
+// Reads an uncompressed tar archive from the header of one member.
+struct cmArchiveMemberReader
+{
+  cmsys::ifstream Stream;
+  char Buffer[16384];
+
+  static __LA_SSIZE_T Read(struct archive* /*unused*/, void* cd,
+                           const void** buff)
+  {
+    cmArchiveMemberReader* self = static_cast<cmArchiveMemberReader*>(cd);
+    self->Stream.read(self->Buffer, sizeof(self->Buffer));
+    *buff = self->Buffer;
+    return static_cast<__LA_SSIZE_T>(self->Stream.gcount());
+  }
+};
+
+// Read the header of a member of an uncompressed tar archive at the offset
+// recorded in an index.  Returns nullptr if the archive has no such member
+// there.
+struct archive* open_indexed_member(cmArchiveMemberReader& reader,
+                                    const std::string& outFileName,
+                                    cmArchiveIndex::Entry const& e,
+                                    struct archive_entry** entry)
+{
+  reader.Stream.open(outFileName.c_str(), std::ios::in | std::ios::binary);
+  if (!reader.Stream.seekg(e.Offset)) {
+    return nullptr;
+  }
+  struct archive* a = archive_read_new();
+  archive_read_support_format_tar(a);
+  if (archive_read_open(a, &reader, nullptr, &cmArchiveMemberReader::Read,
+                        nullptr) != ARCHIVE_OK ||
+      archive_read_next_header(a, entry) != ARCHIVE_OK ||
+      cm_archive_entry_pathname(*entry) != e.Path) {
+    archive_read_free(a);
+    return nullptr;
+  }
+  return a;
+}
+
+// List or extract the members of an indexed archive selected by patterns.
+// Sets 'stale' and does nothing if the members are not where the index
+// says they are.
+bool extract_tar_indexed(const std::string& outFileName,
+                         cmArchiveIndex const& index,
+                         const std::vector<std::string>& files, bool verbose,
+                         bool extract, bool& stale)
+{
+  std::vector<cmArchiveIndex::Entry const*> selected;
+  if (!match_index(index, files, selected)) {
+    return false;
+  }
+  if (!extract) {
+    for (cmArchiveIndex::Entry const* e : selected) {
+      cmSystemTools::Stdout(e->Path);
+      cmSystemTools::Stdout("\n");
+    }
+    return true;
+  }
+
+  cmLocaleRAII localeRAII;
+  static_cast<void>(localeRAII);
+
+  // Check every member before writing anything.
+  for (cmArchiveIndex::Entry const* e : selected) {
+    cmArchiveMemberReader reader;
+    struct archive_entry* entry;
+    struct archive* a = open_indexed_member(reader, outFileName, *e, &entry);
+    if (!a) {
+      stale = true;
+      return false;
+    }
+    archive_read_free(a);
+  }
+
+  struct archive* ext = archive_write_disk_new();
+  archive_write_disk_set_options(ext, ARCHIVE_EXTRACT_TIME);
+  bool ok = true;
+  for (cmArchiveIndex::Entry const* e : selected) {
+    cmArchiveMemberReader reader;
+    struct archive_entry* entry;
+    struct archive* a = open_indexed_member(reader, outFileName, *e, &entry);
+    if (!a) {
+      cmSystemTools::Error("Cannot read archive: " + outFileName);
+      ok = false;
+      break;
+    }
+    if (verbose) {
+      cmSystemTools::Stdout("x ");
+      cmSystemTools::Stdout(e->Path);
+      cmSystemTools::Stdout("\n");
+    }
+    if (archive_write_header(ext, entry) != ARCHIVE_OK) {
+      ArchiveError("Problem with archive_write_header(): ", ext);
+      cmSystemTools::Error("Current file: " + e->Path);
+      ok = false;
+    } else if (!copy_data(a, ext)) {
+      ok = false;
+    } else if (archive_write_finish_entry(ext) != ARCHIVE_OK) {
+      ArchiveError("Problem with archive_write_finish_entry(): ", ext);
+      ok = false;
+    }
+    archive_read_free(a);
+    if (!ok) {
+      break;
+    }
+  }
+  archive_write_free(ext);
+  return ok;
+}
+
 bool extract_tar(const std::string& outFileName,
                  const std::vector<std::string>& files, bool verbose,
-                 bool extract)
-{
+                 bool extract, std::string const& indexFile)
+{
+  // An index lists an archive without reading it, and finds the members
+  // of an uncompressed tar archive without reading the members before.
+  if (!indexFile.empty() && (extract ? !files.empty() : !verbose)) {
+    cmArchiveIndex index;
+    if (index.Load(indexFile, outFileName) && (!extract || index.Seekable)) {
+      // Read the whole archive if the index turns out to be stale.
+      bool stale = false;
+      bool const ok = extract_tar_indexed(outFileName, index, files, verbose,
+                                          extract, stale);
+      if (!stale) {
+        return ok;
+      }
+    }
+  }
+
   cmLocaleRAII localeRAII;
   static_cast<void>(localeRAII);
   struct archive* a = archive_read_new();
@@ -1731,6 +2153,8 @@ bool extract_tar(const std::string& outFileName,
     archive_read_close(a);
     return false;
   }
+  // Directory times are set when 'ext' is freed, after this is finished.
+  cmArchiveExtractWriters writers;
   for (;;) {
     r = archive_read_next_header(a, &entry);
     if (r == ARCHIVE_EOF) {
@@ -1758,6 +2182,18 @@ bool extract_tar(const std::string& outFileName,
       cmSystemTools::Stdout("\n");
     }
     if (extract) {
+      if (cmArchiveExtractWriters::CanWrite(entry)) {
+        if (!writers.Add(a, entry)) {
+          r = ARCHIVE_FATAL;
+          break;
+        }
+        continue;
+      }
+      // Other entries may depend on files written before them.
+      if (archive_entry_filetype(entry) != AE_IFDIR) {
+        writers.Drain();
+      }
+
       r = archive_write_disk_set_options(ext, ARCHIVE_EXTRACT_TIME);
       if (r != ARCHIVE_OK) {
         ArchiveError("Problem with archive_write_disk_set_options(): ", ext);
@@ -1791,6 +2227,10 @@ bool extract_tar(const std::string& outFileName,
     }
   }
 
+  if (!writers.Finish()) {
+    r = ARCHIVE_FATAL;
+  }
+
   bool error_occured = false;
   if (matching != nullptr) {
     const char* p;
@@ -1821,28 +2261,30 @@ bool extract_tar(const std::string& outFileName,
 
 bool cmSystemTools::ExtractTar(const std::string& outFileName,
                                const std::vector<std::string>& files,
-                               bool verbose)
+                               bool verbose, std::string const& indexFile)
 {
 #if !defined(CMAKE_BOOTSTRAP)
-  return extract_tar(outFileName, files, verbose, true);
+  return extract_tar(outFileName, files, verbose, true, indexFile);
 #else
   (void)outFileName;
   (void)files;
   (void)verbose;
+  (void)indexFile;
   return false;
 #endif
 }
 
 bool cmSystemTools::ListTar(const std::string& outFileName,
                             const std::vector<std::string>& files,
-                            bool verbose)
+                            bool verbose, std::string const& indexFile)
 {
 #if !defined(CMAKE_BOOTSTRAP)
-  return extract_tar(outFileName, files, verbose, false);
+  return extract_tar(outFileName, files, verbose, false, indexFile);
 #else
   (void)outFileName;
   (void)files;
   (void)verbose;
+  (void)indexFile;
   return false;
 #endif
 }
@@ -3101,3 +3543,66 @@ bool cmSystemTools::CreateLink(const std::string& origName,
 
   return true;
 }
+
+bool cmSystemTools::CloneFile(const std::string& origName,
+                              const std::string& newName)
+{
+  uv_fs_t req;
+  int err = uv_fs_copyfile(nullptr, &req, origName.c_str(), newName.c_str(),
+                           UV_FS_COPYFILE_FICLONE_FORCE, nullptr);
+  uv_fs_req_cleanup(&req);
+  return err == 0;
+}
+
+bool cmSystemTools::CopyRegularFile(const std::string& origName,
+                                    const std::string& newName)
+{
+#ifndef _WIN32
+  // libuv truncates and rewrites an existing destination in place.  Remove
+  // a destination that shares its inode with other names so they keep
+  // their old content.
+  uv_fs_t req;
+  int err = uv_fs_lstat(nullptr, &req, newName.c_str(), nullptr);
+  uint64_t const nlink = err == 0 ? req.statbuf.st_nlink : 0;
+  uv_fs_req_cleanup(&req);
+  if (nlink > 1 && !cmSystemTools::RemoveFile(newName)) {
+    return false;
+  }
+
+  // libuv tries a copy-on-write clone and then copies the content with
+  // copy_file_range or sendfile.
+  err = uv_fs_copyfile(nullptr, &req, origName.c_str(), newName.c_str(),
+                       UV_FS_COPYFILE_FICLONE, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err == 0) {
+    return true;
+  }
+#endif
+  // Fall back to a copy that also creates the destination directory or
+  // replaces a read-only destination.
+  return cmSystemTools::CopyAFile(origName, newName, true);
+}
+
+bool cmSystemTools::BreakHardLink(const std::string& path)
+{
+  uv_fs_t req;
+  int err = uv_fs_lstat(nullptr, &req, path.c_str(), nullptr);
+  uint64_t const nlink = err == 0 ? req.statbuf.st_nlink : 0;
+  uv_fs_req_cleanup(&req);
+  if (nlink <= 1) {
+    return true;
+  }
+
+  // Copy the content, permissions and times aside and move the copy over
+  // the link.
+  std::string const tmp = cmStrCat(path, ".cmake-unlink");
+  if (!cmSystemTools::CopyFileAlways(path, tmp)) {
+    return false;
+  }
+  cmFileTimes::Copy(path, tmp);
+  if (!cmSystemTools::RenameFile(tmp, path)) {
+    cmSystemTools::RemoveFile(tmp);
+    return false;
+  }
+  return true;
+}
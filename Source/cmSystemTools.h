@@ -362,16 +362,22 @@ public:
     TarCompressNone
   };
 
+  /** The optional index file lists the archive members so that they can
+      be listed, or those of an uncompressed tar archive selected and
+      extracted, without reading the whole archive.  */
   static bool ListTar(const std::string& outFileName,
-                      const std::vector<std::string>& files, bool verbose);
+                      const std::vector<std::string>& files, bool verbose,
+                      std::string const& indexFile = std::string());
   static bool CreateTar(const std::string& outFileName,
                         const std::vector<std::string>& files,
                         cmTarCompression compressType, bool verbose,
                         std::string const& mtime = std::string(),
                         std::string const& format = std::string(),
-                        int compressionLevel = 0);
+                        int compressionLevel = 0, int numThreads = 1,
+                        std::string const& indexFile = std::string());
   static bool ExtractTar(const std::string& inFileName,
-                         const std::vector<std::string>& files, bool verbose);
+                         const std::vector<std::string>& files, bool verbose,
+                         std::string const& indexFile = std::string());
   // This should be called first thing in main
   // it will keep child processes from inheriting the
   // stdin and stdout of this process.  This is important
@@ -465,6 +471,23 @@ public:
                          const std::string& newName,
                          std::string* errorMessage = nullptr);
 
+  /** Create a copy-on-write clone (reflink) of a file if the platform
+      and file system support it.  Returns whether cloning succeeded;
+      nothing is copied otherwise.  */
+  static bool CloneFile(const std::string& origName,
+                        const std::string& newName);
+
+  /** Copy a regular file over any existing destination file.  Where
+      the platform supports it the copy shares storage with its source or
+      is made within the kernel.  Returns whether copying succeeded.  */
+  static bool CopyRegularFile(const std::string& origName,
+                              const std::string& newName);
+
+  /** Replace a file that has more than one hard link with a private copy
+      of itself so that it can be modified in place without affecting
+      the other links.  Returns false if the copy could not be made.  */
+  static bool BreakHardLink(const std::string& path);
+
 private:
   static bool s_ForceUnixPaths;
   static bool s_RunCommandHideConsole;
@@ -10,6 +10,8 @@
 #include <functional>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <cm/memory>
 
@@ -511,6 +513,12 @@ public:
    */
   void Work(unsigned int workerIndex);
 
+  /**
+   * Returns the first job in the queue that may be processed now or the end
+   * of the queue.  Requires the mutex to be locked.
+   */
+  std::deque<cmWorkerPool::JobHandleT>::iterator NextJob();
+
   // -- Request slots
   static void UVSlotBegin(uv_async_t* handle);
   static void UVSlotEnd(uv_async_t* handle);
@@ -533,9 +541,16 @@ public:
   unsigned int JobsProcessing = 0;
   std::deque<cmWorkerPool::JobHandleT> Queue;
   std::condition_variable Condition;
-  std::condition_variable ConditionFence;
   std::vector<std::unique_ptr<cmWorkerPoolWorker>> Workers;
 
+  // -- Fence groups with jobs in processing
+  struct GroupT
+  {
+    unsigned int JobsProcessing = 0;
+    bool FenceProcessing = false;
+  };
+  std::unordered_map<void const*, GroupT> Groups;
+
   // -- References
   cmWorkerPool* Pool = nullptr;
 };
@@ -654,6 +669,44 @@ void cmWorkerPoolInternal::UVSlotEnd(uv_async_t* handle)
   gint.UVRequestEnd.reset();
 }
 
+std::deque<cmWorkerPool::JobHandleT>::iterator cmWorkerPoolInternal::NextJob()
+{
+  auto const end = this->Queue.end();
+  // A fence of the default group blocks all jobs
+  if (this->FenceProcessing) {
+    return end;
+  }
+  // Groups with a fence that is processing or waiting
+  std::vector<void const*> blocked;
+  for (auto it = this->Queue.begin(); it != end; ++it) {
+    cmWorkerPool::JobT const& job = **it;
+    void const* group = job.FenceGroup();
+    if (group == nullptr) {
+      if (!job.IsFence()) {
+        return it;
+      }
+      // A fence of the default group waits for all pending jobs and
+      // blocks all jobs later in the queue.
+      return (this->JobsProcessing == 0) ? it : end;
+    }
+    if (std::find(blocked.begin(), blocked.end(), group) != blocked.end()) {
+      continue;
+    }
+    auto git = this->Groups.find(group);
+    if (git != this->Groups.end() && git->second.FenceProcessing) {
+      blocked.push_back(group);
+      continue;
+    }
+    if (job.IsFence() && git != this->Groups.end()) {
+      // Wait until all pending jobs of the group are done
+      blocked.push_back(group);
+      continue;
+    }
+    return it;
+  }
+  return end;
+}
+
 void cmWorkerPoolInternal::Work(unsigned int workerIndex)
 {
   cmWorkerPool::JobHandleT jobHandle;
@@ -666,63 +719,62 @@ void cmWorkerPoolInternal::Work(unsigned int workerIndex)
     if (this->Aborting) {
       break;
     }
-    // Wait for new jobs on the main CV
-    if (this->Queue.empty()) {
+
+    // Wait on the main CV for new jobs or for a fence to be passed
+    auto it = this->NextJob();
+    if (it == this->Queue.end()) {
       ++this->WorkersIdle;
       this->Condition.wait(uLock);
       --this->WorkersIdle;
       continue;
     }
 
-    // If there is a fence currently active or waiting,
-    // sleep on the main CV and try again.
-    if (this->FenceProcessing) {
-      this->Condition.wait(uLock);
-      continue;
-    }
-
     // Pop next job from queue
-    jobHandle = std::move(this->Queue.front());
-    this->Queue.pop_front();
+    jobHandle = std::move(*it);
+    this->Queue.erase(it);
 
-    // Check for fence jobs
-    bool raisedFence = false;
-    if (jobHandle->IsFence()) {
-      this->FenceProcessing = true;
-      raisedFence = true;
-      // Wait on the Fence CV until all pending jobs are done.
-      while (this->JobsProcessing != 0 && !this->Aborting) {
-        this->ConditionFence.wait(uLock);
-      }
-      // When aborting, explicitly kick all threads alive once more.
-      if (this->Aborting) {
-        this->FenceProcessing = false;
-        this->Condition.notify_all();
-        break;
+    // Register the job in its group
+    void const* group = jobHandle->FenceGroup();
+    bool const fence = jobHandle->IsFence();
+    ++this->JobsProcessing;
+    if (group != nullptr) {
+      GroupT& groupState = this->Groups[group];
+      ++groupState.JobsProcessing;
+      if (fence) {
+        groupState.FenceProcessing = true;
       }
+    } else if (fence) {
+      this->FenceProcessing = true;
     }
 
     // Unlocked scope for job processing
-    ++this->JobsProcessing;
     {
       uLock.unlock();
       jobHandle->Work(this->Pool, workerIndex); // Process job
       jobHandle.reset();                        // Destroy job
       uLock.lock();
     }
-    --this->JobsProcessing;
 
-    // If this was the thread that entered fence processing
-    // originally, notify all idling workers that the fence
-    // is done.
-    if (raisedFence) {
+    // Unregister the job and wake up the idle workers if a fence
+    // might be passable now.
+    bool notify = fence;
+    if (--this->JobsProcessing == 0) {
+      notify = true;
+    }
+    if (group != nullptr) {
+      auto git = this->Groups.find(group);
+      if (fence) {
+        git->second.FenceProcessing = false;
+      }
+      if (--git->second.JobsProcessing == 0) {
+        this->Groups.erase(git);
+        notify = true;
+      }
+    } else if (fence) {
       this->FenceProcessing = false;
-      this->Condition.notify_all();
     }
-    // If fence processing is still not done, notify the
-    // the fencing worker when all active jobs are done.
-    if (this->FenceProcessing && this->JobsProcessing == 0) {
-      this->ConditionFence.notify_all();
+    if (notify) {
+      this->Condition.notify_all();
     }
   }
 
@@ -63,6 +63,19 @@ public:
      */
     bool IsFence() const { return this->Fence_; }
 
+    /**
+     * Fence group
+     *
+     * A fence job of a group only waits for and only blocks the jobs of
+     * the same group.  This lets independent job sequences share one pool.
+     * A fence job of the default group (nullptr) waits for and blocks all
+     * jobs.
+     *
+     * Set the group before the job is pushed to the queue.
+     */
+    void const* FenceGroup() const { return this->FenceGroup_; }
+    void SetFenceGroup(void const* group) { this->FenceGroup_ = group; }
+
   protected:
     /**
      * Protected default constructor
@@ -120,6 +133,7 @@ public:
     cmWorkerPool* Pool_ = nullptr;
     unsigned int WorkerIndex_ = 0;
     bool Fence_ = false;
+    void const* FenceGroup_ = nullptr;
   };
 
   /**
@@ -37,6 +37,7 @@
 #include "cmDuration.h"
 #include "cmExternalMakefileProjectGenerator.h"
 #include "cmFileTimeCache.h"
+#include "cmGeneratedFileStream.h"
 #include "cmGeneratorTarget.h"
 #include "cmGlobalGenerator.h"
 #include "cmGlobalGeneratorFactory.h"
@@ -2067,7 +2068,8 @@ int cmake::ActualConfigure()
       "CMakeLists.txt ?");
   }
 
-  this->State->SaveVerificationScript(this->GetHomeOutputDirectory());
+  this->State->SaveVerificationScript(this->GetHomeOutputDirectory(),
+                                      mf->IsOn("CMAKE_GLOB_VERIFY_INDEX"));
   this->SaveCache(this->GetHomeOutputDirectory());
   if (cmSystemTools::GetErrorOccuredFlag()) {
     return -1;
@@ -2297,7 +2299,11 @@ int cmake::Generate()
   if (!this->GlobalGenerator->Compute()) {
     return -1;
   }
+  // Let generated files be compared with their previous version by hash.
+  cmGeneratedFileStream::LoadManifest(cmStrCat(
+    this->GetHomeOutputDirectory(), "/CMakeFiles/cmake.generated_files"));
   this->GlobalGenerator->Generate();
+  cmGeneratedFileStream::WriteManifest();
   if (!this->GraphVizFile.empty()) {
     std::cout << "Generate graphviz: " << this->GraphVizFile << std::endl;
     this->GenerateGraphViz(this->GraphVizFile);
@@ -2358,11 +2364,12 @@ void cmake::AddGlobCacheEntry(bool recurse, bool listDirectories,
                               const std::string& expression,
                               const std::vector<std::string>& files,
                               const std::string& variable,
-                              cmListFileBacktrace const& backtrace)
+                              cmListFileBacktrace const& backtrace,
+                              cmGlobWalker const* walker)
 {
   this->State->AddGlobCacheEntry(recurse, listDirectories, followSymlinks,
                                  relative, expression, files, variable,
-                                 backtrace);
+                                 backtrace, walker);
 }
 
 std::vector<std::string> cmake::GetAllExtensions() const
@@ -963,6 +963,13 @@ int main(int ac, char const* const* av)
   av = args.argv();
 
   cmSystemTools::InitializeLibUV();
+  if (ac > 2 && strcmp(av[1], "-E") == 0 &&
+      !cmcmd::NeedsCMakeResources(av[2])) {
+    // Build-time helpers run for many build steps.  Skip locating the
+    // CMake resources, which costs a search of the PATH and several
+    // file system checks, when the command does not use them.
+    return do_command(ac, av, std::move(consoleBuf));
+  }
   cmSystemTools::FindCMakeResources(av[0]);
   if (ac > 1) {
     if (strcmp(av[1], "--build") == 0) {
@@ -51,6 +51,7 @@
 #include <ctime>
 #include <iostream>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <utility>
 
@@ -622,6 +623,47 @@ int cmcmd::HandleCoCompileCommands(std::vector<std::string> const& args)
   return ret;
 }
 
+bool cmcmd::NeedsCMakeResources(std::string const& command)
+{
+  // Commands run by generated build systems for every build step.
+  // They operate only on their arguments, so they do not need the
+  // CMake executable, its sibling tools, or the module directory.
+  static std::set<std::string> const lightweightCommands = {
+    "cat",
+    "cmake_copy_f90_mod",
+    "cmake_echo_color",
+    "cmake_progress_report",
+    "cmake_progress_start",
+    "cmake_symlink_executable",
+    "cmake_symlink_library",
+    "compare_files",
+    "copy",
+    "copy_directory",
+    "copy_if_different",
+    "create_hardlink",
+    "create_symlink",
+    "echo",
+    "echo_append",
+    "false",
+    "make_directory",
+    "md5sum",
+    "remove",
+    "remove_directory",
+    "rename",
+    "rm",
+    "sha1sum",
+    "sha224sum",
+    "sha256sum",
+    "sha384sum",
+    "sha512sum",
+    "sleep",
+    "touch",
+    "touch_nocreate",
+    "true",
+  };
+  return lightweightCommands.count(command) == 0;
+}
+
 int cmcmd::ExecuteCMakeCommand(std::vector<std::string> const& args,
                                std::unique_ptr<cmConsoleBuf> consoleBuf)
 {
@@ -1338,6 +1380,11 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string> const& args,
       cm::string_view const config = args[3];
       return cmQtAutoMocUic(infoFile, config) ? 0 : 1;
     }
+    if ((args[1] == "cmake_autogen_batch") && (args.size() >= 4)) {
+      cm::string_view const config = args[2];
+      std::vector<std::string> const infoFiles(args.begin() + 3, args.end());
+      return cmQtAutoMocUic(infoFiles, config) ? 0 : 1;
+    }
     if ((args[1] == "cmake_autorcc") && (args.size() >= 3)) {
       cm::string_view const infoFile = args[2];
       cm::string_view const config =
@@ -22,6 +22,13 @@ public:
   static int ExecuteCMakeCommand(std::vector<std::string> const&,
                                  std::unique_ptr<cmConsoleBuf> consoleBuf);
 
+  /**
+   * Return whether the given command needs to know where the CMake
+   * executables and resources are located.  Simple file system and
+   * output helpers do not, so their startup can skip the search.
+   */
+  static bool NeedsCMakeResources(std::string const& command);
+
 protected:
   static int HandleCoCompileCommands(std::vector<std::string> const& args);
   static int HashSumFile(std::vector<std::string> const& args,
@@ -101,6 +101,12 @@ static const char* cmDocumentationOptions[][2] = {
     "Run a specific number of tests by number." },
   { "-U, --union", "Take the Union of -I and -R" },
   { "--rerun-failed", "Run only the tests that failed previously" },
+  { "--test-list-cache",
+    "Reuse the list of tests read by a previous run if unchanged" },
+  { "--affected-by <file>",
+    "Run only tests affected by the changed files listed in <file>" },
+  { "--shard-count <n>, --shard-index <i>",
+    "Partition the tests into <n> shards and run only shard <i>" },
   { "--repeat until-fail:<n>, --repeat-until-fail <n>",
     "Require each test to run <n> times without failing in order to pass" },
   { "--repeat until-pass:<n>",
@@ -208,6 +208,112 @@ static const std::vector<ExpectedPackResult> expectedResults
   /* clang-format on */
 };
 
+struct ExpectedBestFitResult
+{
+  std::vector<int> SlotsNeeded;
+  std::map<std::string, cmCTestResourceAllocator::Resource> Resources;
+  bool ExpectedMayFit;
+  bool ExpectedReturnValue;
+  std::vector<cmCTestBinPackerAllocation> ExpectedAllocations;
+};
+
+static const std::vector<ExpectedBestFitResult> expectedBestFitResults
+{
+  /* clang-format off */
+  {
+    { 1, 1 },
+    { { "0", { 2, 0 } }, { "1", { 2, 0 } }, { "2", { 1, 0 } } },
+    true,
+    true,
+    {
+      { 0, 1, "2" },
+      { 1, 1, "0" },
+    },
+  },
+  {
+    { 2, 2, 2, 2 },
+    { { "0", { 4, 0 } }, { "1", { 4, 0 } }, { "2", { 4, 0 } },
+      { "3", { 4, 0 } } },
+    true,
+    true,
+    {
+      { 0, 2, "0" },
+      { 1, 2, "0" },
+      { 2, 2, "1" },
+      { 3, 2, "1" },
+    },
+  },
+  {
+    { 1 },
+    { { "0", { 4, 3 } }, { "1", { 4, 0 } } },
+    true,
+    true,
+    {
+      { 0, 1, "0" },
+    },
+  },
+  {
+    { 3, 3 },
+    { { "0", { 4, 0 } }, { "1", { 2, 0 } } },
+    true,
+    false,
+    { },
+  },
+  {
+    { 5 },
+    { { "0", { 4, 0 } }, { "1", { 4, 0 } } },
+    false,
+    false,
+    { },
+  },
+  {
+    { 2, 2, 2 },
+    { { "0", { 4, 0 } }, { "1", { 4, 3 } } },
+    false,
+    false,
+    { },
+  },
+  /* clang-format on */
+};
+
+struct ExpectedFragmentation
+{
+  std::map<std::string, cmCTestResourceAllocator::Resource> Resources;
+  double Fragmentation;
+};
+
+static const std::vector<ExpectedFragmentation> expectedFragmentations{
+  /* clang-format off */
+  { { }, 0.0 },
+  { { { "0", { 4, 0 } } }, 0.0 },
+  { { { "0", { 4, 4 } }, { "1", { 4, 4 } } }, 0.0 },
+  { { { "0", { 4, 0 } }, { "1", { 4, 0 } } }, 0.5 },
+  { { { "0", { 2, 0 } }, { "1", { 1, 0 } }, { "2", { 2, 1 } } }, 0.5 },
+  /* clang-format on */
+};
+
+struct ExpectedRejection
+{
+  std::vector<std::vector<int>> Rejected;
+  std::vector<int> SlotsNeeded;
+  bool ExpectedRejected;
+};
+
+static const std::vector<ExpectedRejection> expectedRejections{
+  /* clang-format off */
+  { { }, { 1 }, false },
+  { { { 3, 2 } }, { 3, 2 }, true },
+  { { { 3, 2 } }, { 2, 3 }, true },
+  { { { 3, 2 } }, { 3, 3 }, true },
+  { { { 3, 2 } }, { 4, 2, 1 }, true },
+  { { { 3, 2 } }, { 2, 2 }, false },
+  { { { 3, 2 } }, { 4 }, false },
+  { { { 3, 2 }, { 5 } }, { 6 }, true },
+  { { { 3, 2 }, { 5 } }, { 4, 1 }, false },
+  { { { 3, 3 }, { 3, 2 } }, { 3, 2, 1 }, true },
+  /* clang-format on */
+};
+
 struct AllocationComparison
 {
   cmCTestBinPackerAllocation First;
@@ -275,6 +381,85 @@ bool TestExpectedPackResult(const ExpectedPackResult& expected)
   return true;
 }
 
+bool TestExpectedBestFitResult(const ExpectedBestFitResult& expected)
+{
+  std::vector<cmCTestBinPackerAllocation> allocations;
+  allocations.reserve(expected.SlotsNeeded.size());
+  std::size_t index = 0;
+  for (auto const& n : expected.SlotsNeeded) {
+    allocations.push_back({ index++, n, "" });
+  }
+
+  if (cmCTestResourcesMayFit(expected.Resources, allocations) !=
+      expected.ExpectedMayFit) {
+    std::cout << "cmCTestResourcesMayFit did not return expected value"
+              << std::endl;
+    return false;
+  }
+
+  bool result = cmAllocateCTestResourcesBestFit(expected.Resources,
+                                                allocations);
+  if (result != expected.ExpectedReturnValue) {
+    std::cout << "cmAllocateCTestResourcesBestFit did not return expected "
+                 "value"
+              << std::endl;
+    return false;
+  }
+
+  if (result && allocations != expected.ExpectedAllocations) {
+    std::cout << "cmAllocateCTestResourcesBestFit did not return expected "
+                 "allocations"
+              << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static std::vector<cmCTestBinPackerAllocation> MakeAllocations(
+  const std::vector<int>& slotsNeeded)
+{
+  std::vector<cmCTestBinPackerAllocation> allocations;
+  std::size_t processIndex = 0;
+  for (auto const& slots : slotsNeeded) {
+    allocations.push_back({ processIndex++, slots, "" });
+  }
+  return allocations;
+}
+
+bool TestExpectedRejection(const ExpectedRejection& expected)
+{
+  cmCTestResourceRejectionIndex index;
+  for (auto const& rejected : expected.Rejected) {
+    index.Reject("gpus", MakeAllocations(rejected));
+  }
+
+  if (index.IsRejected("gpus", MakeAllocations(expected.SlotsNeeded)) !=
+      expected.ExpectedRejected) {
+    std::cout << "cmCTestResourceRejectionIndex::IsRejected did not return "
+                 "expected value"
+              << std::endl;
+    return false;
+  }
+
+  if (index.IsRejected("cpus", MakeAllocations(expected.SlotsNeeded))) {
+    std::cout << "cmCTestResourceRejectionIndex::IsRejected rejected an "
+                 "unrelated resource type"
+              << std::endl;
+    return false;
+  }
+
+  index.Clear("gpus");
+  if (index.IsRejected("gpus", MakeAllocations(expected.SlotsNeeded))) {
+    std::cout << "cmCTestResourceRejectionIndex::Clear did not clear the "
+                 "resource type"
+              << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
 int testCTestBinPacker(int /*unused*/, char* /*unused*/ [])
 {
   int retval = 0;
@@ -296,5 +481,27 @@ int testCTestBinPacker(int /*unused*/, char* /*unused*/ [])
     }
   }
 
+  for (auto const& expected : expectedBestFitResults) {
+    if (!TestExpectedBestFitResult(expected)) {
+      retval = 1;
+    }
+  }
+
+  for (auto const& expected : expectedRejections) {
+    if (!TestExpectedRejection(expected)) {
+      retval = 1;
+    }
+  }
+
+  for (auto const& expected : expectedFragmentations) {
+    double fragmentation = cmCTestResourceFragmentation(expected.Resources);
+    if (fragmentation < expected.Fragmentation - 1e-9 ||
+        fragmentation > expected.Fragmentation + 1e-9) {
+      std::cout << "cmCTestResourceFragmentation returned " << fragmentation
+                << ", expected " << expected.Fragmentation << std::endl;
+      retval = 1;
+    }
+  }
+
   return retval;
 }
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <string>
 
+#include "cmsys/FStream.hxx"
+
 #include "cmGeneratedFileStream.h"
 #include "cmSystemTools.h"
 
@@ -84,5 +86,44 @@ int testGeneratedFileStream(int /*unused*/, char* /*unused*/ [])
   cmSystemTools::RemoveFile(file3tmp);
   cmSystemTools::RemoveFile(file4tmp);
 
+  // Copy-if-different decisions using the manifest of generated files.
+  std::string const manifest = "generatedFiles.manifest";
+  std::string const file5 = "generatedFile5";
+  auto generate = [&file5](std::string const& content) -> bool {
+    cmGeneratedFileStream fout(file5);
+    fout.SetCopyIfDifferent(true);
+    fout << content;
+    return fout.Close();
+  };
+  cmGeneratedFileStream::LoadManifest(manifest);
+  if (!generate("This is generated file 5")) {
+    cmFailed("Generated file was not written: ", file5);
+  }
+  cmGeneratedFileStream::WriteManifest();
+  if (!cmSystemTools::FileExists(manifest)) {
+    cmFailed("Manifest of generated files was not written: ", manifest);
+  }
+  cmGeneratedFileStream::LoadManifest(manifest);
+  if (generate("This is generated file 5")) {
+    cmFailed("Unchanged generated file was replaced: ", file5);
+  }
+  cmGeneratedFileStream::WriteManifest();
+  cmGeneratedFileStream::LoadManifest(manifest);
+  if (!generate("This is changed generated file 5")) {
+    cmFailed("Changed generated file was not replaced: ", file5);
+  }
+  cmGeneratedFileStream::WriteManifest();
+  {
+    cmsys::ofstream fout(file5.c_str());
+    fout << "This was modified outside";
+  }
+  cmGeneratedFileStream::LoadManifest(manifest);
+  if (!generate("This is changed generated file 5")) {
+    cmFailed("Generated file modified outside was not replaced: ", file5);
+  }
+  cmGeneratedFileStream::WriteManifest();
+  cmSystemTools::RemoveFile(file5);
+  cmSystemTools::RemoveFile(manifest);
+
   return failed;
 }
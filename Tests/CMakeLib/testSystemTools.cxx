@@ -3,7 +3,9 @@
 
 #include <cmConfigure.h> // IWYU pragma: keep
 
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -11,6 +13,13 @@
 
 #include "cmSystemTools.h"
 
+static std::string readFile(std::string const& path)
+{
+  std::ifstream fin(path.c_str());
+  return std::string(std::istreambuf_iterator<char>(fin),
+                     std::istreambuf_iterator<char>());
+}
+
 #define cmPassed(m) std::cout << "Passed: " << (m) << "\n"
 #define cmFailed(m)                                                           \
   std::cout << "FAILED: " << (m) << "\n";                                     \
@@ -95,5 +104,30 @@ int testSystemTools(int /*unused*/, char* /*unused*/ [])
     cmPassed("cmSystemTools::strverscmp working");
   }
 
+  // ----------------------------------------------------------------------
+  // Test cmSystemTools::BreakHardLink
+  std::string const linkA = "testSystemTools-link-a.txt";
+  std::string const linkB = "testSystemTools-link-b.txt";
+  cmSystemTools::RemoveFile(linkA);
+  cmSystemTools::RemoveFile(linkB);
+  {
+    std::ofstream fout(linkA.c_str());
+    fout << "original";
+  }
+  if (cmSystemTools::CreateLink(linkA, linkB)) {
+    cmAssert(cmSystemTools::BreakHardLink(linkB),
+             "cmSystemTools::BreakHardLink succeeds");
+    {
+      std::ofstream fout(linkB.c_str());
+      fout << "modified";
+    }
+    cmAssert(readFile(linkA) == "original",
+             "cmSystemTools::BreakHardLink detaches the file");
+    cmAssert(cmSystemTools::BreakHardLink(linkA),
+             "cmSystemTools::BreakHardLink on an unlinked file");
+  }
+  cmSystemTools::RemoveFile(linkA);
+  cmSystemTools::RemoveFile(linkB);
+
   return failed;
 }
@@ -0,0 +1,29 @@
+# Report coverage of the source named in the coverage data file and of
+# main.cpp, so that the results of all gcov runs must be merged.
+set(main_cpp
+  "${CMAKE_CURRENT_LIST_DIR}/../CTestCoverageCollectGCOV/TestProject/main.cpp")
+get_filename_component(main_cpp "${main_cpp}" ABSOLUTE)
+
+function(create_gcov_file source_file)
+  get_filename_component(source_name "${source_file}" NAME)
+  file(WRITE "${CMAKE_SOURCE_DIR}/${source_name}.gcov"
+    "        -:    0:Source:${source_file}\n"
+    "        1:    1:line 1\n"
+    "    #####:    2:line 2\n"
+    "        -:    3:line 3\n"
+  )
+  message("File '${source_file}'")
+  message("Lines executed:50.00% of 2")
+  message("Creating '${source_name}.gcov'")
+  message("")
+endfunction()
+
+foreach(I RANGE 0 ${CMAKE_ARGC})
+  if("${CMAKE_ARGV${I}}" MATCHES ".*\\.gcda")
+    file(STRINGS "${CMAKE_ARGV${I}}" source_file LIMIT_COUNT 1 ENCODING UTF-8)
+    create_gcov_file("${source_file}")
+    if(NOT source_file STREQUAL main_cpp)
+      create_gcov_file("${main_cpp}")
+    endif()
+  endif()
+endforeach()
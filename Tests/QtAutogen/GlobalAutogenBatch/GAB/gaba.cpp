@@ -0,0 +1,6 @@
+#include "item.hpp"
+
+void gaba()
+{
+  Item item;
+}
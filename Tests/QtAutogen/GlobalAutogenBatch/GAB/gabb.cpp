@@ -0,0 +1,6 @@
+#include "item.hpp"
+
+void gabb()
+{
+  Item item;
+}
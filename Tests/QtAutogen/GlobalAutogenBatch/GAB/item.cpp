@@ -0,0 +1,5 @@
+#include "item.hpp"
+
+void Item::go()
+{
+}
@@ -0,0 +1,14 @@
+#include "item.hpp"
+
+void gaba();
+void gabb();
+
+int main(int argv, char** args)
+{
+  // Object instances
+  Item item;
+  // Library calls
+  gaba();
+  gabb();
+  return 0;
+}
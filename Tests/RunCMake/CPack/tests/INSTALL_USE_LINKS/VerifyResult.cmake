@@ -0,0 +1,19 @@
+# The staged file is a hard link to the file in the build tree, unless
+# the file system supports reflinks and it was cloned instead.
+if(CMAKE_HOST_SYSTEM_NAME STREQUAL "Linux")
+  file(GLOB staged "${bin_dir}/_CPack_Packages/*/*/*/foo/staged.txt")
+  if(NOT staged)
+    message(FATAL_ERROR "The staged file was not found${output_error_message}")
+  endif()
+  execute_process(COMMAND stat -c %h ${staged}
+    OUTPUT_VARIABLE links OUTPUT_STRIP_TRAILING_WHITESPACE)
+  if(NOT links EQUAL 2)
+    execute_process(
+      COMMAND cp --reflink=always ${staged} ${bin_dir}/reflink.txt
+      RESULT_VARIABLE reflink_result OUTPUT_QUIET ERROR_QUIET)
+    if(NOT reflink_result EQUAL 0)
+      message(FATAL_ERROR "The staged file has ${links} links instead of 2"
+        "${output_error_message}")
+    endif()
+  endif()
+endif()
@@ -0,0 +1,7 @@
+# Hard links are only made to sources whose permissions already match.
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/staged.txt" "staged\n")
+file(CHMOD "${CMAKE_CURRENT_BINARY_DIR}/staged.txt"
+  PERMISSIONS OWNER_READ OWNER_WRITE GROUP_READ WORLD_READ)
+install(FILES "${CMAKE_CURRENT_BINARY_DIR}/staged.txt" DESTINATION foo)
+
+set(CPACK_INSTALL_USE_LINKS HARDLINK)
@@ -1,3 +1,17 @@
 set(whitespaces_ "[\t\n\r ]*")
 set(md5sums_md5sums "^.* usr/foo/CMakeLists\.txt${whitespaces_}$")
 verifyDebControl("${FOUND_FILE_1}" "md5sums" "md5sums")
+
+# The sums are computed while data.tar is written; check the digest.
+execute_process(COMMAND ${DPKG_EXECUTABLE} -x "${FOUND_FILE_1}" data_md5sums
+  RESULT_VARIABLE res_)
+if(NOT res_ EQUAL 0)
+  message(FATAL_ERROR "Failed to extract '${FOUND_FILE_1}'")
+endif()
+file(MD5 "${CMAKE_CURRENT_BINARY_DIR}/data_md5sums/usr/foo/CMakeLists.txt"
+  expected_md5_)
+file(READ "${CMAKE_CURRENT_BINARY_DIR}/control_md5sums/md5sums" content_)
+if(NOT content_ MATCHES "^${expected_md5_}  usr/foo/CMakeLists\\.txt")
+  message(FATAL_ERROR "Unexpected md5sums content: '${content_}'"
+    " (expected digest ${expected_md5_})")
+endif()
@@ -0,0 +1,7 @@
+set(EXPECTED_FILES_COUNT "3")
+set(EXPECTED_FILE_1_COMPONENT "pkg_1")
+set(EXPECTED_FILE_CONTENT_1_LIST "/foo;/foo/one.txt")
+set(EXPECTED_FILE_2_COMPONENT "pkg_2")
+set(EXPECTED_FILE_CONTENT_2_LIST "/foo;/foo/two.txt")
+set(EXPECTED_FILE_3_COMPONENT "pkg_3")
+set(EXPECTED_FILE_CONTENT_3_LIST "/bar;/bar/three.txt")
@@ -0,0 +1,20 @@
+# Each component is installed by a script of its own when installing
+# components concurrently.
+file(GLOB drivers "${bin_dir}/_CPack_Packages/*/*/ComponentInstall/*.cmake")
+list(LENGTH drivers drivers_count)
+if(NOT drivers_count EQUAL 3)
+  message(FATAL_ERROR "Expected 3 component install scripts, found: "
+    "'${drivers}'${output_error_message}")
+endif()
+set(installed_components "")
+foreach(driver IN LISTS drivers)
+  file(STRINGS "${driver}" component REGEX "^# Installs component ")
+  string(REPLACE "# Installs component " "" component "${component}")
+  list(APPEND installed_components "${component}")
+endforeach()
+list(SORT installed_components)
+if(NOT installed_components STREQUAL "pkg_1;pkg_2;pkg_3")
+  message(FATAL_ERROR "Component install scripts install "
+    "'${installed_components}' instead of 'pkg_1;pkg_2;pkg_3'"
+    "${output_error_message}")
+endif()
@@ -0,0 +1,5 @@
+install(FILES CMakeLists.txt DESTINATION foo RENAME one.txt COMPONENT pkg_1)
+install(FILES CMakeLists.txt DESTINATION foo RENAME two.txt COMPONENT pkg_2)
+install(FILES CMakeLists.txt DESTINATION bar RENAME three.txt COMPONENT pkg_3)
+
+set(CPACK_COMPONENTS_INSTALL_JOBS 3)
@@ -397,3 +397,75 @@ function(run_testDir)
   run_cmake_command(testDir ${CMAKE_CTEST_COMMAND} --test-dir "${RunCMake_TEST_BINARY_DIR}/sub")
 endfunction()
 run_testDir()
+
+run_cmake_command(shard-opt-bad1 ${CMAKE_CTEST_COMMAND} --shard-count 0)
+run_cmake_command(shard-opt-bad2 ${CMAKE_CTEST_COMMAND} --shard-index foo)
+
+function(run_Shard)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Shard)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(A \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(A PROPERTIES COST 10)
+add_test(B \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(B PROPERTIES COST 4 DEPENDS A)
+add_test(C \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(C PROPERTIES COST 8)
+add_test(D \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(D PROPERTIES COST 5)
+add_test(E \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(E PROPERTIES COST 1)
+")
+  run_cmake_command(shard-0 ${CMAKE_CTEST_COMMAND} -N --shard-count 2 --shard-index 0)
+  run_cmake_command(shard-1 ${CMAKE_CTEST_COMMAND} -N --shard-count 2 --shard-index 1)
+  run_cmake_command(shard-index-bad ${CMAKE_CTEST_COMMAND} -N --shard-count 2 --shard-index 2)
+endfunction()
+run_Shard()
+
+function(run_AffectedBy)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/affected-by-build)
+  run_cmake(affected-by-cmake)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/changed-lib.txt"
+    "${RunCMake_TEST_BINARY_DIR}/lib.c\n")
+  run_cmake_command(affected-by-lib ${CMAKE_CTEST_COMMAND} -C Debug -N
+    --affected-by "${RunCMake_TEST_BINARY_DIR}/changed-lib.txt")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/changed-data.txt"
+    "${RunCMake_TEST_BINARY_DIR}/data.txt\n")
+  run_cmake_command(affected-by-data ${CMAKE_CTEST_COMMAND} -C Debug -N
+    --affected-by "${RunCMake_TEST_BINARY_DIR}/changed-data.txt")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/LastTestsFailed.log"
+    "2:UsesExe2\n3:UsesData\n")
+  run_cmake_command(affected-by-rerun-failed ${CMAKE_CTEST_COMMAND} -C Debug -N
+    --rerun-failed
+    --affected-by "${RunCMake_TEST_BINARY_DIR}/changed-data.txt")
+endfunction()
+run_AffectedBy()
+
+function(run_TestListCache)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestListCache)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}/sub")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(Test1 \"${CMAKE_COMMAND}\" -E true)
+subdirs(sub)
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/sub/CTestTestfile.cmake" "
+add_test(Test2 \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(Test2 PROPERTIES LABELS \"foo\")
+")
+  run_cmake_command(test-list-cache-first ${CMAKE_CTEST_COMMAND} -N -V --test-list-cache)
+  run_cmake_command(test-list-cache-reuse ${CMAKE_CTEST_COMMAND} -N -V --test-list-cache -L foo)
+  file(APPEND "${RunCMake_TEST_BINARY_DIR}/sub/CTestTestfile.cmake" "
+add_test(Test3 \"${CMAKE_COMMAND}\" -E true)
+")
+  run_cmake_command(test-list-cache-changed ${CMAKE_CTEST_COMMAND} -N -V --test-list-cache)
+  file(APPEND "${RunCMake_TEST_BINARY_DIR}/sub/CTestTestfile.cmake" "
+include(\"${RunCMake_TEST_BINARY_DIR}/extra.cmake\" OPTIONAL)
+")
+  run_cmake_command(test-list-cache-unsupported ${CMAKE_CTEST_COMMAND} -N -V --test-list-cache)
+endfunction()
+run_TestListCache()
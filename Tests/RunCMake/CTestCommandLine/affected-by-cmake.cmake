@@ -0,0 +1,14 @@
+enable_testing()
+set(CMAKE_CTEST_TARGET_GRAPH ON)
+enable_language(C)
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/lib.c" "int lib(void) { return 0; }\n")
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/main.c" "int main(void) { return 0; }\n")
+add_library(lib STATIC "${CMAKE_CURRENT_BINARY_DIR}/lib.c")
+add_executable(exe1 "${CMAKE_CURRENT_BINARY_DIR}/main.c")
+target_link_libraries(exe1 PRIVATE lib)
+add_executable(exe2 "${CMAKE_CURRENT_BINARY_DIR}/main.c")
+add_test(NAME UsesExe1 COMMAND exe1)
+add_test(NAME UsesExe2 COMMAND exe2)
+add_test(NAME UsesData COMMAND ${CMAKE_COMMAND} -E echo)
+set_tests_properties(UsesData PROPERTIES
+  REQUIRED_FILES "${CMAKE_CURRENT_BINARY_DIR}/data.txt")
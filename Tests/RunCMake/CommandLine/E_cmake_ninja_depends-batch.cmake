@@ -0,0 +1,64 @@
+set(dir "${CMAKE_CURRENT_BINARY_DIR}/depends-batch")
+file(REMOVE_RECURSE "${dir}")
+file(MAKE_DIRECTORY "${dir}")
+
+file(WRITE "${dir}/FortranDependInfo.json" "{
+  \"include-dirs\": [\"${dir}\"],
+  \"compiler-id\": \"GNU\",
+  \"submodule-sep\": \"@\",
+  \"submodule-ext\": \".smod\"
+}
+")
+file(WRITE "${dir}/a.f90" "module mod_a\nend module mod_a\n")
+file(WRITE "${dir}/b.f90" "subroutine b\n  use mod_a\n  include 'b.inc'\nend subroutine b\n")
+file(WRITE "${dir}/b.inc" "")
+file(WRITE "${dir}/FortranScanBatch.json" "[
+  {
+    \"src\": \"${dir}/a.f90\",
+    \"obj\": \"${dir}/a.o\",
+    \"ddi\": \"${dir}/a.o.ddi\"
+  },
+  {
+    \"src\": \"${dir}/b.f90\",
+    \"obj\": \"${dir}/b.o\",
+    \"ddi\": \"${dir}/b.o.ddi\"
+  }
+]
+")
+
+execute_process(
+  COMMAND ${CMAKE_COMMAND} -E cmake_ninja_depends
+    --tdi=${dir}/FortranDependInfo.json --lang=Fortran
+    --batch=${dir}/FortranScanBatch.json
+    --dep=${dir}/FortranScanBatch.json.d
+  RESULT_VARIABLE result
+  )
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "cmake_ninja_depends --batch failed: ${result}")
+endif()
+
+# Each source gets the same results as if scanned on its own.
+foreach(f IN ITEMS a.o.ddi b.o.ddi)
+  if(NOT EXISTS "${dir}/${f}")
+    message(FATAL_ERROR "cmake_ninja_depends --batch did not write ${f}")
+  endif()
+endforeach()
+foreach(f IN ITEMS a.o.ddi.d b.o.ddi.d)
+  if(EXISTS "${dir}/${f}")
+    message(FATAL_ERROR "cmake_ninja_depends --batch wrote unused ${f}")
+  endif()
+endforeach()
+file(READ "${dir}/a.o.ddi" ddi)
+if(NOT ddi MATCHES "\"logical-name\" : \"mod_a\\.mod\"")
+  message(FATAL_ERROR "a.o.ddi does not list the module provided:\n${ddi}")
+endif()
+file(READ "${dir}/b.o.ddi" ddi)
+if(NOT ddi MATCHES "\"requires\" :.*\"mod_a\\.mod\"")
+  message(FATAL_ERROR "b.o.ddi does not list the module required:\n${ddi}")
+endif()
+
+# The batch depfile lists the includes of all sources.
+file(READ "${dir}/FortranScanBatch.json.d" dep)
+if(NOT dep MATCHES "^[^:]*a\\.o\\.ddi:" OR NOT dep MATCHES "b\\.inc")
+  message(FATAL_ERROR "The batch depfile is not complete:\n${dep}")
+endif()
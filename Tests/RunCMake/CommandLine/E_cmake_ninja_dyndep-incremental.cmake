@@ -0,0 +1,86 @@
+set(dir "${CMAKE_CURRENT_BINARY_DIR}/dyndep")
+file(REMOVE_RECURSE "${dir}")
+file(MAKE_DIRECTORY "${dir}")
+
+file(WRITE "${dir}/CXXDependInfo.json" "{
+  \"dir-cur-bld\": \"${dir}\",
+  \"dir-cur-src\": \"${dir}\",
+  \"dir-top-bld\": \"${dir}\",
+  \"dir-top-src\": \"${dir}\",
+  \"module-dir\": \"${dir}\"
+}
+")
+
+function(write_ddi name provides requires)
+  set(provides_json "")
+  foreach(mod IN LISTS provides)
+    string(APPEND provides_json "{\"logical-name\": \"${mod}\"}")
+  endforeach()
+  set(requires_json "")
+  foreach(mod IN LISTS requires)
+    string(APPEND requires_json "{\"logical-name\": \"${mod}\"}")
+  endforeach()
+  file(WRITE "${dir}/${name}.ddi" "{
+  \"version\": 0,
+  \"revision\": 0,
+  \"rules\": [{
+    \"future-compile\": {
+      \"outputs\": [\"${dir}/${name}.o\"],
+      \"provides\": [${provides_json}],
+      \"requires\": [${requires_json}]
+    }
+  }]
+}
+")
+endfunction()
+
+function(run_dyndep)
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E cmake_ninja_dyndep
+      --tdi=${dir}/CXXDependInfo.json --lang=CXX --dd=${dir}/CXX.dd
+      ${dir}/a.ddi ${dir}/b.ddi
+    RESULT_VARIABLE result
+    )
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "cmake_ninja_dyndep failed: ${result}")
+  endif()
+endfunction()
+
+write_ddi(a "mod_a" "")
+write_ddi(b "" "")
+run_dyndep()
+if(NOT EXISTS "${dir}/CXX.dd.cache")
+  message(FATAL_ERROR "cmake_ninja_dyndep did not cache the scan results")
+endif()
+file(READ "${dir}/CXX.dd" dd)
+if(NOT dd MATCHES "build a\\.o \\| mod_a\\.mod: dyndep\n")
+  message(FATAL_ERROR "CXX.dd does not list the module provided by a.o:\n${dd}")
+endif()
+
+# Collating unchanged scan results must not replace the dyndep file.
+file(TIMESTAMP "${dir}/CXX.dd" before "%s")
+execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1.1)
+run_dyndep()
+file(TIMESTAMP "${dir}/CXX.dd" after "%s")
+if(NOT before STREQUAL after)
+  message(FATAL_ERROR "CXX.dd was replaced although it did not change")
+endif()
+
+# Rescanning that produces the same results must not replace it either.
+execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1.1)
+write_ddi(a "mod_a" "")
+write_ddi(b "" "")
+run_dyndep()
+file(TIMESTAMP "${dir}/CXX.dd" after "%s")
+if(NOT before STREQUAL after)
+  message(FATAL_ERROR "CXX.dd was replaced although the rescanned results "
+    "did not change")
+endif()
+
+# A changed scan result must be collated.
+write_ddi(b "" "mod_a")
+run_dyndep()
+file(READ "${dir}/CXX.dd" dd)
+if(NOT dd MATCHES "build b\\.o: dyndep \\| mod_a\\.mod\n")
+  message(FATAL_ERROR "CXX.dd does not list the module required by b.o:\n${dd}")
+endif()
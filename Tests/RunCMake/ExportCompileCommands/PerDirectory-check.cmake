@@ -0,0 +1,23 @@
+macro(check_commands file expected)
+  if(NOT EXISTS "${file}")
+    string(APPEND RunCMake_TEST_FAILED "${file} not generated\n")
+  else()
+    file(READ "${file}" compile_commands)
+    string(JSON num_commands ERROR_VARIABLE error LENGTH "${compile_commands}")
+    if(error)
+      string(APPEND RunCMake_TEST_FAILED "${file}: ${error}\n")
+    elseif(NOT num_commands EQUAL ${expected})
+      string(APPEND RunCMake_TEST_FAILED
+        "${file} has ${num_commands} compile commands, not ${expected}\n")
+    endif()
+  endif()
+endmacro()
+
+check_commands("${RunCMake_TEST_BINARY_DIR}/compile_commands.json" 2)
+check_commands("${RunCMake_TEST_BINARY_DIR}/CMakeFiles/compile_commands.json" 1)
+check_commands(
+  "${RunCMake_TEST_BINARY_DIR}/PerDirectory/CMakeFiles/compile_commands.json" 1)
+if(compile_commands AND NOT compile_commands MATCHES "expected_file\\.c")
+  string(APPEND RunCMake_TEST_FAILED
+    "The subdirectory fragment does not list expected_file.c\n")
+endif()
@@ -0,0 +1,7 @@
+enable_language(C)
+
+set(CMAKE_EXPORT_COMPILE_COMMANDS_PER_DIRECTORY TRUE)
+set(CMAKE_EXPORT_COMPILE_COMMANDS TRUE)
+
+add_library(Top STATIC empty.c)
+add_subdirectory(PerDirectory)
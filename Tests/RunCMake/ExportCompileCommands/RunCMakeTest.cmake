@@ -10,3 +10,4 @@ run_cmake_with_options(BeforeProject -DCMAKE_PROJECT_INCLUDE_BEFORE=BeforeProjec
 run_cmake(CustomCompileRule)
 run_cmake(Properties)
 run_cmake(PropertiesGenerateCommand)
+run_cmake(PerDirectory)
@@ -12,6 +12,8 @@ run_cmake(zip)
 
 # Extracting only selected files or directories
 run_cmake(zip-filtered)
+run_cmake(paxr-index)
+run_cmake(gnutar-gz-index)
 
 run_cmake(unsupported-format)
 run_cmake(zip-with-bad-compression)
@@ -24,3 +26,10 @@ run_cmake(gnutar-gz-compression-level)
 run_cmake(pax-xz-compression-level)
 run_cmake(pax-zstd-compression-level)
 run_cmake(paxr-bz2-compression-level)
+
+run_cmake(unsupported-threads)
+run_cmake(pax-xz-threads)
+set(RunCMake_TEST_OPTIONS
+  -DCMAKE_USE_SYSTEM_LIBARCHIVE=${CMAKE_USE_SYSTEM_LIBARCHIVE})
+run_cmake(pax-zstd-threads)
+unset(RunCMake_TEST_OPTIONS)
@@ -0,0 +1,38 @@
+set(OUTPUT_NAME "test.tar.gz")
+
+set(ARCHIVE_FORMAT gnutar)
+set(COMPRESSION_TYPE GZip)
+
+set(INDEX_FILE "${CMAKE_CURRENT_BINARY_DIR}/test.tar.gz.index")
+set(COMPRESSION_OPTIONS INDEX "${INDEX_FILE}")
+
+# The index of a compressed archive is only used for listing.
+set(DECOMPRESSION_OPTIONS
+  INDEX "${INDEX_FILE}"
+  PATTERNS
+    compress_dir/f1.txt
+    compress_*/d?
+)
+
+set(CUSTOM_CHECK_FILES
+  "f1.txt"
+  "d1/f1.txt"
+)
+
+set(NOT_EXISTING_FILES_CHECK
+  "d 2/f1.txt"
+  "d + 3/f1.txt"
+)
+
+include(${CMAKE_CURRENT_LIST_DIR}/roundtrip.cmake)
+
+check_magic("1f8b" LIMIT 2 HEX)
+
+# The index lists the members as they are named in the archive.
+check_index_listing()
+check_index_listing(compress_dir/f1.txt "compress_*/d?")
+
+file(STRINGS "${INDEX_FILE}" index REGEX "compress_dir/d 2/f1.txt$")
+if(NOT index)
+  message(SEND_ERROR "Index does not list compress_dir/d 2/f1.txt")
+endif()
@@ -0,0 +1 @@
+file(ARCHIVE_EXTRACT INPUT "${INPUT}" ${OPTIONS} LIST_ONLY)
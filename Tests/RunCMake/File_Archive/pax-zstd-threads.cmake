@@ -0,0 +1,31 @@
+set(OUTPUT_NAME "test.tar.zstd")
+
+set(ARCHIVE_FORMAT pax)
+set(COMPRESSION_TYPE Zstd)
+set(COMPRESSION_OPTIONS THREADS 0)
+
+include(${CMAKE_CURRENT_LIST_DIR}/roundtrip.cmake)
+
+check_magic("28b52ffd0058" LIMIT 6 HEX)
+
+# Zstd splits input larger than a few MiB into jobs when it uses worker
+# threads, which changes the compressed data.  The bundled zstd supports
+# them, so check that the threads were used.
+if(NOT CMAKE_USE_SYSTEM_LIBARCHIVE)
+  string(REPEAT "0123456789abcdefghijklmnopqrstuvwxyz\n" 1024 block)
+  string(REPEAT "${block}" 256 content)
+  file(WRITE ${CMAKE_CURRENT_BINARY_DIR}/large_dir/large.txt "${content}")
+  foreach(threads 1 2)
+    set(large_output ${CMAKE_CURRENT_BINARY_DIR}/large-${threads}.tar.zstd)
+    file(ARCHIVE_CREATE
+      OUTPUT ${large_output}
+      FORMAT paxr
+      COMPRESSION Zstd
+      THREADS ${threads}
+      PATHS large_dir)
+    file(SHA256 ${large_output} large_hash_${threads})
+  endforeach()
+  if(large_hash_1 STREQUAL large_hash_2)
+    message(FATAL_ERROR "Zstd compression with 2 threads did not use them")
+  endif()
+endif()
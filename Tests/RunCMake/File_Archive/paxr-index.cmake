@@ -0,0 +1,61 @@
+set(OUTPUT_NAME "test.tar")
+
+set(ARCHIVE_FORMAT paxr)
+
+set(INDEX_FILE "${CMAKE_CURRENT_BINARY_DIR}/test.tar.index")
+set(COMPRESSION_OPTIONS INDEX "${INDEX_FILE}")
+
+# Members are read directly at the offsets recorded in the index.
+set(DECOMPRESSION_OPTIONS
+  INDEX "${INDEX_FILE}"
+  PATTERNS
+    compress_dir/f1.txt
+    compress_*/d?
+)
+
+set(CUSTOM_CHECK_FILES
+  "f1.txt"
+  "d1/f1.txt"
+)
+
+set(NOT_EXISTING_FILES_CHECK
+  "d 2/f1.txt"
+  "d + 3/f1.txt"
+  "d_4/f1.txt"
+  "d-4/f1.txt"
+)
+
+include(${CMAKE_CURRENT_LIST_DIR}/roundtrip.cmake)
+
+check_magic("7573746172003030" OFFSET 257 LIMIT 8 HEX)
+
+# The index lists the members as they are named in the archive.
+check_index_listing()
+check_index_listing(compress_dir/f1.txt "compress_*/d?")
+
+# Listing with the index does not read the archive.
+file(ARCHIVE_EXTRACT
+  INPUT "${FULL_OUTPUT_NAME}"
+  INDEX "${INDEX_FILE}"
+  PATTERNS compress_dir/d1
+  LIST_ONLY)
+
+# The index of an archive written again is stale, so the archive itself is
+# read even though the members moved.
+file(ARCHIVE_CREATE
+  OUTPUT "${FULL_OUTPUT_NAME}"
+  FORMAT "${ARCHIVE_FORMAT}"
+  PATHS "${COMPRESS_DIR}/d_4" "${COMPRESS_DIR}/f1.txt" "${COMPRESS_DIR}/d1")
+file(REMOVE_RECURSE "${FULL_DECOMPRESS_DIR}")
+file(ARCHIVE_EXTRACT
+  INPUT "${FULL_OUTPUT_NAME}"
+  INDEX "${INDEX_FILE}"
+  DESTINATION "${FULL_DECOMPRESS_DIR}"
+  PATTERNS compress_dir/f1.txt compress_dir/d1/f1.txt)
+foreach(file IN ITEMS f1.txt d1/f1.txt)
+  file(MD5 "${FULL_COMPRESS_DIR}/${file}" input_md5)
+  file(MD5 "${FULL_DECOMPRESS_DIR}/${COMPRESS_DIR}/${file}" output_md5)
+  if(NOT input_md5 STREQUAL output_md5)
+    message(SEND_ERROR "File \"${file}\" not extracted with a stale index")
+  endif()
+endforeach()
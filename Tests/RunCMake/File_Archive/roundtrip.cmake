@@ -39,6 +39,7 @@ file(ARCHIVE_CREATE
   OUTPUT ${FULL_OUTPUT_NAME}
   FORMAT "${ARCHIVE_FORMAT}"
   COMPRESSION "${COMPRESSION_TYPE}"
+  ${COMPRESSION_OPTIONS}
   VERBOSE
   PATHS ${COMPRESS_DIR})
 
@@ -107,3 +108,32 @@ function(check_compression_level COMPRESSION_LEVEL)
     DESTINATION ${FULL_DECOMPRESS_DIR}
     VERBOSE)
 endfunction()
+
+function(list_archive OUTPUT_VARIABLE)
+  execute_process(
+    COMMAND ${CMAKE_COMMAND}
+      "-DINPUT=${FULL_OUTPUT_NAME}"
+      "-DOPTIONS=${ARGN}"
+      -P ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/list-only.cmake
+    OUTPUT_VARIABLE out
+    ERROR_VARIABLE err
+    RESULT_VARIABLE res
+  )
+  if(NOT res EQUAL 0)
+    message(FATAL_ERROR "Listing ${FULL_OUTPUT_NAME} failed:\n${err}")
+  endif()
+  set(${OUTPUT_VARIABLE} "${out}" PARENT_SCOPE)
+endfunction()
+
+function(check_index_listing)
+  if(ARGN)
+    set(patterns PATTERNS ${ARGN})
+  endif()
+  list_archive(ACTUAL INDEX "${INDEX_FILE}" ${patterns})
+  list_archive(EXPECTED ${patterns})
+
+  if(EXPECTED STREQUAL "" OR NOT ACTUAL STREQUAL EXPECTED)
+    message(SEND_ERROR
+      "Listing with the index [${ACTUAL}] does not match [${EXPECTED}]")
+  endif()
+endfunction()
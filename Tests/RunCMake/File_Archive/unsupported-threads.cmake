@@ -0,0 +1,5 @@
+file(ARCHIVE_CREATE
+  OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/test.tar.zstd
+  COMPRESSION Zstd
+  THREADS -1
+  PATHS ${CMAKE_CURRENT_LIST_FILE})
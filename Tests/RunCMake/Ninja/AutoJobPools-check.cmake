@@ -0,0 +1,34 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/rules.ninja" rules_file)
+foreach(pool IN ITEMS cmake_job_pool_compile_512 cmake_job_pool_compile_1024
+                      cmake_job_pool_link_4096)
+  string(REGEX MATCHALL "\npool ${pool}\n  depth = [1-9][0-9]*\n"
+    defs "${rules_file}")
+  list(LENGTH defs count)
+  if(NOT count EQUAL 1)
+    string(APPEND RunCMake_TEST_FAILED
+      "rules.ninja defines pool ${pool} ${count} times, not once\n")
+  endif()
+endforeach()
+
+file(READ "${RunCMake_TEST_BINARY_DIR}/build.ninja" build_file)
+string(REGEX MATCHALL "pool = cmake_job_pool_compile_512\n" uses
+  "${build_file}")
+list(LENGTH uses count)
+if(NOT count EQUAL 2)
+  string(APPEND RunCMake_TEST_FAILED
+    "build.ninja uses the automatic compile pool ${count} times, not 2\n")
+endif()
+string(REGEX MATCHALL "pool = cmake_job_pool_compile_1024\n" uses
+  "${build_file}")
+list(LENGTH uses count)
+if(NOT count EQUAL 2)
+  string(APPEND RunCMake_TEST_FAILED
+    "build.ninja uses the default compile pool ${count} times, not 2\n")
+endif()
+string(REGEX MATCHALL "pool = cmake_job_pool_link_4096\n" uses
+  "${build_file}")
+list(LENGTH uses count)
+if(NOT count EQUAL 3)
+  string(APPEND RunCMake_TEST_FAILED
+    "build.ninja uses the automatic link pool ${count} times, not 3\n")
+endif()
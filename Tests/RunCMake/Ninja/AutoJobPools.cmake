@@ -0,0 +1,18 @@
+enable_language(C)
+
+set(CMAKE_NINJA_AUTO_JOB_POOLS 1)
+
+add_library(light STATIC dep.c)
+set_property(TARGET light PROPERTY JOB_POOL_COMPILE_MEMORY 512)
+
+add_library(heavy SHARED dep.c)
+set_property(TARGET heavy PROPERTY JOB_POOL_COMPILE_MEMORY 512)
+set_property(TARGET heavy PROPERTY JOB_POOL_LINK_MEMORY 4096)
+
+# Without a memory property, default weights are assumed.
+add_library(plain SHARED dep.c)
+
+set_property(GLOBAL PROPERTY JOB_POOLS explicit_pool=1)
+add_library(explicit SHARED dep.c)
+set_property(TARGET explicit PROPERTY JOB_POOL_LINK explicit_pool)
+set_property(TARGET explicit PROPERTY JOB_POOL_LINK_MEMORY 4096)
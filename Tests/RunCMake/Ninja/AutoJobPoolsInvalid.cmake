@@ -0,0 +1,6 @@
+enable_language(C)
+
+set(CMAKE_NINJA_AUTO_JOB_POOLS 1)
+
+add_library(invalid STATIC dep.c greeting.c)
+set_property(TARGET invalid PROPERTY JOB_POOL_COMPILE_MEMORY lots)
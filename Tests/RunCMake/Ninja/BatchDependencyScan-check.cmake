@@ -0,0 +1,18 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/build.ninja" build_file)
+string(REGEX MATCHALL "\nbuild [^\n]*: Fortran_SCAN_BATCH__batch_[^\n]*"
+  batches "${build_file}")
+list(LENGTH batches count)
+if(NOT count EQUAL 1)
+  string(APPEND RunCMake_TEST_FAILED
+    "build.ninja has ${count} batch scan statements, not one\n")
+endif()
+if(build_file MATCHES "\nbuild [^\n]*: Fortran_SCAN__batch_")
+  string(APPEND RunCMake_TEST_FAILED
+    "build.ninja scans a source of the batch on its own\n")
+endif()
+foreach(src IN ITEMS consumer provider)
+  if(NOT batches MATCHES "${src}\\.f90\\.o\\.ddi")
+    string(APPEND RunCMake_TEST_FAILED
+      "The batch scan statement does not produce the ${src} ddi file\n")
+  endif()
+endforeach()
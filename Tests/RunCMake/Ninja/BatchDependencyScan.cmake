@@ -0,0 +1,13 @@
+enable_language(Fortran)
+
+set(CMAKE_NINJA_BATCH_DEPENDENCY_SCAN 1)
+
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/provider.f90"
+  "module batch_mod\nend module batch_mod\n")
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/consumer.f90"
+  "subroutine consumer\n  use batch_mod\nend subroutine consumer\n")
+add_library(batch STATIC
+  "${CMAKE_CURRENT_BINARY_DIR}/consumer.f90"
+  "${CMAKE_CURRENT_BINARY_DIR}/provider.f90"
+  )
+set_property(TARGET batch PROPERTY Fortran_PREPROCESS OFF)
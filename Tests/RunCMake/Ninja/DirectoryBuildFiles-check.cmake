@@ -0,0 +1,21 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/build.ninja" build_file)
+foreach(subninja IN ITEMS "CMakeFiles/build.ninja" "sub/CMakeFiles/build.ninja")
+  if(NOT build_file MATCHES "\nsubninja ${subninja}\n")
+    string(APPEND RunCMake_TEST_FAILED
+      "build.ninja does not include ${subninja}\n")
+  endif()
+  if(NOT build_file MATCHES "\nbuild build\\.ninja[^\n:]* ${subninja}[ :][^\n]*RERUN_CMAKE")
+    string(APPEND RunCMake_TEST_FAILED
+      "build.ninja does not regenerate ${subninja}\n")
+  endif()
+endforeach()
+if(build_file MATCHES "\nbuild [^\n]*greeting2.c.o:")
+  string(APPEND RunCMake_TEST_FAILED
+    "build.ninja contains the build statements of the subdirectory\n")
+endif()
+
+file(READ "${RunCMake_TEST_BINARY_DIR}/sub/CMakeFiles/build.ninja" sub_file)
+if(NOT sub_file MATCHES "\nbuild [^\n]*greeting2.c.o:")
+  string(APPEND RunCMake_TEST_FAILED
+    "sub/CMakeFiles/build.ninja does not contain the subdirectory objects\n")
+endif()
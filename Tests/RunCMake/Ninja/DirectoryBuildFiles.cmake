@@ -0,0 +1,9 @@
+enable_language(C)
+
+set(CMAKE_NINJA_DIRECTORY_BUILD_FILES 1)
+
+add_library(top_lib STATIC dep.c)
+
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/sub_src/CMakeLists.txt"
+  "add_library(sub_lib STATIC \"${CMAKE_CURRENT_SOURCE_DIR}/greeting2.c\")\n")
+add_subdirectory("${CMAKE_CURRENT_BINARY_DIR}/sub_src" sub)
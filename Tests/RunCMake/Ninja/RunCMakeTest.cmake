@@ -77,6 +77,49 @@ if(TEST_Fortran)
   run_cmake(RspFileFortran)
 endif()
 
+function(run_BatchDependencyScan)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/BatchDependencyScan-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  run_cmake(BatchDependencyScan)
+  run_cmake_command(BatchDependencyScan-build ${CMAKE_COMMAND} --build .)
+endfunction()
+if(TEST_Fortran)
+  run_BatchDependencyScan()
+endif()
+
+function(run_SharedCompileVariables)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/SharedCompileVariables-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  run_cmake(SharedCompileVariables)
+  run_cmake_command(SharedCompileVariables-build ${CMAKE_COMMAND} --build .)
+endfunction()
+run_SharedCompileVariables()
+
+function(run_DirectoryBuildFiles)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/DirectoryBuildFiles-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  run_cmake(DirectoryBuildFiles)
+  run_cmake_command(DirectoryBuildFiles-build ${CMAKE_COMMAND} --build .)
+endfunction()
+run_DirectoryBuildFiles()
+
+function(run_AutoJobPools)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/AutoJobPools-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  run_cmake(AutoJobPools)
+  run_cmake_command(AutoJobPools-build ${CMAKE_COMMAND} --build .)
+endfunction()
+run_AutoJobPools()
+run_cmake(AutoJobPoolsInvalid)
+
 function(run_CommandConcat)
   set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/CommandConcat-build)
   set(RunCMake_TEST_NO_CLEAN 1)
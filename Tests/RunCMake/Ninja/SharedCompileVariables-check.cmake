@@ -0,0 +1,18 @@
+set(build_ninja "${RunCMake_TEST_BINARY_DIR}/build.ninja")
+file(READ "${build_ninja}" build_file)
+
+set(shared_var "C_DEFINES__shared_vars_[A-Za-z]*")
+if(NOT build_file MATCHES "\n${shared_var} = -DSHARED_DEFINE\n")
+  string(APPEND RunCMake_TEST_FAILED
+    "Log file:\n ${build_ninja}\ndoes not define the shared DEFINES variable\n")
+endif()
+string(REGEX MATCHALL "\n  DEFINES = \\\${${shared_var}}\n" shared_uses "${build_file}")
+list(LENGTH shared_uses shared_uses_count)
+if(NOT shared_uses_count EQUAL 2)
+  string(APPEND RunCMake_TEST_FAILED
+    "Log file:\n ${build_ninja}\nreferences the shared DEFINES variable ${shared_uses_count} times, expected 2\n")
+endif()
+if(NOT build_file MATCHES "\n  DEFINES = [^\n]*-DSOURCE_DEFINE")
+  string(APPEND RunCMake_TEST_FAILED
+    "Log file:\n ${build_ninja}\ndoes not keep the source-specific DEFINES\n")
+endif()
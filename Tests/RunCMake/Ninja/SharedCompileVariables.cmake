@@ -0,0 +1,7 @@
+enable_language(C)
+
+set(CMAKE_NINJA_SHARED_COMPILE_VARIABLES 1)
+
+add_library(shared_vars STATIC dep.c greeting2.c hello.c)
+target_compile_definitions(shared_vars PRIVATE SHARED_DEFINE)
+set_property(SOURCE hello.c PROPERTY COMPILE_DEFINITIONS SOURCE_DEFINE)
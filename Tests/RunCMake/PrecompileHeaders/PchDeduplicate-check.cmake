@@ -0,0 +1,18 @@
+set(pch_dir "")
+if (RunCMake_GENERATOR_IS_MULTI_CONFIG)
+  set(pch_dir "/Debug")
+endif()
+
+foreach(tgt IN ITEMS foo other optout donor pdbnamed)
+  set(pch_header "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/${tgt}.dir${pch_dir}/cmake_pch.h")
+  if (NOT EXISTS "${pch_header}")
+    set(RunCMake_TEST_FAILED "Generated ${tgt} pch header ${pch_header} does not exist")
+    return()
+  endif()
+endforeach()
+
+set(foobar_pch_header "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/foobar.dir${pch_dir}/cmake_pch.h")
+if (EXISTS "${foobar_pch_header}")
+  set(RunCMake_TEST_FAILED "Generated foobar pch header ${foobar_pch_header} should not exist")
+  return()
+endif()
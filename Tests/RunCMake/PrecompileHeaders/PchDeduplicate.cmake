@@ -0,0 +1,64 @@
+cmake_minimum_required(VERSION 3.15)
+project(PchDeduplicate C)
+
+if(CMAKE_C_COMPILE_OPTIONS_USE_PCH)
+  add_definitions(-DHAVE_PCH_SUPPORT)
+endif()
+
+set(CMAKE_PRECOMPILE_HEADERS_DEDUPLICATE ON)
+
+add_library(foo foo.c)
+target_include_directories(foo PUBLIC include)
+target_precompile_headers(foo PRIVATE
+  <stdio.h>
+  <string.h>
+)
+
+# Same headers and compile context as foo: reuses its precompiled header.
+add_executable(foobar foobar.c)
+target_link_libraries(foobar foo)
+target_precompile_headers(foobar PRIVATE
+  <stdio.h>
+  <string.h>
+)
+
+# Different compile definitions: builds its own precompiled header.
+add_library(other empty.c)
+target_include_directories(other PUBLIC include)
+target_compile_definitions(other PRIVATE OTHER)
+target_precompile_headers(other PRIVATE
+  <stdio.h>
+  <string.h>
+)
+
+# Opted out: builds its own precompiled header.
+add_library(optout empty.c)
+target_include_directories(optout PUBLIC include)
+target_precompile_headers(optout PRIVATE
+  <stdio.h>
+  <string.h>
+)
+set_property(TARGET optout PROPERTY PRECOMPILE_HEADERS_DEDUPLICATE OFF)
+
+# Reused explicitly by another target: builds its own precompiled header.
+add_library(donor empty.c)
+target_include_directories(donor PUBLIC include)
+target_precompile_headers(donor PRIVATE
+  <stdio.h>
+  <string.h>
+)
+add_library(reuser empty.c)
+target_include_directories(reuser PUBLIC include)
+set_property(TARGET reuser PROPERTY PRECOMPILE_HEADERS_REUSE_FROM donor)
+
+# Names its compiler PDB: builds its own precompiled header.
+add_library(pdbnamed empty.c)
+target_include_directories(pdbnamed PUBLIC include)
+target_precompile_headers(pdbnamed PRIVATE
+  <stdio.h>
+  <string.h>
+)
+set_property(TARGET pdbnamed PROPERTY COMPILE_PDB_NAME pdbnamed_custom)
+
+enable_testing()
+add_test(NAME foobar COMMAND foobar)
@@ -22,6 +22,10 @@ run_cmake(PchMultilanguage)
 if(RunCMake_GENERATOR MATCHES "Make|Ninja")
   run_cmake(PchWarnInvalid)
 
+  if(CMAKE_C_COMPILER_ID MATCHES "GNU|Clang" AND NOT CMAKE_HOST_WIN32)
+    run_test(PchDeduplicate)
+  endif()
+
   if(CMAKE_C_COMPILER_ID STREQUAL "Clang" AND
      CMAKE_C_COMPILER_VERSION VERSION_GREATER_EQUAL 11.0.0)
     run_cmake(PchInstantiateTemplates)
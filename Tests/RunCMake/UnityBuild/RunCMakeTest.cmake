@@ -17,6 +17,9 @@ run_cmake(unitybuild_cxx_group)
 run_cmake(unitybuild_c_and_cxx)
 run_cmake(unitybuild_c_and_cxx_group)
 run_cmake(unitybuild_batchsize)
+if(RunCMake_GENERATOR MATCHES "Ninja")
+  run_cmake(unitybuild_cost)
+endif()
 run_cmake(unitybuild_default_batchsize)
 run_cmake(unitybuild_skip)
 run_cmake(unitybuild_code_before_and_after_include)
@@ -0,0 +1,15 @@
+set(unitybuild_c0 "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/tgt.dir/Unity/unity_0_c.c")
+file(STRINGS ${unitybuild_c0} unitybuild_c0_strings)
+string(REGEX MATCH ".*#include.*s1.c.*#include.*s4.c.*" matched_code ${unitybuild_c0_strings})
+if(NOT matched_code)
+  set(RunCMake_TEST_FAILED "Generated unity file doesn't group s1.c with s4.c")
+  return()
+endif()
+
+set(unitybuild_c1 "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/tgt.dir/Unity/unity_1_c.c")
+file(STRINGS ${unitybuild_c1} unitybuild_c1_strings)
+string(REGEX MATCH ".*#include.*s2.c.*#include.*s3.c.*" matched_code ${unitybuild_c1_strings})
+if(NOT matched_code)
+  set(RunCMake_TEST_FAILED "Generated unity file doesn't group s2.c with s3.c")
+  return()
+endif()
@@ -0,0 +1,25 @@
+project(unitybuild_cost C)
+
+set(srcs "")
+foreach(s RANGE 1 4)
+  set(src "${CMAKE_CURRENT_BINARY_DIR}/s${s}.c")
+  file(WRITE "${src}" "int s${s}(void) { return 0; }\n")
+  list(APPEND srcs "${src}")
+endforeach()
+
+# Durations of the objects compiled by a previous build without unity.
+file(WRITE "${CMAKE_BINARY_DIR}/.ninja_log" "# ninja log v5
+0\t1000\t0\tCMakeFiles/tgt.dir/s1.c.o\t0
+0\t900\t0\tCMakeFiles/tgt.dir/s2.c.o\t0
+0\t100\t0\tCMakeFiles/tgt.dir/s3.c.o\t0
+0\t50\t0\tCMakeFiles/tgt.dir/s4.c.o\t0
+")
+
+add_library(tgt SHARED ${srcs})
+
+set_target_properties(tgt
+  PROPERTIES
+    UNITY_BUILD ON
+    UNITY_BUILD_MODE COST
+    UNITY_BUILD_BATCH_SIZE 2
+)
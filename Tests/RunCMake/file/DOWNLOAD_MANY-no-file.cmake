@@ -0,0 +1 @@
+file(DOWNLOAD_MANY URL "file:///does/not/exist" STATUS status)
@@ -0,0 +1,116 @@
+if(NOT "${CMAKE_CURRENT_BINARY_DIR}" MATCHES "^/")
+  set(slash /)
+endif()
+set(src "${CMAKE_CURRENT_BINARY_DIR}/src")
+set(dst "${CMAKE_CURRENT_BINARY_DIR}/dst")
+set(cache "${CMAKE_CURRENT_BINARY_DIR}/cache")
+file(REMOVE_RECURSE "${src}" "${dst}" "${cache}")
+
+foreach(n 1 2 3 4 5)
+  string(REPEAT "content of file ${n}\n" 1000 content_${n})
+  file(WRITE "${src}/${n}.txt" "${content_${n}}")
+  file(SHA256 "${src}/${n}.txt" hash_${n})
+endforeach()
+
+function(check_status var expect)
+  list(GET ${var} 0 code)
+  if(NOT code EQUAL 0)
+    message(SEND_ERROR "${var} is '${${var}}'")
+  elseif(NOT "${${var}}" MATCHES "${expect}")
+    message(SEND_ERROR "${var} is '${${var}}', expected to match '${expect}'")
+  endif()
+endfunction()
+
+function(check_files)
+  foreach(n IN LISTS ARGN)
+    if(NOT EXISTS "${dst}/${n}.txt")
+      message(SEND_ERROR "${dst}/${n}.txt was not downloaded")
+      continue()
+    endif()
+    file(SHA256 "${dst}/${n}.txt" hash)
+    if(NOT hash STREQUAL hash_${n})
+      message(SEND_ERROR "${dst}/${n}.txt does not have the expected content")
+    endif()
+    if(EXISTS "${dst}/${n}.txt.part")
+      message(SEND_ERROR "${dst}/${n}.txt.part was left behind")
+    endif()
+  endforeach()
+endfunction()
+
+# Download everything and fill the cache.
+file(DOWNLOAD_MANY
+  PARALLEL 2
+  CACHE_DIR "${cache}"
+  URL "file://${slash}${src}/1.txt" FILE "${dst}/1.txt"
+      EXPECTED_HASH SHA256=${hash_1} STATUS status_1
+  URL "file://${slash}${src}/2.txt" FILE "${dst}/2.txt"
+      EXPECTED_HASH SHA256=${hash_2} STATUS status_2
+  URL "file://${slash}${src}/3.txt" FILE "${dst}/3.txt"
+      EXPECTED_HASH SHA256=${hash_3} STATUS status_3
+  URL "file://${slash}${src}/4.txt" FILE "${dst}/4.txt"
+      EXPECTED_HASH SHA256=${hash_4} STATUS status_4
+  URL "file://${slash}${src}/5.txt" FILE "${dst}/5.txt" STATUS status_5
+  )
+foreach(n 1 2 3 4 5)
+  check_status(status_${n} "No error")
+endforeach()
+check_files(1 2 3 4 5)
+foreach(n 1 2 3 4)
+  string(SUBSTRING "${hash_${n}}" 0 2 prefix)
+  if(NOT EXISTS "${cache}/SHA256/${prefix}/${hash_${n}}")
+    message(SEND_ERROR "${dst}/${n}.txt was not added to the cache")
+  endif()
+endforeach()
+
+# Files that are already present are not downloaded again.
+file(DOWNLOAD_MANY
+  URL "file://${slash}${src}/1.txt" FILE "${dst}/1.txt"
+      EXPECTED_HASH SHA256=${hash_1} STATUS status_1
+  )
+check_status(status_1 "file already exists")
+
+# An interrupted transfer is continued.
+file(REMOVE "${dst}/1.txt")
+string(SUBSTRING "${content_1}" 0 5000 partial)
+file(WRITE "${dst}/1.txt.part" "${partial}")
+file(DOWNLOAD_MANY
+  URL "file://${slash}${src}/1.txt" FILE "${dst}/1.txt"
+      EXPECTED_HASH SHA256=${hash_1} STATUS status_1
+  )
+check_status(status_1 "No error")
+check_files(1)
+
+# A partial file that does not match is downloaded again.
+file(REMOVE "${dst}/1.txt")
+string(SUBSTRING "${content_2}" 0 5000 partial)
+file(WRITE "${dst}/1.txt.part" "${partial}")
+file(DOWNLOAD_MANY
+  URL "file://${slash}${src}/1.txt" FILE "${dst}/1.txt"
+      EXPECTED_HASH SHA256=${hash_1} STATUS status_1
+  )
+check_status(status_1 "No error")
+check_files(1)
+
+# Files with a hash come from the cache even if the URL does not work.
+file(REMOVE_RECURSE "${dst}")
+file(DOWNLOAD_MANY
+  CACHE_DIR "${cache}"
+  URL "file://${slash}${src}/missing.txt" FILE "${dst}/2.txt"
+      EXPECTED_HASH SHA256=${hash_2} STATUS status_2
+  URL "file://${slash}${src}/missing.txt" FILE "${dst}/5.txt"
+      STATUS status_5
+  )
+check_status(status_2 "found in download cache")
+check_files(2)
+list(GET status_5 0 code)
+if(code EQUAL 0 OR EXISTS "${dst}/5.txt" OR EXISTS "${dst}/5.txt.part")
+  message(SEND_ERROR "Download of a missing file reported '${status_5}'")
+endif()
+
+# file(DOWNLOAD) shares the cache.
+set(CMAKE_DOWNLOAD_CACHE_DIR "${cache}")
+file(DOWNLOAD "file://${slash}${src}/missing.txt" "${dst}/3.txt"
+  EXPECTED_HASH SHA256=${hash_3} STATUS status_3
+  )
+check_status(status_3 "found in download cache")
+check_files(3)
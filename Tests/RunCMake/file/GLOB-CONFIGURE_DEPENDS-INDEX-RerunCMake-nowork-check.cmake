@@ -0,0 +1,5 @@
+if(actual_stdout MATCHES "Running CMake")
+  set(RunCMake_TEST_FAILED "CMake ran again although no glob result changed.")
+elseif(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/VerifyGlobs.index")
+  set(RunCMake_TEST_FAILED "The glob verification index was not written.")
+endif()
@@ -0,0 +1,46 @@
+set(src "${CMAKE_CURRENT_BINARY_DIR}/src")
+file(REMOVE_RECURSE "${src}")
+
+file(WRITE "${src}/data.txt" "data\n")
+file(WRITE "${src}/tool" "tool\n")
+
+foreach(mode IN ITEMS ON HARDLINK)
+  set(CMAKE_INSTALL_USE_LINKS ${mode})
+  set(dst "${CMAKE_CURRENT_BINARY_DIR}/dst-${mode}")
+  file(REMOVE_RECURSE "${dst}")
+
+  foreach(pass 1 2)
+    message(STATUS "${mode} pass ${pass}")
+    set(CMAKE_INSTALL_MANIFEST_FILES "")
+    file(INSTALL FILES "${src}/data.txt" DESTINATION "${dst}" MESSAGE_LAZY)
+    file(INSTALL FILES "${src}/tool" DESTINATION "${dst}" TYPE EXECUTABLE
+      PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE MESSAGE_LAZY)
+    # Files that are up to date, even as links, are still installed.
+    if(NOT CMAKE_INSTALL_MANIFEST_FILES STREQUAL "${dst}/data.txt;${dst}/tool")
+      message(FATAL_ERROR
+        "Pass ${pass} installed\n ${CMAKE_INSTALL_MANIFEST_FILES}")
+    endif()
+  endforeach()
+
+  # A hard link installed before is the source itself and is reported as
+  # up to date.
+  message(STATUS "${mode} pass 3")
+  file(INSTALL FILES "${src}/data.txt" DESTINATION "${dst}")
+
+  foreach(f data.txt tool)
+    file(READ "${src}/${f}" expect)
+    file(READ "${dst}/${f}" actual)
+    if(NOT actual STREQUAL expect)
+      message(FATAL_ERROR "${dst}/${f} has content\n ${actual}\nnot\n ${expect}")
+    endif()
+  endforeach()
+
+  # Targets are never hard-linked, so editing the installed copy in place
+  # must leave the source alone.
+  file(WRITE "${dst}/tool" "modified\n")
+  file(READ "${src}/tool" content)
+  if(NOT content STREQUAL "tool\n")
+    message(FATAL_ERROR "Modifying installed tool changed its source")
+  endif()
+  file(WRITE "${src}/tool" "tool\n")
+endforeach()
@@ -0,0 +1,35 @@
+set(src ${CMAKE_CURRENT_BINARY_DIR}/src)
+set(dst ${CMAKE_CURRENT_BINARY_DIR}/dst)
+file(REMOVE_RECURSE ${src} ${dst})
+foreach(d RANGE 3)
+  foreach(f RANGE 49)
+    file(WRITE ${src}/dir/d${d}/f${f}.txt "${d}/${f}\n")
+  endforeach()
+endforeach()
+file(WRITE ${src}/a/same.txt "a\n")
+file(WRITE ${src}/b/same.txt "b\n")
+
+message(STATUS "Installing all")
+file(INSTALL ${src}/dir DESTINATION ${dst} MESSAGE_NEVER)
+foreach(d RANGE 3)
+  foreach(f RANGE 49)
+    file(READ ${dst}/dir/d${d}/f${f}.txt content)
+    if(NOT content STREQUAL "${d}/${f}\n")
+      message(SEND_ERROR "d${d}/f${f}.txt has wrong content:\n ${content}")
+    endif()
+  endforeach()
+endforeach()
+
+message(STATUS "Installing one")
+file(REMOVE ${dst}/dir/d2/f7.txt)
+file(INSTALL ${src}/dir DESTINATION ${dst} MESSAGE_LAZY)
+
+message(STATUS "Installing same")
+set(ENV{CMAKE_INSTALL_ALWAYS} 1)
+file(INSTALL ${src}/a/same.txt ${src}/b/same.txt DESTINATION ${dst})
+unset(ENV{CMAKE_INSTALL_ALWAYS})
+file(READ ${dst}/same.txt content)
+if(NOT content STREQUAL "b\n")
+  message(SEND_ERROR "same.txt has wrong content:\n ${content}")
+endif()
+message(STATUS "Done")
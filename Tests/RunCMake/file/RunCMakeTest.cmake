@@ -12,6 +12,9 @@ run_cmake(DOWNLOAD-tls-cainfo-not-set)
 run_cmake(DOWNLOAD-tls-verify-not-set)
 run_cmake(DOWNLOAD-pass-not-set)
 run_cmake(DOWNLOAD-no-save-hash)
+run_cmake(DOWNLOAD_MANY)
+run_cmake(DOWNLOAD_MANY-hash-mismatch)
+run_cmake(DOWNLOAD_MANY-no-file)
 run_cmake(TOUCH)
 run_cmake(TOUCH-error-in-source-directory)
 run_cmake(TOUCH-error-missing-directory)
@@ -25,6 +28,7 @@ run_cmake(INSTALL-DIRECTORY)
 run_cmake(INSTALL-FILES_FROM_DIR)
 run_cmake(INSTALL-FILES_FROM_DIR-bad)
 run_cmake(INSTALL-MESSAGE-bad)
+run_cmake(INSTALL-many-files)
 run_cmake(FileOpenFailRead)
 run_cmake(LOCK)
 run_cmake(LOCK-error-file-create-fail)
@@ -67,7 +71,15 @@ if(NOT WIN32 OR CYGWIN)
   run_cmake(CREATE_LINK-SYMBOLIC)
   run_cmake(CREATE_LINK-SYMBOLIC-noexist)
   run_cmake(GLOB_RECURSE-cyclic-recursion)
+  # The same again, globbed with the verification index.
+  set(RunCMake_TEST_BINARY_DIR
+    ${RunCMake_BINARY_DIR}/GLOB_RECURSE-cyclic-recursion-INDEX-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_GLOB_VERIFY_INDEX=ON)
+  run_cmake(GLOB_RECURSE-cyclic-recursion)
+  unset(RunCMake_TEST_OPTIONS)
+  unset(RunCMake_TEST_BINARY_DIR)
   run_cmake(INSTALL-SYMLINK)
+  run_cmake(INSTALL-USE_LINKS)
   run_cmake(READ_SYMLINK)
   run_cmake(READ_SYMLINK-noexist)
   run_cmake(READ_SYMLINK-notsymlink)
@@ -152,6 +164,56 @@ else()
     run_cmake_command(GLOB-CONFIGURE_DEPENDS-CMP0009-RerunCMake-rebuild ${CMAKE_COMMAND} --build .)
   endif()
 
+
+  # The same again, checked with the verification index.
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake-build)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}/test")
+  set(tf_1  "${RunCMake_TEST_BINARY_DIR}/test/1.txt")
+  file(WRITE "${tf_1}" "1")
+
+  message(STATUS "GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake: first configuration...")
+  run_cmake(GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake)
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake-build ${CMAKE_COMMAND} --build .)
+
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep ${fs_delay})
+  message(STATUS "GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake: add and remove a file...")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/test/tmp.txt" "tmp")
+  file(REMOVE "${RunCMake_TEST_BINARY_DIR}/test/tmp.txt")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake-nowork ${CMAKE_COMMAND} --build .)
+
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep ${fs_delay})
+  message(STATUS "GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake: add another file...")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}/test/sub")
+  set(tf_2  "${RunCMake_TEST_BINARY_DIR}/test/sub/2.txt")
+  file(WRITE "${tf_2}" "2")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake-rebuild_first ${CMAKE_COMMAND} --build .)
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake-nowork ${CMAKE_COMMAND} --build .)
+
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep ${fs_delay})
+  message(STATUS "GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake: remove first test file...")
+  file(REMOVE "${tf_1}")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake-rebuild_second ${CMAKE_COMMAND} --build .)
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-INDEX-RerunCMake-nowork ${CMAKE_COMMAND} --build .)
+
+  if(NOT WIN32 OR CYGWIN)
+    message(STATUS "GLOB-CONFIGURE_DEPENDS-INDEX-CMP0009-RerunCMake: link the first test directory into a new directory...")
+    file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}/test2")
+    execute_process(COMMAND ${CMAKE_COMMAND} -E create_symlink "${RunCMake_TEST_BINARY_DIR}/test" "${RunCMake_TEST_BINARY_DIR}/test2/test_folder_symlink")
+
+    message(STATUS "GLOB-CONFIGURE_DEPENDS-INDEX-CMP0009-RerunCMake: first configuration...")
+    set(RunCMake_TEST_OPTIONS -DCMAKE_GLOB_VERIFY_INDEX=ON)
+    run_cmake(GLOB-CONFIGURE_DEPENDS-CMP0009-RerunCMake)
+    unset(RunCMake_TEST_OPTIONS)
+    run_cmake_command(GLOB-CONFIGURE_DEPENDS-CMP0009-RerunCMake-build ${CMAKE_COMMAND} --build .)
+
+    execute_process(COMMAND ${CMAKE_COMMAND} -E sleep ${fs_delay})
+    message(STATUS "GLOB-CONFIGURE_DEPENDS-INDEX-CMP0009-RerunCMake: add another file in the linked directory...")
+    set(tf_3  "${RunCMake_TEST_BINARY_DIR}/test/3.txt")
+    file(WRITE "${tf_3}" "3")
+    run_cmake_command(GLOB-CONFIGURE_DEPENDS-CMP0009-RerunCMake-rebuild ${CMAKE_COMMAND} --build .)
+  endif()
+
   unset(RunCMake_TEST_BINARY_DIR)
   unset(RunCMake_TEST_NO_CLEAN)
   unset(RunCMake_DEFAULT_stderr)
@@ -0,0 +1,21 @@
+check_installed([[^bin;bin/script\.sh;src-all;src-all/main\.c;src-dbg;src-dbg/empty\.c;src-opt;src-opt/main\.c$]])
+
+file(STRINGS "${RunCMake_TEST_BINARY_DIR}/cmake_install.cmake" bulk_lines
+  REGEX "^file\\(INSTALL _CMAKE_BULK_MANIFEST ")
+list(LENGTH bulk_lines bulk_count)
+if(NOT bulk_count EQUAL 2)
+  string(APPEND RunCMake_TEST_FAILED
+    "Expected 2 bulk manifests in cmake_install.cmake, found:\n  ${bulk_lines}\n")
+endif()
+
+file(STRINGS "${RunCMake_TEST_BINARY_DIR}/install_manifest.txt" manifest)
+set(expect
+  "${CMAKE_INSTALL_PREFIX}/src-all/main.c"
+  "${CMAKE_INSTALL_PREFIX}/bin/script.sh"
+  "${CMAKE_INSTALL_PREFIX}/src-opt/main.c"
+  "${CMAKE_INSTALL_PREFIX}/src-dbg/empty.c"
+  )
+if(NOT manifest STREQUAL expect)
+  string(APPEND RunCMake_TEST_FAILED
+    "install_manifest.txt lists:\n  ${manifest}\nnot:\n  ${expect}\n")
+endif()
@@ -0,0 +1 @@
+check_installed([[^bin;bin/script\.sh$]])
@@ -0,0 +1 @@
+check_installed([[^src-exc;src-exc/main\.c$]])
@@ -0,0 +1 @@
+check_installed([[^src-dbg;src-dbg/empty\.c;src-opt;src-opt/main\.c$]])
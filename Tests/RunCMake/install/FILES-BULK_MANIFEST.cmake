@@ -0,0 +1,9 @@
+set(CMAKE_INSTALL_BULK_MANIFEST ON)
+install(FILES main.c DESTINATION src-all)
+install(FILES main.c empty.c DESTINATION src-uns EXCLUDE_FROM_ALL)
+install(FILES main.c DESTINATION src-exc EXCLUDE_FROM_ALL COMPONENT exc)
+install(CODE [[message(STATUS "Between bulk manifests")]])
+install(PROGRAMS script.bat DESTINATION bin RENAME script.sh COMPONENT dev)
+install(FILES main.c noexist.c DESTINATION src-opt OPTIONAL COMPONENT lib)
+install(FILES empty.c DESTINATION src-rel CONFIGURATIONS Release)
+install(FILES empty.c DESTINATION src-dbg CONFIGURATIONS Debug COMPONENT lib)
@@ -175,3 +175,4 @@ run_install_test(FILES-EXCLUDE_FROM_ALL)
 run_install_test(TARGETS-EXCLUDE_FROM_ALL)
 run_install_test(TARGETS-NAMELINK_COMPONENT)
 run_install_test(SCRIPT-COMPONENT)
+run_install_test(FILES-BULK_MANIFEST)
@@ -0,0 +1,83 @@
+#!/usr/bin/env bash
+
+usage='usage: benchmark-archive-create.bash [<options>] [--] <cmake>
+
+    --help                     Print usage plus more detailed help.
+
+    --size <mb>                Size of the synthetic tree (default 256).
+    --threads <list>           Thread counts to try (default "1 2 4 0").
+'
+
+help="$usage"'
+Time "file(ARCHIVE_CREATE)" with the XZ and Zstd compressions over a
+synthetic source tree for each of the given thread counts.  A thread
+count of 0 uses all available cores.  The tree mixes text that
+compresses well with random data that does not, roughly like an
+install tree.  The wall time and the size of each archive are reported.
+
+Example:
+
+    Utilities/Scripts/benchmark-archive-create.bash --size 512 \
+      /path/to/bin/cmake
+'
+
+die() {
+    echo 1>&2 "$@" ; exit 1
+}
+
+# Parse command-line arguments.
+size=256
+threads='1 2 4 0'
+while test "$#" != 0; do
+    case "$1" in
+    --size) shift; size="$1" ;;
+    --threads) shift; threads="$1" ;;
+    --help) echo "$help"; exit 0 ;;
+    --) shift ; break ;;
+    -*) die "$usage" ;;
+    *) break ;;
+    esac
+    shift
+done
+test "$#" = 1 || die "$usage"
+test "$size" -gt 0 2>/dev/null || die "Invalid size: $size"
+case "$1" in
+    */*) cmake="$(cd "$(dirname "$1")" && pwd)/$(basename "$1")" ;;
+    *) cmake="$1" ;;
+esac
+
+work="$(mktemp -d)" || die "Failed to create a temporary directory"
+trap 'rm -rf "$work"' EXIT
+
+# Populate the tree with 1 MiB files, half text and half random.
+mkdir -p "$work/tree" || die "Failed to create the synthetic tree"
+for ((i = 0; i < size; ++i)); do
+    dir="$work/tree/d$((i % 16))"
+    mkdir -p "$dir"
+    if test $((i % 2)) = 0; then
+        seq -f "line %g of a generated source file" 1 100000 |
+            head -c 1048576 > "$dir/f$i.txt"
+    else
+        head -c 1048576 /dev/urandom > "$dir/f$i.bin"
+    fi
+done
+
+cat > "$work/create.cmake" <<'EOS'
+file(ARCHIVE_CREATE OUTPUT "${OUTPUT}" PATHS tree
+  FORMAT paxr COMPRESSION "${COMPRESSION}" THREADS "${THREADS}")
+EOS
+
+printf '%-6s %8s %12s %12s\n' 'comp' 'threads' 'time' 'size'
+for compression in XZ Zstd; do
+    for t in $threads; do
+        out="$work/out.tar"
+        rm -f "$out"
+        start=$(date +%s%N)
+        (cd "$work" && "$cmake" -DOUTPUT="$out" -DCOMPRESSION="$compression" \
+            -DTHREADS="$t" -P create.cmake) ||
+            die "Failed to create the $compression archive"
+        end=$(date +%s%N)
+        printf '%-6s %8s %10sms %12s\n' "$compression" "$t" \
+            $(( (end - start) / 1000000 )) "$(wc -c < "$out")"
+    done
+done
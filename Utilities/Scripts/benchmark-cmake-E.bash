@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+
+usage='usage: benchmark-cmake-E.bash [<options>] [--] <cmake>...
+
+    --help                     Print usage plus more detailed help.
+
+    --count <n>                Run each command <n> times (default 1000).
+'
+
+help="$usage"'
+Time the startup of the "cmake -E" helpers that generated build systems
+run for many build steps.  Each given cmake executable runs each helper
+the same number of times, and the average wall time per invocation is
+reported.  Pass a cmake built before a change along with one built after
+it to compare their startup paths.
+
+Example:
+
+    Utilities/Scripts/benchmark-cmake-E.bash \
+      /path/to/old/bin/cmake /path/to/new/bin/cmake
+'
+
+die() {
+    echo 1>&2 "$@" ; exit 1
+}
+
+# Parse command-line arguments.
+count=1000
+while test "$#" != 0; do
+    case "$1" in
+    --count) shift; count="$1" ;;
+    --help) echo "$help"; exit 0 ;;
+    --) shift ; break ;;
+    -*) die "$usage" ;;
+    *) break ;;
+    esac
+    shift
+done
+test "$#" != 0 || die "$usage"
+test "$count" -gt 0 2>/dev/null || die "Invalid count: $count"
+
+work="$(mktemp -d)" || die "Failed to create a temporary directory"
+trap 'rm -rf "$work"' EXIT
+echo 'content' > "$work/src.txt"
+
+time_command() {
+    local start end i
+    start=$(date +%s%N)
+    for ((i = 0; i < count; ++i)); do
+        "$@" >/dev/null || die "Command failed: $*"
+    done
+    end=$(date +%s%N)
+    echo $(( (end - start) / count / 1000 ))
+}
+
+printf '%-24s' 'command'
+for cmake in "$@"; do
+    printf ' %12s' "$(basename "$(dirname "$(dirname "$cmake")")")"
+done
+printf '\n'
+
+for helper in \
+    'true' \
+    'touch stamp' \
+    'make_directory dir' \
+    'copy_if_different src.txt dst.txt' \
+    'cmake_echo_color --green message' \
+    ; do
+    printf '%-24s' "${helper%% *}"
+    for cmake in "$@"; do
+        # Split the helper into words on purpose.
+        # shellcheck disable=SC2086
+        usec=$(cd "$work" && time_command "$cmake" -E $helper)
+        printf ' %10sus' "$usec"
+    done
+    printf '\n'
+done
@@ -37,6 +37,9 @@ __FBSDID("$FreeBSD$");
 #ifdef HAVE_STRING_H
 #include <string.h>
 #endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 #ifdef HAVE_ZSTD_H
 #include <cm3p/zstd.h>
 #endif
@@ -50,6 +53,7 @@ __FBSDID("$FreeBSD$");
 
 struct private_data {
 	int		 compression_level;
+	int		 threads;
 #if HAVE_ZSTD_H && HAVE_LIBZSTD
 	ZSTD_CStream	*cstream;
 	int64_t		 total_in;
@@ -97,6 +101,7 @@ archive_write_add_filter_zstd(struct archive *_a)
 	f->code = ARCHIVE_FILTER_ZSTD;
 	f->name = "zstd";
 	data->compression_level = 3; /* Default level used by the zstd CLI */
+	data->threads = 1;
 #if HAVE_ZSTD_H && HAVE_LIBZSTD
 	data->cstream = ZSTD_createCStream();
 	if (data->cstream == NULL) {
@@ -156,6 +161,27 @@ archive_compressor_zstd_options(struct archive_write_filter *f, const char *key,
 		}
 		data->compression_level = level;
 		return (ARCHIVE_OK);
+	} else if (strcmp(key, "threads") == 0) {
+		char *endptr;
+		long threads;
+
+		if (value == NULL)
+			return (ARCHIVE_WARN);
+		errno = 0;
+		threads = strtol(value, &endptr, 10);
+		if (errno != 0 || *endptr != '\0' || threads < 0)
+			return (ARCHIVE_WARN);
+		if (threads == 0) {
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+			threads = sysconf(_SC_NPROCESSORS_ONLN);
+			if (threads < 1)
+				threads = 1;
+#else
+			threads = 1;
+#endif
+		}
+		data->threads = (int)threads;
+		return (ARCHIVE_OK);
 	}
 
 	/* Note: The "warn" return is just to inform the options
@@ -204,6 +230,12 @@ archive_compressor_zstd_open(struct archive_write_filter *f)
 		return (ARCHIVE_FATAL);
 	}
 
+	/* A zstd library built without multithreading support rejects this
+	 * parameter and silently keeps compressing on a single thread. */
+	if (data->threads > 1)
+		ZSTD_CCtx_setParameter(data->cstream, ZSTD_c_nbWorkers,
+		    data->threads);
+
 	return (ARCHIVE_OK);
 }
 